@@ -11,9 +11,21 @@
 #define ABCG_HPP_
 
 #include "abcg_application.hpp"
+#include "abcg_frustum.hpp"
+#include "abcg_gpuculler.hpp"
+#include "abcg_hizbuffer.hpp"
 #include "abcg_image.hpp"
+#include "abcg_lightclusters.hpp"
 #include "abcg_openglwindow.hpp"
+#include "abcg_postprocesschain.hpp"
+#include "abcg_profiler.hpp"
+#include "abcg_renderqueue.hpp"
+#include "abcg_resolutionscaler.hpp"
+#include "abcg_sampler.hpp"
+#include "abcg_scene.hpp"
+#include "abcg_streambuffer.hpp"
 #include "abcg_string.hpp"
 #include "abcg_trackball.hpp"
+#include "abcg_workerpool.hpp"
 
 #endif
\ No newline at end of file
@@ -10,13 +10,25 @@
 
 #include <fmt/core.h>
 
+#include <charconv>
 #include <span>
 
 #include "SDL_image.h"
 #include "abcg_exception.hpp"
+#include "abcg_gputimer.hpp"
 #include "abcg_openglwindow.hpp"
+#include "abcg_profiler.hpp"
 #include "tiny_obj_loader.h"
 
+namespace {
+template <typename T>
+bool parseNumber(std::string_view text, T &value) {
+  const auto *const end{text.data() + text.size()};
+  const auto [pointer, error]{std::from_chars(text.data(), end, value)};
+  return error == std::errc{} && pointer == end;
+}
+}  // namespace
+
 #if defined(__EMSCRIPTEN__)
 void abcg::mainLoopCallback(void *userData) {
   abcg::Application &app{*(static_cast<abcg::Application *>(userData))};
@@ -28,16 +40,151 @@ void abcg::mainLoopCallback(void *userData) {
 /**
  * @brief Constructs an abcg::Application object.
  *
- * Constructs an abcg::Application object and initializes SDL library and
- * subsystems.
+ * Constructs an abcg::Application object, parses the command-line options
+ * and initializes SDL library and subsystems.
+ *
+ * Supported options:
+ * - `--assets=<path>`: loads assets from the given directory instead of the
+ * `assets` directory next to the executable (e.g. the source directory of the
+ * example, so that edited files are used without a rebuild);
+ * - `--shader-hot-reload`: enables abcg::OpenGLSettings::shaderHotReload;
+ * - `--antialiasing=none|fxaa|msaa<n>`: overrides the antialiasing of the
+ * window with none, an FXAA post-processing pass (abcg::OpenGLSettings::fxaa)
+ * or n samples per pixel (abcg::OpenGLSettings::samples);
+ * - `--dynamic-resolution[=<ms>]`: enables
+ * abcg::OpenGLSettings::dynamicResolution, optionally with a GPU frame budget
+ * in milliseconds. Ignored unless the window sets
+ * abcg::OpenGLSettings::supportsRenderScale, as windows that set their
+ * viewport to the window size would only fill a corner of the scaled image;
+ * - `--headless`: renders without a visible window, using the SDL offscreen
+ * video driver (EGL pbuffer surfaces, e.g. Mesa llvmpipe on machines without
+ * a GPU or display). Not available with Emscripten;
+ * - `--frames=<n>`: quits after rendering n frames;
+ * - `--size=<width>x<height>`: sets the window size, which is also the
+ * rendering resolution in headless mode;
+ * - `--benchmark[=<path>]`: runs abcg::Benchmark and prints its JSON report,
+ * also writing it to the given path. `--frames` sets the number of measured
+ * frames;
+ * - `--warmup=<n>`: number of benchmark frames that are not measured;
+ * - `--capture=<path>`: writes each rendered frame, without the UI, to the
+ * given directory (see abcg::OpenGLWindow::startCapture). Not available with
+ * Emscripten;
+ * - `--capture-format=png|ppm`: image format of `--capture` (default: png).
  *
  * @throw abcg::Exception if SDL failed to initialize its subsystems.
  */
-abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
+abcg::Application::Application(int argc, char **argv) {
+  // Get executable relative path
+  std::string argv_str(*std::span{&argv, 1}[0]);
+#if defined(WIN32)
+  if (auto n{argv_str.find_last_of('\\')}; n == std::string::npos) {
+    // Called from the same directory of the executable
+    m_basePath = ".";
+  } else {
+    m_basePath = argv_str.substr(0, n);
+  }
+#else
+  m_basePath = argv_str.substr(0, argv_str.find_last_of('/'));
+#endif
+
+  m_assetsPath = m_basePath + "/assets/";
+
+  // Parse command-line options
+  bool benchmark{};
+  BenchmarkSettings benchmarkSettings;
+  const std::span arguments{argv, static_cast<std::size_t>(argc)};
+  for (const std::string_view argument : arguments.subspan(1)) {
+    if (argument == "--shader-hot-reload") {
+      m_shaderHotReload = true;
+    } else if (argument == "--antialiasing=none") {
+      m_samples = 0;
+      m_fxaa = false;
+    } else if (argument == "--antialiasing=fxaa") {
+      m_samples = 0;
+      m_fxaa = true;
+    } else if (argument.starts_with("--antialiasing=msaa")) {
+      m_fxaa = false;
+      if (!parseNumber(
+              argument.substr(std::string_view{"--antialiasing=msaa"}.size()),
+              m_samples) ||
+          m_samples < 0) {
+        fmt::print("Warning: invalid option {}\n", argument);
+        m_samples = -1;
+      }
+    } else if (argument == "--dynamic-resolution") {
+      m_dynamicResolution = true;
+    } else if (argument.starts_with("--dynamic-resolution=")) {
+      m_dynamicResolution = true;
+      if (!parseNumber(argument.substr(
+                           std::string_view{"--dynamic-resolution="}.size()),
+                       m_gpuFrameBudget) ||
+          m_gpuFrameBudget <= 0.0) {
+        fmt::print("Warning: invalid option {}\n", argument);
+        m_gpuFrameBudget = 0.0;
+      }
+    } else if (argument.starts_with("--assets=")) {
+      m_assetsPath = argument.substr(std::string_view{"--assets="}.size());
+      if (!m_assetsPath.ends_with('/')) m_assetsPath += '/';
+    } else if (argument == "--benchmark") {
+      benchmark = true;
+    } else if (argument.starts_with("--benchmark=")) {
+      benchmark = true;
+      benchmarkSettings.outputPath =
+          argument.substr(std::string_view{"--benchmark="}.size());
+    } else if (argument.starts_with("--warmup=")) {
+      if (!parseNumber(argument.substr(std::string_view{"--warmup="}.size()),
+                       benchmarkSettings.warmupFrames)) {
+        fmt::print("Warning: invalid option {}\n", argument);
+      }
+    } else if (argument == "--headless") {
+      m_headless = true;
+    } else if (argument.starts_with("--frames=")) {
+      if (!parseNumber(argument.substr(std::string_view{"--frames="}.size()),
+                       m_maxFrames)) {
+        fmt::print("Warning: invalid option {}\n", argument);
+      }
+    } else if (argument.starts_with("--size=")) {
+      const auto size{argument.substr(std::string_view{"--size="}.size())};
+      const auto separator{size.find('x')};
+      if (separator == std::string_view::npos ||
+          !parseNumber(size.substr(0, separator), m_windowWidth) ||
+          !parseNumber(size.substr(separator + 1), m_windowHeight) ||
+          m_windowWidth <= 0 || m_windowHeight <= 0) {
+        fmt::print("Warning: invalid option {}\n", argument);
+        m_windowWidth = m_windowHeight = 0;
+      }
+    } else if (argument.starts_with("--capture=")) {
+      m_captureDirectory =
+          argument.substr(std::string_view{"--capture="}.size());
+    } else if (argument == "--capture-format=png") {
+      m_captureFormat = CaptureFormat::PNG;
+    } else if (argument == "--capture-format=ppm") {
+      m_captureFormat = CaptureFormat::PPM;
+    } else {
+      fmt::print("Warning: unknown option {}\n", argument);
+    }
+  }
+
+  if (benchmark) {
+    if (m_maxFrames > 0) benchmarkSettings.measuredFrames = m_maxFrames;
+    m_maxFrames = 0;
+    m_benchmark = std::make_unique<Benchmark>(std::move(benchmarkSettings));
+  }
+
   Uint32 subsystemMask{SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_AUDIO |
                        SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER |
                        SDL_INIT_EVENTS};
 
+#if !defined(__EMSCRIPTEN__)
+  if (m_headless) {
+    // Build machines may have no audio or input devices either
+    subsystemMask = SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_EVENTS;
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+  }
+#else
+  m_headless = false;
+#endif
+
   if (SDL_Init(subsystemMask) != 0) {
     throw abcg::Exception{abcg::Exception::SDL("SDL_Init failed")};
   }
@@ -50,19 +197,6 @@ abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
     throw abcg::Exception{abcg::Exception::SDLImage("IMG_Init failed")};
   }
 #endif
-
-  // Get executable relative path
-  std::string argv_str(*std::span{&argv, 1}[0]);
-#if defined(WIN32)
-  if (auto n{argv_str.find_last_of('\\')}; n == std::string::npos) {
-    // Called from the same directory of the executable
-    m_basePath = ".";
-  } else {
-    m_basePath = argv_str.substr(0, n);
-  }
-#else
-  m_basePath = argv_str.substr(0, argv_str.find_last_of('/'));
-#endif
 }
 
 /**
@@ -72,6 +206,13 @@ abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
  * subsystems.
  */
 abcg::Application::~Application() {
+  // Stop the threads that call into the window before its derived class is
+  // destroyed
+  if (m_window != nullptr) {
+    m_window->stopRenderThread();
+    m_window->m_uploadThread.stop();
+    m_window->m_frameCapture.stop();
+  }
 #if !defined(__EMSCRIPTEN__)
   IMG_Quit();
 #endif
@@ -95,18 +236,89 @@ void abcg::Application::run(std::unique_ptr<OpenGLWindow> window) {
 }
 
 void abcg::Application::mainLoopIterator([[maybe_unused]] bool &done) {
+  auto &frameScheduler{m_window->m_frameScheduler};
+
+  // Handle events until the next frame is due. This blocks when there is
+  // nothing to paint
   SDL_Event event{};
-  while (SDL_PollEvent(&event) != 0) {
+  while (frameScheduler.waitEvent(event)) {
+    if (frameScheduler.isWakeEvent(event)) continue;
 #if !defined(__EMSCRIPTEN__)
     if (event.type == SDL_QUIT) done = true;
 #endif
-    m_window->handleEvent(event, done);
+    {
+      ABCG_PROFILE_SCOPE("handleEvent");
+      m_window->handleEvent(event, done);
+    }
+    if (done) return;
+  }
+
+  if (frameScheduler.beginFrame()) {
+    m_window->paint();
+    ++m_frameCount;
+    if (m_maxFrames > 0 && m_frameCount >= m_maxFrames) done = true;
+    if (m_benchmark != nullptr) updateBenchmark(done);
+  }
+}
+
+void abcg::Application::updateBenchmark(bool &done) {
+  std::vector<double> gpuTimes;
+  if (m_window->m_frameGPUTimer != nullptr) {
+    gpuTimes = m_window->m_frameGPUTimer->takeResults();
+  }
+  // Input is injected before the frame is recorded, as the scripted path
+  // starts with a button press on frame 0
+  m_benchmark->injectInput(m_window->m_window);
+  m_benchmark->recordFrame(gpuTimes);
+
+  if (m_benchmark->isFinished()) {
+    // The report reads the renderer name from the context
+    m_window->stopRenderThread();
+    m_benchmark->writeReport(m_window->m_viewportWidth,
+                             m_window->m_viewportHeight);
+    m_benchmark.reset();
+    done = true;
   }
-  m_window->paint();
 }
 
 void abcg::Application::run() {
-  m_window->initialize(m_basePath);
+  if (m_shaderHotReload) {
+    m_window->m_openGLSettings.shaderHotReload = true;
+  }
+  if (m_headless) {
+    m_window->m_windowSettings.headless = true;
+  }
+  if (m_samples >= 0) {
+    m_window->m_openGLSettings.samples = m_samples;
+    m_window->m_openGLSettings.fxaa = m_fxaa;
+  }
+  if (m_dynamicResolution) {
+    if (m_window->m_openGLSettings.supportsRenderScale) {
+      m_window->m_openGLSettings.dynamicResolution = true;
+      if (m_gpuFrameBudget > 0.0) {
+        m_window->m_openGLSettings.gpuFrameBudget = m_gpuFrameBudget * 1e-3;
+      }
+    } else {
+      fmt::print("Warning: --dynamic-resolution ignored, the window does not "
+                 "render at the render scale\n");
+    }
+  }
+  if (m_windowWidth > 0 && m_windowHeight > 0) {
+    m_window->m_windowSettings.width = m_windowWidth;
+    m_window->m_windowSettings.height = m_windowHeight;
+  }
+  m_window->initialize(m_assetsPath);
+  // The window already measures the frames with dynamic resolution
+  if (m_benchmark != nullptr && m_window->m_frameGPUTimer == nullptr &&
+      GPUTimer::isSupported()) {
+    m_window->m_frameGPUTimer = std::make_unique<GPUTimer>();
+  }
+  if (!m_captureDirectory.empty()) {
+    m_window->startCapture(m_captureDirectory, m_captureFormat);
+  }
+  if (m_window->m_windowSettings.renderThread) {
+    m_window->startRenderThread();
+  }
 
 #if defined(__EMSCRIPTEN__)
   emscripten_set_main_loop_arg(mainLoopCallback, this, 0, true);
@@ -10,9 +10,14 @@
 #ifndef ABCG_APPLICATION_HPP_
 #define ABCG_APPLICATION_HPP_
 
+#include <cstddef>
+#include <filesystem>
 #include <memory>
+#include <string>
 
+#include "abcg_benchmark.hpp"
 #include "abcg_exception.hpp"
+#include "abcg_framecapture.hpp"
 
 namespace abcg {
 class Application;
@@ -42,9 +47,31 @@ class abcg::Application {
 
  private:
   void mainLoopIterator(bool& done);
+  void updateBenchmark(bool& done);
   void run();
 
   std::string m_basePath;
+  std::string m_assetsPath;
+  bool m_shaderHotReload{};
+  bool m_headless{};
+  // Window size set with --size, or zero
+  int m_windowWidth{};
+  int m_windowHeight{};
+  // Antialiasing set with --antialiasing: number of samples, or -1 to keep
+  // the settings of the window
+  int m_samples{-1};
+  bool m_fxaa{};
+  // Dynamic resolution set with --dynamic-resolution, and its GPU frame
+  // budget in milliseconds, or zero to keep the budget of the window
+  bool m_dynamicResolution{};
+  double m_gpuFrameBudget{};
+  // Number of frames to render before quitting, or zero to run until closed
+  std::size_t m_maxFrames{};
+  std::size_t m_frameCount{};
+  // Directory set with --capture, or empty
+  std::filesystem::path m_captureDirectory;
+  CaptureFormat m_captureFormat{CaptureFormat::PNG};
+  std::unique_ptr<Benchmark> m_benchmark;
   std::unique_ptr<OpenGLWindow> m_window;
 
 #if defined(__EMSCRIPTEN__)
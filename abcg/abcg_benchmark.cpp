@@ -0,0 +1,184 @@
+/**
+ * @file abcg_benchmark.cpp
+ * @brief Definition of abcg::Benchmark class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_benchmark.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numbers>
+#include <numeric>
+
+#include "abcg_exception.hpp"
+#include "abcg_openglfunctions.hpp"
+#include "abcg_string.hpp"
+
+namespace {
+// Frames that take longer than this multiple of the median are stutters
+constexpr double stutterFactor{2.0};
+
+// Nearest-rank percentile of sorted values
+double percentile(const std::vector<double> &sorted, double rank) {
+  const auto index{static_cast<std::size_t>(
+      std::ceil(rank / 100.0 * static_cast<double>(sorted.size())))};
+  return sorted.at(std::clamp<std::size_t>(index, 1, sorted.size()) - 1);
+}
+
+// Statistics in milliseconds, as a JSON object
+std::string formatStatistics(std::vector<double> values) {
+  if (values.empty()) return "null";
+  std::ranges::sort(values);
+  const auto mean{std::accumulate(values.begin(), values.end(), 0.0) /
+                  static_cast<double>(values.size())};
+  return fmt::format(
+      R"({{"samples": {}, "mean": {:.3f}, "p50": {:.3f}, "p90": {:.3f}, )"
+      R"("p99": {:.3f}, "max": {:.3f}}})",
+      values.size(), mean * 1e3, percentile(values, 50.0) * 1e3,
+      percentile(values, 90.0) * 1e3, percentile(values, 99.0) * 1e3,
+      values.back() * 1e3);
+}
+
+void pushMouseButtonEvent(SDL_Window *window, Uint32 type, int x, int y) {
+  SDL_Event event{};
+  event.button.type = type;
+  event.button.windowID = SDL_GetWindowID(window);
+  event.button.button = SDL_BUTTON_LEFT;
+  event.button.state = type == SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+  event.button.clicks = 1;
+  event.button.x = x;
+  event.button.y = y;
+  SDL_PushEvent(&event);
+}
+}  // namespace
+
+abcg::Benchmark::Benchmark(BenchmarkSettings settings)
+    : m_settings{std::move(settings)} {
+  m_cpuFrameTimes.reserve(m_settings.measuredFrames);
+  m_gpuTimes.reserve(m_settings.measuredFrames);
+}
+
+/**
+ * @brief Moves the mouse to the position of the scripted path for the next
+ * frame.
+ *
+ * The path is a figure eight centered on the window, dragged with the left
+ * button from the first to the last frame of the benchmark.
+ *
+ * @param window Window that receives the input.
+ */
+void abcg::Benchmark::injectInput(SDL_Window *window) {
+  if (m_frame >= totalFrames()) return;
+
+  int width{};
+  int height{};
+  SDL_GetWindowSize(window, &width, &height);
+
+  const auto angle{2.0 * std::numbers::pi * static_cast<double>(m_frame) /
+                   static_cast<double>(totalFrames())};
+  const auto radius{0.25 * std::min(width, height)};
+  const auto x{static_cast<int>(width / 2.0 + radius * std::sin(angle))};
+  const auto y{
+      static_cast<int>(height / 2.0 + radius * 0.5 * std::sin(2.0 * angle))};
+
+  // Examples read the position with SDL_GetMouseState, which is updated by
+  // warping the mouse
+  SDL_WarpMouseInWindow(window, x, y);
+
+  if (m_frame == 0) {
+    pushMouseButtonEvent(window, SDL_MOUSEBUTTONDOWN, x, y);
+  } else if (m_frame + 1 == totalFrames()) {
+    pushMouseButtonEvent(window, SDL_MOUSEBUTTONUP, x, y);
+  }
+}
+
+/**
+ * @brief Records the time of the frame that has just been painted.
+ *
+ * @param gpuTimes GPU times, in seconds, of the frames whose timer results
+ * became available since the previous call, oldest first. There must be one
+ * timer interval per painted frame.
+ */
+void abcg::Benchmark::recordFrame(std::span<const double> gpuTimes) {
+  const auto frameTime{m_frameTimer.restart()};
+  if (m_frame >= m_settings.warmupFrames && m_frame < totalFrames()) {
+    m_cpuFrameTimes.push_back(frameTime);
+  }
+  ++m_frame;
+
+  // GPU times are matched to frames by order rather than by arrival, so that
+  // warmup frames resolved after the measurement starts are left out
+  for (const auto gpuTime : gpuTimes) {
+    if (m_gpuFrame >= m_settings.warmupFrames && m_gpuFrame < totalFrames()) {
+      m_gpuTimes.push_back(gpuTime);
+    }
+    ++m_gpuFrame;
+  }
+}
+
+/**
+ * @brief Prints the report in JSON format and writes it to
+ * abcg::BenchmarkSettings::outputPath, if set.
+ *
+ * Must be called with the OpenGL context current.
+ *
+ * @param width Width of the rendered frames.
+ * @param height Height of the rendered frames.
+ *
+ * @throw abcg::Exception if the report file cannot be written.
+ */
+void abcg::Benchmark::writeReport(int width, int height) const {
+  std::size_t stutters{};
+  if (!m_cpuFrameTimes.empty()) {
+    auto sorted{m_cpuFrameTimes};
+    std::ranges::sort(sorted);
+    const auto threshold{percentile(sorted, 50.0) * stutterFactor};
+    stutters = static_cast<std::size_t>(
+        std::ranges::count_if(m_cpuFrameTimes, [threshold](double time) {
+          return time > threshold;
+        }));
+  }
+
+  const auto *renderer{
+      reinterpret_cast<const char *>(abcg::glGetString(GL_RENDERER))};
+
+  const auto report{fmt::format(
+      "{{\n"
+      "  \"renderer\": \"{}\",\n"
+      "  \"width\": {},\n"
+      "  \"height\": {},\n"
+      "  \"warmupFrames\": {},\n"
+      "  \"measuredFrames\": {},\n"
+      "  \"cpuFrameTimeMs\": {},\n"
+      "  \"gpuTimeMs\": {},\n"
+      "  \"stutters\": {}\n"
+      "}}\n",
+      escapeJSON(renderer != nullptr ? renderer : ""), width, height,
+      m_settings.warmupFrames, m_cpuFrameTimes.size(),
+      formatStatistics(m_cpuFrameTimes), formatStatistics(m_gpuTimes),
+      stutters)};
+
+  fmt::print("{}", report);
+
+  if (!m_settings.outputPath.empty()) {
+    std::ofstream stream{m_settings.outputPath};
+    stream << report;
+    if (!stream) {
+      throw abcg::Exception{abcg::Exception::Runtime(
+          fmt::format("Failed to write {}", m_settings.outputPath))};
+    }
+  }
+}
+
+/**
+ * @brief Returns true when all warm-up and measured frames have been
+ * recorded.
+ */
+bool abcg::Benchmark::isFinished() const noexcept {
+  return m_frame >= totalFrames();
+}
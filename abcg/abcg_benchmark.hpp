@@ -0,0 +1,68 @@
+/**
+ * @file abcg_benchmark.hpp
+ * @brief abcg::Benchmark header file.
+ *
+ * Declaration of abcg::BenchmarkSettings and abcg::Benchmark.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_BENCHMARK_HPP_
+#define ABCG_BENCHMARK_HPP_
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "abcg_elapsedtimer.hpp"
+#include "abcg_external.hpp"
+
+namespace abcg {
+struct BenchmarkSettings;
+class Benchmark;
+}  // namespace abcg
+
+struct abcg::BenchmarkSettings {
+  std::size_t warmupFrames{60};
+  std::size_t measuredFrames{600};
+  // Path of the JSON report. The report is always printed to stdout
+  std::string outputPath;
+};
+
+/**
+ * @brief abcg::Benchmark class.
+ *
+ * Drives an application for a fixed number of frames and reports the
+ * distribution of CPU frame times and GPU times.
+ *
+ * During the benchmark, a left-button mouse drag is replayed along a fixed
+ * path centered on the window, so that applications that use a trackball or
+ * mouse-controlled camera render the same sequence of views on every run.
+ */
+class abcg::Benchmark {
+ public:
+  explicit Benchmark(BenchmarkSettings settings);
+
+  void injectInput(SDL_Window* window);
+  void recordFrame(std::span<const double> gpuTimes);
+  void writeReport(int width, int height) const;
+
+  [[nodiscard]] bool isFinished() const noexcept;
+
+ private:
+  [[nodiscard]] std::size_t totalFrames() const noexcept {
+    return m_settings.warmupFrames + m_settings.measuredFrames;
+  }
+
+  BenchmarkSettings m_settings;
+  std::size_t m_frame{};
+  // Number of GPU times received so far. They arrive a few frames late
+  std::size_t m_gpuFrame{};
+  ElapsedTimer m_frameTimer;
+  // Times in seconds of the measured frames
+  std::vector<double> m_cpuFrameTimes;
+  std::vector<double> m_gpuTimes;
+};
+
+#endif
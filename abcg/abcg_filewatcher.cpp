@@ -0,0 +1,153 @@
+/**
+ * @file abcg_filewatcher.cpp
+ * @brief Definition of abcg::FileWatcher class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_filewatcher.hpp"
+
+#include <fmt/core.h>
+
+#include <array>
+#include <chrono>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Constructs an abcg::FileWatcher object and starts the watcher
+ * thread.
+ */
+abcg::FileWatcher::FileWatcher() {
+#if defined(__linux__)
+  m_inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotifyFD < 0) {
+    fmt::print("Warning: inotify_init1 failed, file watching disabled\n");
+    return;
+  }
+#endif
+  m_thread = std::thread(&FileWatcher::watch, this);
+}
+
+/**
+ * @brief Stops the watcher thread and releases the watched paths.
+ */
+abcg::FileWatcher::~FileWatcher() {
+  m_stop = true;
+  if (m_thread.joinable()) m_thread.join();
+#if defined(__linux__)
+  if (m_inotifyFD >= 0) close(m_inotifyFD);
+#endif
+}
+
+/**
+ * @brief Adds a file to the set of watched files.
+ *
+ * @param path Path to the file. Relative paths are resolved against the
+ * current working directory.
+ */
+void abcg::FileWatcher::addPath(std::string_view path) {
+  const auto normalizedPath{normalizePath(path)};
+
+  const std::scoped_lock lock{m_mutex};
+  if (!m_paths.insert(normalizedPath).second) return;
+
+#if defined(__linux__)
+  if (m_inotifyFD < 0) return;
+
+  // Watch the parent directory so that atomic saves (write to a temporary file
+  // followed by a rename) are detected as well
+  const auto directory{
+      std::filesystem::path{normalizedPath}.parent_path().string()};
+  for (const auto& [wd, watchedDirectory] : m_watchedDirectories) {
+    if (watchedDirectory == directory) return;
+  }
+  const auto wd{inotify_add_watch(m_inotifyFD, directory.c_str(),
+                                  IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)};
+  if (wd < 0) {
+    fmt::print("Warning: cannot watch directory {}\n", directory);
+    return;
+  }
+  m_watchedDirectories[wd] = directory;
+#else
+  std::error_code error;
+  m_lastWriteTimes[normalizedPath] =
+      std::filesystem::last_write_time(normalizedPath, error);
+#endif
+}
+
+/**
+ * @brief Returns the watched files that changed since the last call.
+ *
+ * @return Normalized paths of the modified files.
+ */
+std::vector<std::string> abcg::FileWatcher::poll() {
+  const std::scoped_lock lock{m_mutex};
+  std::vector<std::string> changedPaths(m_changedPaths.begin(),
+                                        m_changedPaths.end());
+  m_changedPaths.clear();
+  return changedPaths;
+}
+
+/**
+ * @brief Returns the absolute, lexically normalized form of a path.
+ *
+ * @param path Path to be normalized.
+ * @return Normalized path, suitable for comparisons with the paths returned
+ * by abcg::FileWatcher::poll.
+ */
+std::string abcg::FileWatcher::normalizePath(std::string_view path) {
+  std::error_code error;
+  auto absolutePath{std::filesystem::absolute(path, error)};
+  if (error) return std::string{path};
+  return absolutePath.lexically_normal().string();
+}
+
+void abcg::FileWatcher::watch() {
+#if defined(__linux__)
+  alignas(inotify_event) std::array<char, 4096> buffer{};
+
+  while (!m_stop) {
+    pollfd descriptor{.fd = m_inotifyFD, .events = POLLIN, .revents = 0};
+    // Wake up periodically to check the stop flag
+    if (::poll(&descriptor, 1, 100) <= 0) continue;
+
+    const auto length{read(m_inotifyFD, buffer.data(), buffer.size())};
+    if (length <= 0) continue;
+
+    const std::scoped_lock lock{m_mutex};
+    for (std::size_t offset{}; offset < static_cast<std::size_t>(length);) {
+      const auto* event{
+          reinterpret_cast<const inotify_event*>(&buffer.at(offset))};
+      offset += sizeof(inotify_event) + event->len;
+
+      if (event->len == 0) continue;
+      const auto directory{m_watchedDirectories.find(event->wd)};
+      if (directory == m_watchedDirectories.end()) continue;
+
+      auto path{directory->second + "/" + std::string{event->name}};
+      if (m_paths.contains(path)) m_changedPaths.insert(std::move(path));
+    }
+  }
+#else
+  using namespace std::chrono_literals;
+
+  while (!m_stop) {
+    std::this_thread::sleep_for(250ms);
+
+    const std::scoped_lock lock{m_mutex};
+    for (auto& [path, lastWriteTime] : m_lastWriteTimes) {
+      std::error_code error;
+      const auto writeTime{std::filesystem::last_write_time(path, error)};
+      if (!error && writeTime != lastWriteTime) {
+        lastWriteTime = writeTime;
+        m_changedPaths.insert(path);
+      }
+    }
+  }
+#endif
+}
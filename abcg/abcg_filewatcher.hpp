@@ -0,0 +1,71 @@
+/**
+ * @file abcg_filewatcher.hpp
+ * @brief abcg::FileWatcher header file.
+ *
+ * Declaration of abcg::FileWatcher class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FILEWATCHER_HPP_
+#define ABCG_FILEWATCHER_HPP_
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace abcg {
+class FileWatcher;
+}  // namespace abcg
+
+/**
+ * @brief abcg::FileWatcher class.
+ *
+ * Watches a set of files on a background thread and reports which of them
+ * have been modified since the last call to abcg::FileWatcher::poll.
+ *
+ * On Linux, the watcher uses inotify on the parent directories of the watched
+ * files, so that editors that save by renaming a temporary file are also
+ * detected. On other platforms, the modification times are polled.
+ */
+class abcg::FileWatcher {
+ public:
+  FileWatcher();
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher(FileWatcher&&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+  FileWatcher& operator=(FileWatcher&&) = delete;
+
+  void addPath(std::string_view path);
+  [[nodiscard]] std::vector<std::string> poll();
+
+  [[nodiscard]] static std::string normalizePath(std::string_view path);
+
+ private:
+  void watch();
+
+  std::mutex m_mutex;
+  std::unordered_set<std::string> m_paths;
+  std::unordered_set<std::string> m_changedPaths;
+
+#if defined(__linux__)
+  int m_inotifyFD{-1};
+  std::unordered_map<int, std::string> m_watchedDirectories;
+#else
+  std::unordered_map<std::string, std::filesystem::file_time_type>
+      m_lastWriteTimes;
+#endif
+
+  std::atomic<bool> m_stop{false};
+  std::thread m_thread;
+};
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @file abcg_fixedtimestep.cpp
+ * @brief Definition of abcg::FixedTimestep class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_fixedtimestep.hpp"
+
+#include <algorithm>
+
+namespace {
+// Frame time is clamped so that a long stall (e.g. a breakpoint or a window
+// drag) does not trigger a burst of updates that would stall the next frame
+constexpr double maxFrameTime{0.25};
+}  // namespace
+
+abcg::FixedTimestep::~FixedTimestep() {
+  if (m_thread.joinable()) {
+    {
+      const std::scoped_lock lock{m_mutex};
+      m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+  }
+}
+
+/**
+ * @brief Sets the number of updates per second.
+ *
+ * @param updatesPerSecond Update rate. Must be positive.
+ */
+void abcg::FixedTimestep::setRate(double updatesPerSecond) noexcept {
+  if (updatesPerSecond > 0.0) m_step = 1.0 / updatesPerSecond;
+}
+
+/**
+ * @brief Adds the elapsed frame time to the accumulator and computes the
+ * number of updates to run.
+ *
+ * @param elapsedTime Time since the previous call, in seconds.
+ */
+void abcg::FixedTimestep::advance(double elapsedTime) noexcept {
+  m_accumulator += std::clamp(elapsedTime, 0.0, maxFrameTime);
+  m_pendingUpdates = static_cast<int>(m_accumulator / m_step);
+  m_accumulator -= m_pendingUpdates * m_step;
+}
+
+/**
+ * @brief Runs the pending updates on the calling thread.
+ *
+ * @param function Function called once per update, with the fixed time step
+ * in seconds.
+ */
+void abcg::FixedTimestep::update(const UpdateFunction& function) {
+  for (; m_pendingUpdates > 0; --m_pendingUpdates) {
+    function(m_step);
+  }
+}
+
+/**
+ * @brief Runs the pending updates on the worker thread.
+ *
+ * Returns immediately. abcg::FixedTimestep::wait must be called before the
+ * state modified by the updates is read again. With Emscripten, the updates
+ * run on the calling thread.
+ *
+ * @param function Function called once per update, with the fixed time step
+ * in seconds.
+ */
+void abcg::FixedTimestep::launch(UpdateFunction function) {
+  if (m_pendingUpdates == 0) return;
+
+#if defined(__EMSCRIPTEN__)
+  // Built without pthreads support
+  update(function);
+#else
+  if (!m_thread.joinable()) {
+    m_thread = std::thread{&FixedTimestep::work, this};
+  }
+
+  {
+    const std::scoped_lock lock{m_mutex};
+    m_function = std::move(function);
+    m_busy = true;
+  }
+  m_condition.notify_all();
+#endif
+}
+
+/**
+ * @brief Waits until the updates started by abcg::FixedTimestep::launch are
+ * finished.
+ */
+void abcg::FixedTimestep::wait() {
+  std::unique_lock lock{m_mutex};
+  m_condition.wait(lock, [this] { return !m_busy; });
+}
+
+/**
+ * @brief Returns the interpolation factor in [0, 1) between the state before
+ * and after the last update.
+ */
+double abcg::FixedTimestep::getAlpha() const noexcept {
+  return m_accumulator / m_step;
+}
+
+void abcg::FixedTimestep::work() {
+  std::unique_lock lock{m_mutex};
+  while (true) {
+    m_condition.wait(lock, [this] { return m_busy || m_stop; });
+    if (m_stop) return;
+
+    lock.unlock();
+    update(m_function);
+    lock.lock();
+
+    m_busy = false;
+    m_condition.notify_all();
+  }
+}
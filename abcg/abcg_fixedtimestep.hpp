@@ -0,0 +1,69 @@
+/**
+ * @file abcg_fixedtimestep.hpp
+ * @brief abcg::FixedTimestep header file.
+ *
+ * Declaration of abcg::FixedTimestep class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FIXEDTIMESTEP_HPP_
+#define ABCG_FIXEDTIMESTEP_HPP_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace abcg {
+class FixedTimestep;
+}  // namespace abcg
+
+/**
+ * @brief abcg::FixedTimestep class.
+ *
+ * Accumulates the frame time and converts it into a whole number of updates
+ * of fixed duration. The time left in the accumulator gives the interpolation
+ * factor between the last two simulation states.
+ *
+ * The updates can be run on the calling thread or on a worker thread, so
+ * that they overlap with other work of the caller.
+ */
+class abcg::FixedTimestep {
+ public:
+  using UpdateFunction = std::function<void(double)>;
+
+  FixedTimestep() = default;
+  ~FixedTimestep();
+
+  FixedTimestep(const FixedTimestep&) = delete;
+  FixedTimestep(FixedTimestep&&) = delete;
+  FixedTimestep& operator=(const FixedTimestep&) = delete;
+  FixedTimestep& operator=(FixedTimestep&&) = delete;
+
+  void setRate(double updatesPerSecond) noexcept;
+  void advance(double elapsedTime) noexcept;
+  void update(const UpdateFunction& function);
+  void launch(UpdateFunction function);
+  void wait();
+
+  [[nodiscard]] double getStep() const noexcept { return m_step; }
+  [[nodiscard]] double getAlpha() const noexcept;
+
+ private:
+  void work();
+
+  double m_step{1.0 / 60.0};
+  double m_accumulator{};
+  int m_pendingUpdates{};
+
+  // Worker thread, started by the first call to launch
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  UpdateFunction m_function;
+  bool m_busy{};
+  bool m_stop{};
+};
+
+#endif
@@ -0,0 +1,295 @@
+/**
+ * @file abcg_framecapture.cpp
+ * @brief Definition of abcg::FrameCapture class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_framecapture.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#include "abcg_exception.hpp"
+#include "abcg_openglfunctions.hpp"
+
+#if !defined(__EMSCRIPTEN__)
+#include "SDL_image.h"
+#endif
+
+namespace {
+constexpr std::size_t maxEncoderThreads{4};
+// Timeout of each wait for a fence, in nanoseconds
+constexpr GLuint64 fenceTimeout{1'000'000'000};
+}  // namespace
+
+abcg::FrameCapture::~FrameCapture() { stop(); }
+
+/**
+ * @brief Starts writing the captured frames to a directory.
+ *
+ * Images are named frame_000000, frame_000001, etc., numbered from the first
+ * captured frame.
+ *
+ * @param directory Output directory, created if needed.
+ * @param format Image format.
+ *
+ * @throw abcg::Exception if the directory cannot be created.
+ */
+void abcg::FrameCapture::start(std::filesystem::path directory,
+                               CaptureFormat format) {
+#if !defined(__EMSCRIPTEN__)
+  if (m_capturing) stop();
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to create {}: {}", directory.string(),
+                    error.message()))};
+  }
+
+  m_directory = std::move(directory);
+  m_format = format;
+  m_frame = 0;
+  m_droppedFrames = 0;
+  m_stop = false;
+
+  const auto numThreads{std::clamp<std::size_t>(
+      std::thread::hardware_concurrency() / 2, 1, maxEncoderThreads)};
+  for (std::size_t index{}; index < numThreads; ++index) {
+    m_threads.emplace_back(&FrameCapture::work, this);
+  }
+  m_capturing = true;
+#endif
+}
+
+/**
+ * @brief Writes the frames still in flight and stops capturing.
+ *
+ * Waits until all images are written. Must be called with the OpenGL context
+ * current.
+ */
+void abcg::FrameCapture::stop() {
+#if !defined(__EMSCRIPTEN__)
+  if (!m_capturing) return;
+
+  for (std::size_t index{}; index < poolSize; ++index) {
+    collect(index, true);
+  }
+
+  {
+    const std::scoped_lock lock{m_mutex};
+    m_stop = true;
+  }
+  m_condition.notify_all();
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+  m_threads.clear();
+
+  // All images are written, so every mapped buffer can be released
+  reclaim();
+  for (auto &slot : m_slots) {
+    abcg::glDeleteBuffers(1, &slot.buffer);
+    slot = {};
+  }
+
+  if (m_droppedFrames > 0) {
+    fmt::print("Warning: frame capture dropped {} of {} frames\n",
+               m_droppedFrames, m_frame);
+  }
+  m_capturing = false;
+#endif
+}
+
+/**
+ * @brief Captures the contents of the default framebuffer.
+ *
+ * Must be called after rendering and before swapping the buffers. Does
+ * nothing if abcg::FrameCapture::start was not called.
+ *
+ * @param width Width of the framebuffer.
+ * @param height Height of the framebuffer.
+ */
+void abcg::FrameCapture::capture([[maybe_unused]] int width,
+                                 [[maybe_unused]] int height) {
+#if !defined(__EMSCRIPTEN__)
+  if (!m_capturing || width <= 0 || height <= 0) return;
+
+  // Release the buffers of the written images, and hand over the frames that
+  // are ready
+  reclaim();
+  for (std::size_t index{}; index < poolSize; ++index) {
+    collect(index, false);
+  }
+
+  const auto frame{m_frame++};
+  const auto freeSlot{std::ranges::find_if(m_slots, [](const Slot &slot) {
+    return slot.fence == nullptr && slot.data == nullptr;
+  })};
+  if (freeSlot == m_slots.end()) {
+    // The GPU or the encoders fall behind. Waiting for them would stall the
+    // frame, so the frame is dropped instead
+    ++m_droppedFrames;
+    return;
+  }
+  auto &slot{*freeSlot};
+
+  const auto size{static_cast<std::size_t>(width) *
+                  static_cast<std::size_t>(height) * 4};
+  if (slot.buffer == 0) abcg::glGenBuffers(1, &slot.buffer);
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  if (slot.size != size) {
+    abcg::glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size),
+                       nullptr, GL_STREAM_READ);
+    slot.size = size;
+  }
+  abcg::glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  slot.fence = abcg::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  slot.width = width;
+  slot.height = height;
+  slot.frame = frame;
+#endif
+}
+
+// Maps the buffer of a slot whose pixels have arrived and hands it to the
+// encoder threads
+void abcg::FrameCapture::collect([[maybe_unused]] std::size_t index,
+                                 [[maybe_unused]] bool wait) {
+#if !defined(__EMSCRIPTEN__)
+  auto &slot{m_slots.at(index)};
+  if (slot.fence == nullptr) return;
+
+  auto status{abcg::glClientWaitSync(slot.fence, 0, 0)};
+  while (wait && status == GL_TIMEOUT_EXPIRED) {
+    status = abcg::glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                    fenceTimeout);
+  }
+  if (status == GL_TIMEOUT_EXPIRED) return;
+  abcg::glDeleteSync(slot.fence);
+  slot.fence = nullptr;
+
+  // The buffer stays mapped until its image is written
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  slot.data = static_cast<const std::uint8_t *>(
+      abcg::glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                             static_cast<GLsizeiptr>(slot.size),
+                             GL_MAP_READ_BIT));
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (slot.data == nullptr) {
+    ++m_droppedFrames;
+    return;
+  }
+
+  {
+    const std::scoped_lock lock{m_mutex};
+    m_images.push_back({.slot = index,
+                        .pixels = slot.data,
+                        .width = slot.width,
+                        .height = slot.height,
+                        .frame = slot.frame});
+  }
+  m_condition.notify_one();
+#endif
+}
+
+// Unmaps the buffers of the images written by the encoder threads, so that
+// they can be reused
+void abcg::FrameCapture::reclaim() {
+  {
+    const std::scoped_lock lock{m_mutex};
+    std::swap(m_writtenSlots, m_unmapSlots);
+  }
+  for (const auto index : m_unmapSlots) {
+    unmap(m_slots.at(index));
+  }
+  m_unmapSlots.clear();
+}
+
+void abcg::FrameCapture::unmap(Slot &slot) {
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  abcg::glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.data = nullptr;
+}
+
+// Runs on an encoder thread. The pixels are in mapped memory, which is only
+// read, so the rows are flipped while they are copied to the scratch buffer
+void abcg::FrameCapture::write(
+    [[maybe_unused]] const Image &image,
+    [[maybe_unused]] std::vector<std::uint8_t> &scratch) const {
+#if !defined(__EMSCRIPTEN__)
+  const auto rowSize{static_cast<std::size_t>(image.width) * 4};
+  const auto height{static_cast<std::size_t>(image.height)};
+
+  // OpenGL rows are stored from bottom to top
+  const auto sourceRow{[&](std::size_t row) {
+    return image.pixels + (height - 1 - row) * rowSize;
+  }};
+
+  const auto path{m_directory /
+                  fmt::format("frame_{:06}.{}", image.frame,
+                              m_format == CaptureFormat::PNG ? "png" : "ppm")};
+
+  if (m_format == CaptureFormat::PNG) {
+    scratch.resize(rowSize * height);
+    for (std::size_t row{}; row < height; ++row) {
+      std::memcpy(scratch.data() + row * rowSize, sourceRow(row), rowSize);
+    }
+
+    auto *surface{SDL_CreateRGBSurfaceWithFormatFrom(
+        scratch.data(), image.width, image.height, 32,
+        static_cast<int>(rowSize), SDL_PIXELFORMAT_RGBA32)};
+    if (surface == nullptr ||
+        IMG_SavePNG(surface, path.string().c_str()) != 0) {
+      fmt::print(stderr, "Failed to write {}: {}\n", path.string(),
+                 SDL_GetError());
+    }
+    SDL_FreeSurface(surface);
+    return;
+  }
+
+  std::ofstream stream{path, std::ios::binary};
+  stream << fmt::format("P6\n{} {}\n255\n", image.width, image.height);
+  // Drop the alpha channel
+  scratch.resize(static_cast<std::size_t>(image.width) * 3);
+  for (std::size_t row{}; row < height; ++row) {
+    const auto *source{sourceRow(row)};
+    for (std::size_t column{}; column < scratch.size() / 3; ++column) {
+      std::memcpy(&scratch.at(column * 3), source + column * 4, 3);
+    }
+    stream.write(reinterpret_cast<const char *>(scratch.data()),
+                 static_cast<std::streamsize>(scratch.size()));
+  }
+  if (!stream) {
+    fmt::print(stderr, "Failed to write {}\n", path.string());
+  }
+#endif
+}
+
+void abcg::FrameCapture::work() {
+  // Reused by the images written by this thread
+  std::vector<std::uint8_t> scratch;
+
+  std::unique_lock lock{m_mutex};
+  while (true) {
+    m_condition.wait(lock, [this] { return m_stop || !m_images.empty(); });
+    if (m_images.empty()) return;
+
+    const auto image{m_images.front()};
+    m_images.pop_front();
+    lock.unlock();
+
+    write(image, scratch);
+
+    lock.lock();
+    m_writtenSlots.push_back(image.slot);
+  }
+}
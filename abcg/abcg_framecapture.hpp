@@ -0,0 +1,127 @@
+/**
+ * @file abcg_framecapture.hpp
+ * @brief abcg::FrameCapture header file.
+ *
+ * Declaration of abcg::CaptureFormat enumeration and abcg::FrameCapture
+ * class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAMECAPTURE_HPP_
+#define ABCG_FRAMECAPTURE_HPP_
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+enum class CaptureFormat;
+class FrameCapture;
+}  // namespace abcg
+
+/**
+ * @brief Enumeration of image formats written by abcg::FrameCapture.
+ *
+ * - PNG: compressed RGBA images;
+ * - PPM: uncompressed binary RGB images, faster to write.
+ */
+enum class abcg::CaptureFormat { PNG, PPM };
+
+/**
+ * @brief abcg::FrameCapture class.
+ *
+ * Writes the frames rendered to the default framebuffer as a numbered image
+ * sequence.
+ *
+ * Each frame is read into a free pixel buffer object of a pool of
+ * abcg::FrameCapture::poolSize buffers, followed by a fence. The buffer is
+ * mapped a few frames later, when the fence is signaled, so that the CPU
+ * does not wait for the GPU, and the mapped memory is handed to worker
+ * threads that encode and write the image straight from it. The buffer is
+ * unmapped and reused once its image is written.
+ *
+ * The thread that renders never waits: if no buffer is free because the
+ * GPU or the workers fall behind, the frame is dropped and counted (see
+ * abcg::FrameCapture::getDroppedFrameCount). Dropped frames leave gaps in
+ * the numbering of the images.
+ *
+ * Not available with Emscripten, as WebGL cannot map buffers.
+ */
+class abcg::FrameCapture {
+ public:
+  static constexpr std::size_t poolSize{8};
+
+  FrameCapture() = default;
+  ~FrameCapture();
+
+  FrameCapture(const FrameCapture&) = delete;
+  FrameCapture(FrameCapture&&) = delete;
+  FrameCapture& operator=(const FrameCapture&) = delete;
+  FrameCapture& operator=(FrameCapture&&) = delete;
+
+  void start(std::filesystem::path directory, CaptureFormat format);
+  void stop();
+  void capture(int width, int height);
+
+  [[nodiscard]] bool isCapturing() const noexcept { return m_capturing; }
+  [[nodiscard]] std::uint64_t getDroppedFrameCount() const noexcept {
+    return m_droppedFrames;
+  }
+
+ private:
+  struct Slot {
+    GLuint buffer{};
+    GLsync fence{};
+    std::size_t size{};
+    int width{};
+    int height{};
+    std::uint64_t frame{};
+    // Mapped memory, read by a worker until the image is written
+    const std::uint8_t* data{};
+  };
+
+  struct Image {
+    // Index of the slot whose mapped memory holds the pixels
+    std::size_t slot{};
+    const std::uint8_t* pixels{};
+    int width{};
+    int height{};
+    std::uint64_t frame{};
+  };
+
+  void collect(std::size_t index, bool wait);
+  void reclaim();
+  static void unmap(Slot& slot);
+  void write(const Image& image, std::vector<std::uint8_t>& scratch) const;
+  void work();
+
+  std::filesystem::path m_directory;
+  CaptureFormat m_format{CaptureFormat::PNG};
+  bool m_capturing{};
+  std::uint64_t m_frame{};
+  std::uint64_t m_droppedFrames{};
+
+  // Slots are only accessed by the thread that renders
+  std::array<Slot, poolSize> m_slots{};
+
+  // Encoder threads
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::deque<Image> m_images;
+  // Slots of the written images, to be unmapped by the thread that renders
+  std::vector<std::size_t> m_writtenSlots;
+  std::vector<std::size_t> m_unmapSlots;
+  bool m_stop{};
+};
+
+#endif
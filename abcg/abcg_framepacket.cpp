@@ -0,0 +1,40 @@
+/**
+ * @file abcg_framepacket.cpp
+ * @brief Definition of abcg::ImGuiDrawSnapshot class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_framepacket.hpp"
+
+#include <span>
+
+abcg::ImGuiDrawSnapshot::~ImGuiDrawSnapshot() { clear(); }
+
+/**
+ * @brief Copies the draw lists of the given draw data.
+ *
+ * @param drawData Draw data returned by ImGui::GetDrawData after
+ * ImGui::Render.
+ */
+void abcg::ImGuiDrawSnapshot::capture(const ImDrawData& drawData) {
+  clear();
+
+  const std::span drawLists{drawData.CmdLists,
+                            static_cast<std::size_t>(drawData.CmdListsCount)};
+  m_drawLists.reserve(drawLists.size());
+  for (const auto* drawList : drawLists) {
+    m_drawLists.push_back(drawList->CloneOutput());
+  }
+
+  m_drawData = drawData;
+  m_drawData.CmdLists = m_drawLists.data();
+}
+
+void abcg::ImGuiDrawSnapshot::clear() {
+  for (auto* drawList : m_drawLists) {
+    IM_DELETE(drawList);
+  }
+  m_drawLists.clear();
+  m_drawData.Clear();
+}
@@ -0,0 +1,100 @@
+/**
+ * @file abcg_framepacket.hpp
+ * @brief abcg::FramePacket header file.
+ *
+ * Declaration of abcg::ImGuiDrawSnapshot class and abcg::FramePacket.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAMEPACKET_HPP_
+#define ABCG_FRAMEPACKET_HPP_
+
+#include <imgui.h>
+
+#include <any>
+#include <cstdint>
+#include <filesystem>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+#include "abcg_framecapture.hpp"
+#include "abcg_openglfunctions.hpp"
+#include "abcg_renderqueue.hpp"
+
+namespace abcg {
+class ImGuiDrawSnapshot;
+struct FramePacket;
+}  // namespace abcg
+
+/**
+ * @brief abcg::ImGuiDrawSnapshot class.
+ *
+ * Copy of the ImGui draw data of a frame, which remains valid after the next
+ * call to ImGui::NewFrame.
+ */
+class abcg::ImGuiDrawSnapshot {
+ public:
+  ImGuiDrawSnapshot() = default;
+  ~ImGuiDrawSnapshot();
+
+  ImGuiDrawSnapshot(const ImGuiDrawSnapshot&) = delete;
+  ImGuiDrawSnapshot(ImGuiDrawSnapshot&&) = delete;
+  ImGuiDrawSnapshot& operator=(const ImGuiDrawSnapshot&) = delete;
+  ImGuiDrawSnapshot& operator=(ImGuiDrawSnapshot&&) = delete;
+
+  void capture(const ImDrawData& drawData);
+  [[nodiscard]] ImDrawData* get() noexcept { return &m_drawData; }
+
+ private:
+  void clear();
+
+  ImDrawData m_drawData{};
+  std::vector<ImDrawList*> m_drawLists;
+};
+
+/**
+ * @brief Immutable description of a frame, recorded on the main thread and
+ * rendered by abcg::OpenGLWindow.
+ *
+ * When abcg::WindowSettings::renderThread is enabled, packets are passed to
+ * the render thread through an abcg::TripleBuffer. Everything paintGL needs
+ * from the main thread must then be in the packet, which is only read by the
+ * render thread once published.
+ */
+struct abcg::FramePacket {
+  std::uint64_t frame{};
+  int viewportWidth{};
+  int viewportHeight{};
+  // Values of abcg::OpenGLWindow::getDeltaTime and
+  // abcg::OpenGLWindow::getInterpolationAlpha when the packet was recorded
+  double deltaTime{};
+  double interpolationAlpha{};
+  // Draws recorded by abcg::OpenGLWindow::recordFrame, executed after
+  // abcg::OpenGLWindow::paintGL
+  CommandList commandList;
+  // Camera and world matrices of the objects of the frame, set by
+  // abcg::OpenGLWindow::recordFrame. The order of the matrices is chosen by
+  // the application
+  glm::mat4 viewMatrix{1.0f};
+  glm::mat4 projMatrix{1.0f};
+  std::vector<glm::mat4> transforms;
+  // Other state of the application read by paintGL (e.g. UI settings). The
+  // value is kept when the packet is reused, so that its memory is recycled
+  std::any userData;
+  // ImGui draw data of the frame. Points to a snapshot when rendered on the
+  // render thread
+  ImDrawData* drawData{};
+  ImGuiDrawSnapshot drawSnapshot;
+  // Capture state set with abcg::OpenGLWindow::startCapture
+  bool capture{};
+  CaptureFormat captureFormat{};
+  std::filesystem::path captureDirectory;
+#if defined(ABCG_GL_STATE_CACHE)
+  // Written when the packet is rendered, and read back by the main thread
+  // when the buffer is reused
+  OpenGLStateCacheCounters glStateCacheCounters{};
+#endif
+};
+
+#endif
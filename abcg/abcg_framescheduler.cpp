@@ -0,0 +1,163 @@
+/**
+ * @file abcg_framescheduler.cpp
+ * @brief Definition of abcg::FrameScheduler class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_framescheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+// Number of frames painted after an event, so that the UI can settle (e.g.
+// ImGui hover and focus changes are only visible in the following frame)
+constexpr int framesPerEvent{3};
+
+// Sleeping may overshoot by about a millisecond, so the last part of the wait
+// is spent spinning
+constexpr std::chrono::milliseconds spinThreshold{2};
+}  // namespace
+
+/**
+ * @brief Registers the event type used to wake up the main loop.
+ *
+ * Must be called after SDL has been initialized.
+ */
+void abcg::FrameScheduler::initialize() {
+  m_wakeEventType = SDL_RegisterEvents(1);
+  if (m_wakeEventType == static_cast<Uint32>(-1)) m_wakeEventType = 0;
+  m_nextFrameTime = clock::now();
+}
+
+/**
+ * @brief Sets the scheduling mode.
+ *
+ * @param mode Frame scheduling mode.
+ * @param targetFPS Frame rate of abcg::FrameMode::TargetFPS.
+ * @param hiddenFPS Maximum frame rate while the window is hidden or
+ * minimized. If zero, no frames are painted while hidden, except on request.
+ */
+void abcg::FrameScheduler::setMode(FrameMode mode, double targetFPS,
+                                   double hiddenFPS) noexcept {
+  m_mode = mode;
+  m_targetFPS = targetFPS;
+  m_hiddenFPS = hiddenFPS;
+}
+
+/**
+ * @brief Sets whether the window is visible.
+ *
+ * @param visible false if the window is hidden or minimized.
+ */
+void abcg::FrameScheduler::setVisible(bool visible) noexcept {
+  if (visible && !m_visible) notifyEvent();
+  m_visible = visible;
+}
+
+/**
+ * @brief Schedules the frames that follow an event in on-demand mode.
+ *
+ * Called from the thread of the main loop.
+ */
+void abcg::FrameScheduler::notifyEvent() noexcept {
+  m_pendingFrames = framesPerEvent;
+}
+
+/**
+ * @brief Requests a new frame in on-demand mode.
+ *
+ * Thread-safe. If the main loop is blocked waiting for events, it is woken
+ * up.
+ */
+void abcg::FrameScheduler::requestRedraw() {
+  if (m_pendingFrames.exchange(framesPerEvent) == 0 && m_wakeEventType != 0) {
+    SDL_Event event{};
+    event.type = m_wakeEventType;
+    SDL_PushEvent(&event);
+  }
+}
+
+/**
+ * @brief Waits for the next event or until the next frame is due.
+ *
+ * @param event Event retrieved from the queue, if any.
+ *
+ * @return true if an event was retrieved, false if a new frame can be
+ * painted.
+ */
+bool abcg::FrameScheduler::waitEvent(SDL_Event &event) {
+#if defined(__EMSCRIPTEN__)
+  // The browser schedules the main loop
+  return SDL_PollEvent(&event) != 0;
+#else
+  while (true) {
+    if (SDL_PollEvent(&event) != 0) return true;
+
+    if (isOnDemand() && m_pendingFrames == 0) {
+      // Block until input arrives or a redraw is requested
+      if (SDL_WaitEvent(&event) != 0) return true;
+      continue;
+    }
+
+    const auto remaining{m_nextFrameTime - clock::now()};
+    if (remaining <= clock::duration::zero()) return false;
+
+    if (remaining > spinThreshold) {
+      const auto timeout{std::chrono::duration_cast<std::chrono::milliseconds>(
+          remaining - spinThreshold)};
+      if (SDL_WaitEventTimeout(&event, static_cast<int>(timeout.count())) !=
+          0) {
+        return true;
+      }
+    } else {
+      while (clock::now() < m_nextFrameTime) {
+        std::this_thread::yield();
+      }
+      return false;
+    }
+  }
+#endif
+}
+
+/**
+ * @brief Returns true if the event was pushed by
+ * abcg::FrameScheduler::requestRedraw.
+ */
+bool abcg::FrameScheduler::isWakeEvent(const SDL_Event &event) const noexcept {
+  return m_wakeEventType != 0 && event.type == m_wakeEventType;
+}
+
+/**
+ * @brief Returns true if a new frame must be painted now, and schedules the
+ * next one.
+ */
+bool abcg::FrameScheduler::beginFrame() {
+  if (isOnDemand() && m_pendingFrames == 0) return false;
+
+  if (const auto period{getFramePeriod()}; period > clock::duration::zero()) {
+    const auto now{clock::now()};
+    if (now < m_nextFrameTime) return false;
+    // Keep the frame phase, but do not try to catch up with missed frames
+    m_nextFrameTime = std::max(m_nextFrameTime + period, now);
+  }
+
+  if (m_pendingFrames > 0) --m_pendingFrames;
+  return true;
+}
+
+bool abcg::FrameScheduler::isOnDemand() const noexcept {
+  return m_mode == FrameMode::OnDemand || (!m_visible && m_hiddenFPS <= 0.0);
+}
+
+abcg::FrameScheduler::clock::duration
+abcg::FrameScheduler::getFramePeriod() const noexcept {
+  auto fps{m_mode == FrameMode::TargetFPS ? m_targetFPS : 0.0};
+  if (!m_visible && m_hiddenFPS > 0.0) {
+    fps = fps > 0.0 ? std::min(fps, m_hiddenFPS) : m_hiddenFPS;
+  }
+  if (fps <= 0.0) return clock::duration::zero();
+  return std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>{1.0 / fps});
+}
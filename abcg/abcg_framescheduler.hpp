@@ -0,0 +1,74 @@
+/**
+ * @file abcg_framescheduler.hpp
+ * @brief abcg::FrameScheduler header file.
+ *
+ * Declaration of abcg::FrameMode enumeration and abcg::FrameScheduler class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAMESCHEDULER_HPP_
+#define ABCG_FRAMESCHEDULER_HPP_
+
+#include <atomic>
+#include <chrono>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+enum class FrameMode;
+class FrameScheduler;
+}  // namespace abcg
+
+/**
+ * @brief Enumeration of frame scheduling modes.
+ *
+ * - Continuous: paints frames as fast as possible (or at the display refresh
+ * rate if vsync is enabled);
+ * - TargetFPS: paints frames at abcg::WindowSettings::targetFPS;
+ * - OnDemand: paints frames only after an event is received or a redraw is
+ * requested with abcg::OpenGLWindow::requestRedraw.
+ */
+enum class abcg::FrameMode { Continuous, TargetFPS, OnDemand };
+
+/**
+ * @brief abcg::FrameScheduler class.
+ *
+ * Decides when the main loop paints a new frame, and blocks in the SDL event
+ * queue in between so that idle applications do not keep the CPU and GPU
+ * busy. Frames are throttled to a lower rate when the window is hidden or
+ * minimized.
+ *
+ * Frame deadlines are met by sleeping in SDL_WaitEventTimeout, which also
+ * wakes up on input, and then spinning for the last milliseconds.
+ */
+class abcg::FrameScheduler {
+ public:
+  void initialize();
+  void setMode(FrameMode mode, double targetFPS, double hiddenFPS) noexcept;
+  void setVisible(bool visible) noexcept;
+  void notifyEvent() noexcept;
+  void requestRedraw();
+
+  [[nodiscard]] bool waitEvent(SDL_Event& event);
+  [[nodiscard]] bool isWakeEvent(const SDL_Event& event) const noexcept;
+  [[nodiscard]] bool beginFrame();
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  [[nodiscard]] bool isOnDemand() const noexcept;
+  [[nodiscard]] clock::duration getFramePeriod() const noexcept;
+
+  FrameMode m_mode{FrameMode::Continuous};
+  double m_targetFPS{60.0};
+  double m_hiddenFPS{1.0};
+  bool m_visible{true};
+
+  clock::time_point m_nextFrameTime{clock::now()};
+  // Number of frames to paint in on-demand mode
+  std::atomic<int> m_pendingFrames{1};
+  Uint32 m_wakeEventType{};
+};
+
+#endif
@@ -0,0 +1,211 @@
+/**
+ * @file abcg_frustum.cpp
+ * @brief Definition of abcg::BoundingSpheres and abcg::Frustum class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_frustum.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_access.hpp>
+
+#include "abcg_workerpool.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// Sphere sets smaller than this are culled on the calling thread
+constexpr std::size_t minParallelCount{65536};
+// Smallest number of spheres culled by each thread
+constexpr std::size_t minThreadCount{32768};
+}  // namespace
+
+void abcg::BoundingSpheres::clear() noexcept {
+  m_centersX.clear();
+  m_centersY.clear();
+  m_centersZ.clear();
+  m_radii.clear();
+}
+
+void abcg::BoundingSpheres::reserve(std::size_t count) {
+  m_centersX.reserve(count);
+  m_centersY.reserve(count);
+  m_centersZ.reserve(count);
+  m_radii.reserve(count);
+}
+
+/**
+ * @brief Sets the number of spheres. New spheres have zero radius.
+ */
+void abcg::BoundingSpheres::resize(std::size_t count) {
+  m_centersX.resize(count);
+  m_centersY.resize(count);
+  m_centersZ.resize(count);
+  m_radii.resize(count);
+}
+
+/**
+ * @brief Appends a sphere.
+ *
+ * @return Index of the new sphere.
+ */
+std::size_t abcg::BoundingSpheres::add(const glm::vec3 &center,
+                                       float radius) {
+  m_centersX.push_back(center.x);
+  m_centersY.push_back(center.y);
+  m_centersZ.push_back(center.z);
+  m_radii.push_back(radius);
+  return m_radii.size() - 1;
+}
+
+void abcg::BoundingSpheres::set(std::size_t index, const glm::vec3 &center,
+                                float radius) {
+  m_centersX.at(index) = center.x;
+  m_centersY.at(index) = center.y;
+  m_centersZ.at(index) = center.z;
+  m_radii.at(index) = radius;
+}
+
+glm::vec3 abcg::BoundingSpheres::getCenter(std::size_t index) const {
+  return {m_centersX.at(index), m_centersY.at(index), m_centersZ.at(index)};
+}
+
+float abcg::BoundingSpheres::getRadius(std::size_t index) const {
+  return m_radii.at(index);
+}
+
+/**
+ * @brief Constructs the frustum of a view-projection matrix.
+ *
+ * @param viewProjMatrix Projection matrix times view matrix. If it also
+ * includes a model matrix, spheres are tested in that model space.
+ */
+abcg::Frustum::Frustum(const glm::mat4 &viewProjMatrix) {
+  // Each plane bounds one clip coordinate: -w <= x, y, z <= w
+  const auto row0{glm::row(viewProjMatrix, 0)};
+  const auto row1{glm::row(viewProjMatrix, 1)};
+  const auto row2{glm::row(viewProjMatrix, 2)};
+  const auto row3{glm::row(viewProjMatrix, 3)};
+  m_planes = {row3 + row0, row3 - row0, row3 + row1,
+              row3 - row1, row3 + row2, row3 - row2};
+  for (auto &plane : m_planes) {
+    plane /= glm::length(glm::vec3{plane});
+  }
+}
+
+/**
+ * @brief Returns whether a sphere is at least partially inside the frustum.
+ *
+ * Spheres near the corners of the frustum may be reported visible even
+ * though they are outside.
+ */
+bool abcg::Frustum::isVisible(const glm::vec3 &center,
+                              float radius) const noexcept {
+  return std::all_of(m_planes.begin(), m_planes.end(), [&](const auto &plane) {
+    return glm::dot(glm::vec3{plane}, center) + plane.w >= -radius;
+  });
+}
+
+/**
+ * @brief Computes the indices of the spheres that are visible.
+ *
+ * @param spheres Spheres to test.
+ * @param visible Receives the indices of the visible spheres in increasing
+ * order, e.g. to compact the instance data of the visible objects.
+ */
+void abcg::Frustum::cull(const BoundingSpheres &spheres,
+                         std::vector<std::uint32_t> &visible) const {
+  visible.clear();
+  const auto count{spheres.size()};
+
+  auto &workerPool{WorkerPool::shared()};
+  auto numThreads{std::size_t{1}};
+  if (count >= minParallelCount) {
+    numThreads = std::clamp<std::size_t>(count / minThreadCount, 1,
+                                         workerPool.getThreadCount());
+  }
+  if (numThreads == 1) {
+    visible.reserve(count);
+    cullRange(spheres, 0, count, visible);
+    return;
+  }
+
+  // Ranges start at multiples of 8, so that each thread processes whole SIMD
+  // blocks
+  const auto rangeSize{((count + numThreads - 1) / numThreads + 7) / 8 * 8};
+  std::vector<std::vector<std::uint32_t>> rangeVisible(numThreads);
+  workerPool.parallelFor(numThreads, [&](std::size_t index) {
+    const auto first{std::min(index * rangeSize, count)};
+    const auto last{std::min(first + rangeSize, count)};
+    cullRange(spheres, first, last, rangeVisible.at(index));
+  });
+
+  for (const auto &indices : rangeVisible) {
+    visible.insert(visible.end(), indices.begin(), indices.end());
+  }
+}
+
+void abcg::Frustum::cullRange(const BoundingSpheres &spheres,
+                              std::size_t first, std::size_t last,
+                              std::vector<std::uint32_t> &visible) const {
+  const auto *centersX{spheres.m_centersX.data()};
+  const auto *centersY{spheres.m_centersY.data()};
+  const auto *centersZ{spheres.m_centersZ.data()};
+  const auto *radii{spheres.m_radii.data()};
+
+  auto index{first};
+
+#if defined(__AVX__)
+  struct Plane {
+    __m256 a, b, c, d;
+  };
+  std::array<Plane, 6> planes{};
+  for (std::size_t plane{}; plane < m_planes.size(); ++plane) {
+    const auto &coefficients{m_planes.at(plane)};
+    planes.at(plane) = {_mm256_set1_ps(coefficients.x),
+                        _mm256_set1_ps(coefficients.y),
+                        _mm256_set1_ps(coefficients.z),
+                        _mm256_set1_ps(coefficients.w)};
+  }
+
+  for (; index + 8 <= last; index += 8) {
+    const auto x{_mm256_loadu_ps(centersX + index)};
+    const auto y{_mm256_loadu_ps(centersY + index)};
+    const auto z{_mm256_loadu_ps(centersZ + index)};
+    const auto negRadius{
+        _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radii + index))};
+
+    // Signed distance to each plane, compared with -radius
+    auto inside{_mm256_castsi256_ps(_mm256_set1_epi32(-1))};
+    for (const auto &[a, b, c, d] : planes) {
+      const auto distance{_mm256_add_ps(
+          _mm256_add_ps(
+              _mm256_add_ps(_mm256_mul_ps(a, x), _mm256_mul_ps(b, y)),
+              _mm256_mul_ps(c, z)),
+          d)};
+      inside = _mm256_and_ps(
+          inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+    }
+
+    auto mask{static_cast<unsigned>(_mm256_movemask_ps(inside))};
+    while (mask != 0) {
+      visible.push_back(
+          static_cast<std::uint32_t>(index) +
+          static_cast<std::uint32_t>(std::countr_zero(mask)));
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  for (; index < last; ++index) {
+    if (isVisible({centersX[index], centersY[index], centersZ[index]},
+                  radii[index])) {
+      visible.push_back(static_cast<std::uint32_t>(index));
+    }
+  }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file abcg_frustum.hpp
+ * @brief abcg::Frustum header file.
+ *
+ * Declaration of abcg::BoundingSpheres and abcg::Frustum classes.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRUSTUM_HPP_
+#define ABCG_FRUSTUM_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace abcg {
+class BoundingSpheres;
+class Frustum;
+}  // namespace abcg
+
+/**
+ * @brief abcg::BoundingSpheres class.
+ *
+ * Stores bounding spheres as a structure of arrays (one array for each
+ * coordinate of the centers and one for the radii), so that
+ * abcg::Frustum::cull can test several spheres with each SIMD instruction.
+ */
+class abcg::BoundingSpheres {
+ public:
+  void clear() noexcept;
+  void reserve(std::size_t count);
+  void resize(std::size_t count);
+  std::size_t add(const glm::vec3& center, float radius);
+  void set(std::size_t index, const glm::vec3& center, float radius);
+
+  [[nodiscard]] glm::vec3 getCenter(std::size_t index) const;
+  [[nodiscard]] float getRadius(std::size_t index) const;
+  [[nodiscard]] std::size_t size() const noexcept { return m_radii.size(); }
+
+ private:
+  friend Frustum;
+
+  std::vector<float> m_centersX;
+  std::vector<float> m_centersY;
+  std::vector<float> m_centersZ;
+  std::vector<float> m_radii;
+};
+
+/**
+ * @brief abcg::Frustum class.
+ *
+ * View frustum defined by the six planes of the clip volume of a
+ * view-projection matrix, used to skip objects that cannot be seen.
+ *
+ * abcg::Frustum::cull tests 8 spheres per iteration when ABCg is built with
+ * AVX (ABCG_AVX CMake option), and splits large sets of spheres across
+ * the threads of abcg::WorkerPool::shared.
+ */
+class abcg::Frustum {
+ public:
+  Frustum() = default;
+  explicit Frustum(const glm::mat4& viewProjMatrix);
+
+  [[nodiscard]] bool isVisible(const glm::vec3& center,
+                               float radius) const noexcept;
+  void cull(const BoundingSpheres& spheres,
+            std::vector<std::uint32_t>& visible) const;
+
+  /**
+   * @brief Returns the left, right, bottom, top, near and far planes.
+   *
+   * Each plane is stored as (a, b, c, d), where (a, b, c) is the unit normal
+   * pointing inside the frustum.
+   */
+  [[nodiscard]] const std::array<glm::vec4, 6>& getPlanes() const noexcept {
+    return m_planes;
+  }
+
+ private:
+  void cullRange(const BoundingSpheres& spheres, std::size_t first,
+                 std::size_t last, std::vector<std::uint32_t>& visible) const;
+
+  std::array<glm::vec4, 6> m_planes{};
+};
+
+#endif
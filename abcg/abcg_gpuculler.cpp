@@ -0,0 +1,260 @@
+/**
+ * @file abcg_gpuculler.cpp
+ * @brief Definition of abcg::GPUCuller class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_gpuculler.hpp"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcg_exception.hpp"
+#include "abcg_frustum.hpp"
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+constexpr GLuint workGroupSize{64};
+
+// Shader storage buffer binding points
+constexpr GLuint boundsBinding{0};
+constexpr GLuint transformsBinding{1};
+constexpr GLuint visibleTransformsBinding{2};
+constexpr GLuint commandBinding{3};
+
+// Each invocation tests one bounding sphere (center, radius) against the
+// frustum planes and appends the model matrix of a visible instance to the
+// output buffer, counting it in the indirect command
+constexpr std::string_view computeShaderSource{R"glsl(#version 430 core
+
+layout(local_size_x = 64) in;
+
+struct DrawElementsIndirectCommand {
+  uint count;
+  uint instanceCount;
+  uint firstIndex;
+  int baseVertex;
+  uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Bounds { vec4 bounds[]; };
+layout(std430, binding = 1) readonly buffer Transforms { mat4 transforms[]; };
+layout(std430, binding = 2) writeonly buffer VisibleTransforms {
+  mat4 visibleTransforms[];
+};
+layout(std430, binding = 3) buffer Command {
+  DrawElementsIndirectCommand command;
+};
+
+uniform vec4 planes[6];
+uniform uint instanceCount;
+
+void main() {
+  uint index = gl_GlobalInvocationID.x;
+  if (index >= instanceCount) return;
+
+  vec4 sphere = bounds[index];
+  for (int plane = 0; plane < 6; ++plane) {
+    if (dot(planes[plane].xyz, sphere.xyz) + planes[plane].w < -sphere.w) {
+      return;
+    }
+  }
+
+  uint slot = atomicAdd(command.instanceCount, 1u);
+  visibleTransforms[slot] = transforms[index];
+})glsl"};
+}  // namespace
+
+abcg::GPUCuller::~GPUCuller() { terminate(); }
+
+/**
+ * @brief Returns true if the current OpenGL context supports compute shaders
+ * and indirect multi-draws (OpenGL 4.3).
+ */
+bool abcg::GPUCuller::isSupported() {
+#if defined(__EMSCRIPTEN__) || defined(__APPLE__)
+  return false;
+#else
+  const auto *version{
+      reinterpret_cast<const char *>(abcg::glGetString(GL_VERSION))};
+  if (version == nullptr || std::string_view{version}.starts_with("OpenGL ES"))
+    return false;
+
+  GLint majorVersion{};
+  GLint minorVersion{};
+  abcg::glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+  abcg::glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+  return majorVersion > 4 || (majorVersion == 4 && minorVersion >= 3);
+#endif
+}
+
+/**
+ * @brief Builds the compute shader and creates the buffers.
+ *
+ * Must be called with an OpenGL 4.3 context current.
+ *
+ * @throw abcg::Exception if the compute shader fails to build.
+ */
+void abcg::GPUCuller::initialize() {
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  terminate();
+
+  const auto shader{abcg::glCreateShader(GL_COMPUTE_SHADER)};
+  const auto *source{computeShaderSource.data()};
+  abcg::glShaderSource(shader, 1, &source, nullptr);
+  abcg::glCompileShader(shader);
+
+  m_program = abcg::glCreateProgram();
+  abcg::glAttachShader(m_program, shader);
+  abcg::glLinkProgram(m_program);
+  abcg::glDeleteShader(shader);
+
+  GLint linkStatus{};
+  abcg::glGetProgramiv(m_program, GL_LINK_STATUS, &linkStatus);
+  if (linkStatus == 0) {
+    GLint infoLogLength{};
+    abcg::glGetProgramiv(m_program, GL_INFO_LOG_LENGTH, &infoLogLength);
+    std::vector<GLchar> infoLog(static_cast<std::size_t>(infoLogLength) + 1);
+    abcg::glGetProgramInfoLog(m_program, infoLogLength, nullptr,
+                              infoLog.data());
+    terminate();
+    throw abcg::Exception{abcg::Exception::Runtime(
+        "Failed to build culling compute shader: " +
+        std::string{infoLog.data()})};
+  }
+
+  m_planesLocation = abcg::glGetUniformLocation(m_program, "planes");
+  m_instanceCountLocation =
+      abcg::glGetUniformLocation(m_program, "instanceCount");
+
+  abcg::glGenBuffers(1, &m_boundsBuffer);
+  abcg::glGenBuffers(1, &m_transformsBuffer);
+  abcg::glGenBuffers(1, &m_visibleTransformsBuffer);
+  abcg::glGenBuffers(1, &m_indirectBuffer);
+  abcg::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+  abcg::glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                     sizeof(DrawElementsIndirectCommand), nullptr,
+                     GL_DYNAMIC_DRAW);
+  abcg::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif
+}
+
+/**
+ * @brief Deletes the program and buffers.
+ *
+ * Must be called with the OpenGL context current.
+ */
+void abcg::GPUCuller::terminate() {
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (m_program == 0 && m_indirectBuffer == 0) return;
+
+  abcg::glDeleteProgram(m_program);
+  abcg::glDeleteBuffers(1, &m_boundsBuffer);
+  abcg::glDeleteBuffers(1, &m_transformsBuffer);
+  abcg::glDeleteBuffers(1, &m_visibleTransformsBuffer);
+  abcg::glDeleteBuffers(1, &m_indirectBuffer);
+  m_program = 0;
+  m_boundsBuffer = 0;
+  m_transformsBuffer = 0;
+  m_visibleTransformsBuffer = 0;
+  m_indirectBuffer = 0;
+  m_instanceCount = 0;
+  m_capacity = 0;
+#endif
+}
+
+/**
+ * @brief Uploads the instances to be culled.
+ *
+ * @param bounds Bounding sphere of each instance, as (center, radius).
+ * @param transforms Model matrix of each instance.
+ */
+void abcg::GPUCuller::setInstances(
+    [[maybe_unused]] std::span<const glm::vec4> bounds,
+    [[maybe_unused]] std::span<const glm::mat4> transforms) {
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (m_program == 0) return;
+
+  m_instanceCount = std::min(bounds.size(), transforms.size());
+
+  if (m_instanceCount > m_capacity) {
+    // The output buffer keeps its name, so that vertex arrays that use it
+    // remain valid. It is only written by the compute shader
+    abcg::glBindBuffer(GL_ARRAY_BUFFER, m_visibleTransformsBuffer);
+    abcg::glBufferData(
+        GL_ARRAY_BUFFER,
+        static_cast<GLsizeiptr>(m_instanceCount * sizeof(glm::mat4)), nullptr,
+        GL_DYNAMIC_COPY);
+    m_capacity = m_instanceCount;
+  }
+
+  // Respecify the input buffers, so that the driver can allocate new storage
+  // instead of waiting for the previous dispatch
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_boundsBuffer);
+  abcg::glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(bounds.first(m_instanceCount)
+                                                 .size_bytes()),
+                     bounds.data(), GL_DYNAMIC_DRAW);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_transformsBuffer);
+  abcg::glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(transforms.first(m_instanceCount)
+                                                 .size_bytes()),
+                     transforms.data(), GL_DYNAMIC_DRAW);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+/**
+ * @brief Culls the instances and writes the indirect command.
+ *
+ * Changes the current program. The results can be used by the commands
+ * issued after this call.
+ *
+ * @param viewProjMatrix Matrix of the frustum (see abcg::Frustum::Frustum).
+ * @param indexCount Number of indices of the mesh drawn for each instance.
+ */
+void abcg::GPUCuller::cull([[maybe_unused]] const glm::mat4 &viewProjMatrix,
+                           [[maybe_unused]] GLuint indexCount) {
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (m_program == 0) return;
+
+  // Reset the instance count
+  DrawElementsIndirectCommand command;
+  command.count = indexCount;
+  abcg::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+  abcg::glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(command), &command);
+  abcg::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  if (m_instanceCount == 0) return;
+
+  const Frustum frustum{viewProjMatrix};
+  abcg::glUseProgram(m_program);
+  abcg::glUniform4fv(m_planesLocation,
+                     static_cast<GLsizei>(frustum.getPlanes().size()),
+                     &frustum.getPlanes().front()[0]);
+  abcg::glUniform1ui(m_instanceCountLocation,
+                     static_cast<GLuint>(m_instanceCount));
+
+  abcg::glBindBufferBase(GL_SHADER_STORAGE_BUFFER, boundsBinding,
+                         m_boundsBuffer);
+  abcg::glBindBufferBase(GL_SHADER_STORAGE_BUFFER, transformsBinding,
+                         m_transformsBuffer);
+  abcg::glBindBufferBase(GL_SHADER_STORAGE_BUFFER, visibleTransformsBinding,
+                         m_visibleTransformsBuffer);
+  abcg::glBindBufferBase(GL_SHADER_STORAGE_BUFFER, commandBinding,
+                         m_indirectBuffer);
+
+  const auto numGroups{
+      (static_cast<GLuint>(m_instanceCount) + workGroupSize - 1) /
+      workGroupSize};
+  abcg::glDispatchCompute(numGroups, 1, 1);
+
+  // Make the writes visible to the indirect draw and to the instance
+  // attribute fetches
+  abcg::glMemoryBarrier(GL_COMMAND_BARRIER_BIT |
+                        GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+  abcg::glUseProgram(0);
+#endif
+}
@@ -0,0 +1,104 @@
+/**
+ * @file abcg_gpuculler.hpp
+ * @brief abcg::GPUCuller header file.
+ *
+ * Declaration of abcg::GPUCuller class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_GPUCULLER_HPP_
+#define ABCG_GPUCULLER_HPP_
+
+#include <cstddef>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class GPUCuller;
+}  // namespace abcg
+
+/**
+ * @brief abcg::GPUCuller class.
+ *
+ * Culls instances against the view frustum with a compute shader, so that
+ * the instance data never goes back to the CPU. Each instance has a
+ * bounding sphere and a model matrix. The shader appends the model matrices
+ * of the visible instances to abcg::GPUCuller::getVisibleTransformsBuffer
+ * and counts them in a DrawElementsIndirectCommand stored in
+ * abcg::GPUCuller::getIndirectBuffer. The instances are then drawn with a
+ * single glMultiDrawElementsIndirect, without reading the count back.
+ *
+ * Requires OpenGL 4.3. Use abcg::GPUCuller::isSupported to fall back to
+ * abcg::Frustum::cull on OpenGL 4.1, OpenGL ES and WebGL.
+ */
+class abcg::GPUCuller {
+ public:
+  /**
+   * @brief Layout of the commands read by glMultiDrawElementsIndirect.
+   */
+  struct DrawElementsIndirectCommand {
+    GLuint count{};
+    GLuint instanceCount{};
+    GLuint firstIndex{};
+    GLint baseVertex{};
+    GLuint baseInstance{};
+  };
+
+  GPUCuller() = default;
+  ~GPUCuller();
+
+  GPUCuller(const GPUCuller&) = delete;
+  GPUCuller(GPUCuller&&) = delete;
+  GPUCuller& operator=(const GPUCuller&) = delete;
+  GPUCuller& operator=(GPUCuller&&) = delete;
+
+  [[nodiscard]] static bool isSupported();
+
+  void initialize();
+  void terminate();
+
+  void setInstances(std::span<const glm::vec4> bounds,
+                    std::span<const glm::mat4> transforms);
+  void cull(const glm::mat4& viewProjMatrix, GLuint indexCount);
+
+  /**
+   * @brief Returns the buffer of model matrices of the visible instances,
+   * to be bound as a per-instance vertex attribute. Valid after
+   * abcg::GPUCuller::initialize.
+   */
+  [[nodiscard]] GLuint getVisibleTransformsBuffer() const noexcept {
+    return m_visibleTransformsBuffer;
+  }
+
+  /**
+   * @brief Returns the buffer holding the DrawElementsIndirectCommand
+   * written by abcg::GPUCuller::cull, to be bound to GL_DRAW_INDIRECT_BUFFER.
+   */
+  [[nodiscard]] GLuint getIndirectBuffer() const noexcept {
+    return m_indirectBuffer;
+  }
+
+  [[nodiscard]] std::size_t getInstanceCount() const noexcept {
+    return m_instanceCount;
+  }
+
+ private:
+  GLuint m_program{};
+  GLint m_planesLocation{-1};
+  GLint m_instanceCountLocation{-1};
+
+  GLuint m_boundsBuffer{};
+  GLuint m_transformsBuffer{};
+  GLuint m_visibleTransformsBuffer{};
+  GLuint m_indirectBuffer{};
+
+  std::size_t m_instanceCount{};
+  // Number of instances that the buffers can hold
+  std::size_t m_capacity{};
+};
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file abcg_gputimer.cpp
+ * @brief Definition of abcg::GPUTimer class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_gputimer.hpp"
+
+#include <string_view>
+#include <utility>
+
+#include "abcg_openglfunctions.hpp"
+
+/**
+ * @brief Destroys the query objects.
+ *
+ * Must be called with the OpenGL context current.
+ */
+abcg::GPUTimer::~GPUTimer() {
+#if !defined(__EMSCRIPTEN__)
+  if (m_queries.front() != 0) {
+    abcg::glDeleteQueries(static_cast<GLsizei>(m_queries.size()),
+                          m_queries.data());
+  }
+#endif
+}
+
+/**
+ * @brief Returns true if the current OpenGL context supports timer queries.
+ */
+bool abcg::GPUTimer::isSupported() {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  const auto *version{
+      reinterpret_cast<const char *>(abcg::glGetString(GL_VERSION))};
+  return version != nullptr &&
+         !std::string_view{version}.starts_with("OpenGL ES");
+#endif
+}
+
+/**
+ * @brief Starts measuring the GPU time of the commands that follow.
+ */
+void abcg::GPUTimer::begin() {
+#if !defined(__EMSCRIPTEN__)
+  if (m_queries.front() == 0) {
+    abcg::glGenQueries(static_cast<GLsizei>(m_queries.size()),
+                       m_queries.data());
+  }
+
+  // All queries are in flight: wait for the oldest one
+  if (m_numPending == m_queries.size()) collect(true);
+
+  const auto index{(m_firstPending + m_numPending) % m_queries.size()};
+  abcg::glBeginQuery(GL_TIME_ELAPSED, m_queries.at(index));
+  m_active = true;
+#endif
+}
+
+/**
+ * @brief Stops measuring and collects the results that became available.
+ */
+void abcg::GPUTimer::end() {
+#if !defined(__EMSCRIPTEN__)
+  if (!m_active) return;
+  abcg::glEndQuery(GL_TIME_ELAPSED);
+  m_active = false;
+  ++m_numPending;
+  collect(false);
+#endif
+}
+
+/**
+ * @brief Returns the elapsed times, in seconds, of the intervals whose
+ * results are available and have not been returned yet.
+ */
+std::vector<double> abcg::GPUTimer::takeResults() {
+  std::vector<double> results;
+  const std::scoped_lock lock{m_resultsMutex};
+  results.swap(m_results);
+  return results;
+}
+
+/**
+ * @brief Returns the elapsed time, in seconds, of the most recent interval
+ * whose result is available, if it has not been returned yet.
+ *
+ * Does not remove the result from those returned by
+ * abcg::GPUTimer::takeResults.
+ */
+std::optional<double> abcg::GPUTimer::takeLatestResult() {
+  return std::exchange(m_latestResult, std::nullopt);
+}
+
+void abcg::GPUTimer::collect([[maybe_unused]] bool wait) {
+#if !defined(__EMSCRIPTEN__)
+  while (m_numPending > 0) {
+    const auto query{m_queries.at(m_firstPending)};
+    if (!wait) {
+      GLuint available{};
+      abcg::glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+      if (available == GL_FALSE) break;
+    }
+    wait = false;
+
+    GLuint64 elapsed{};
+    abcg::glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    m_latestResult = static_cast<double>(elapsed) * 1e-9;
+    {
+      const std::scoped_lock lock{m_resultsMutex};
+      if (m_results.size() == maxResults) m_results.erase(m_results.begin());
+      m_results.push_back(*m_latestResult);
+    }
+
+    m_firstPending = (m_firstPending + 1) % m_queries.size();
+    --m_numPending;
+  }
+#endif
+}
@@ -0,0 +1,79 @@
+/**
+ * @file abcg_gputimer.hpp
+ * @brief abcg::GPUTimer header file.
+ *
+ * Declaration of abcg::GPUTimer class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_GPUTIMER_HPP_
+#define ABCG_GPUTIMER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class GPUTimer;
+}  // namespace abcg
+
+/**
+ * @brief abcg::GPUTimer class.
+ *
+ * Measures the GPU time of the commands issued between
+ * abcg::GPUTimer::begin and abcg::GPUTimer::end with GL_TIME_ELAPSED queries.
+ *
+ * Results are read a few frames later, when they are available, so that
+ * the CPU does not wait for the GPU. Intervals cannot be nested.
+ *
+ * abcg::GPUTimer::takeResults can be called from any thread. The other
+ * functions must be called from the thread that owns the OpenGL context.
+ * Results that are not taken are dropped after
+ * abcg::GPUTimer::maxResults intervals.
+ *
+ * Timer queries are not available in OpenGL ES and WebGL, in which case no
+ * results are produced. They are available in the OpenGL 4.1 core profile
+ * used on macOS.
+ */
+class abcg::GPUTimer {
+ public:
+  GPUTimer() = default;
+  ~GPUTimer();
+
+  GPUTimer(const GPUTimer&) = delete;
+  GPUTimer(GPUTimer&&) = delete;
+  GPUTimer& operator=(const GPUTimer&) = delete;
+  GPUTimer& operator=(GPUTimer&&) = delete;
+
+  [[nodiscard]] static bool isSupported();
+
+  void begin();
+  void end();
+  [[nodiscard]] std::vector<double> takeResults();
+  [[nodiscard]] std::optional<double> takeLatestResult();
+
+  static constexpr std::size_t maxResults{1024};
+
+ private:
+  static constexpr std::size_t maxPendingQueries{8};
+
+  void collect(bool wait);
+
+  std::array<GLuint, maxPendingQueries> m_queries{};
+  // Ring of queries waiting for their results
+  std::size_t m_firstPending{};
+  std::size_t m_numPending{};
+  bool m_active{};
+  // Elapsed times in seconds, oldest first
+  std::mutex m_resultsMutex;
+  std::vector<double> m_results;
+  // Result of the last collected interval, if not taken yet
+  std::optional<double> m_latestResult;
+};
+
+#endif
@@ -0,0 +1,497 @@
+/**
+ * @file abcg_hizbuffer.cpp
+ * @brief Definition of abcg::HiZBuffer class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_hizbuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "abcg_exception.hpp"
+#include "abcg_openglfunctions.hpp"
+#include "abcg_profiler.hpp"
+
+namespace {
+// Coarsest levels read back: the first level whose largest side is at most
+// this size, and all levels after it
+constexpr int maxReadSize{128};
+// Largest total size of the read back levels, in floats, as each of their
+// sides is at most half the side of the previous level
+constexpr std::size_t maxReadTexels{[] {
+  std::size_t texels{};
+  for (auto size{maxReadSize}; size > 0; size /= 2) {
+    texels += static_cast<std::size_t>(size * size);
+  }
+  return texels;
+}()};
+// Largest number of texels sampled by a test, on each axis
+constexpr int maxTestTexels{4};
+// Smallest change of a depth between two read backs that makes the objects
+// behind it visible
+constexpr float minDepthChange{1e-4f};
+
+// Fullscreen triangle
+constexpr std::string_view vertexShaderSource{R"glsl(#version 330 core
+
+void main() {
+  vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+})glsl"};
+
+// Each texel of a level keeps the farthest depth of the 2x2 texels of the
+// previous level. At odd sizes, the last row and column also cover the
+// extra texel. The size of the previous level is a uniform, as the level
+// may only fill a corner of the texture
+constexpr std::string_view fragmentShaderSource{R"glsl(#version 330 core
+
+uniform sampler2D source;
+uniform ivec2 sourceSize;
+
+out float outDepth;
+
+void main() {
+  ivec2 origin = ivec2(gl_FragCoord.xy) * 2;
+  ivec2 extent = ivec2(2) + ivec2(equal(origin + 3, sourceSize));
+
+  float depth = 0.0;
+  for (int y = 0; y < extent.y; ++y) {
+    for (int x = 0; x < extent.x; ++x) {
+      ivec2 texel = min(origin + ivec2(x, y), sourceSize - 1);
+      depth = max(depth, texelFetch(source, texel, 0).r);
+    }
+  }
+  outDepth = depth;
+})glsl"};
+
+#if !defined(__EMSCRIPTEN__)
+GLuint compileShader(GLenum type, std::string_view source) {
+  const auto shader{abcg::glCreateShader(type)};
+  const auto *sourceData{source.data()};
+  abcg::glShaderSource(shader, 1, &sourceData, nullptr);
+  abcg::glCompileShader(shader);
+  return shader;
+}
+#endif
+}  // namespace
+
+abcg::HiZBuffer::~HiZBuffer() { terminate(); }
+
+/**
+ * @brief Builds the depth pyramid of the frame and starts reading it back.
+ *
+ * Must be called after the occluders are rendered, e.g. at the end of
+ * paintGL, with their framebuffer bound (the default framebuffer, or the
+ * offscreen framebuffer of abcg::PostProcessChain). Resets the current
+ * program, vertex array and the texture bound to texture unit 0.
+ *
+ * @param width Width of the framebuffer.
+ * @param height Height of the framebuffer.
+ * @param viewProjMatrix Projection matrix times view matrix of the frame.
+ *
+ * @throw abcg::Exception if the reduction shader fails to build.
+ */
+void abcg::HiZBuffer::update([[maybe_unused]] int width,
+                             [[maybe_unused]] int height,
+                             [[maybe_unused]] const glm::mat4 &viewProjMatrix) {
+#if !defined(__EMSCRIPTEN__)
+  ABCG_PROFILE_SCOPE("HiZBuffer::update");
+  if (width <= 0 || height <= 0) return;
+
+  GLint framebuffer{};
+  abcg::glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+
+  if (m_program == 0) initialize();
+  if (width != m_layout.width || height != m_layout.height) {
+    m_layout = makeLayout(width, height);
+    if (width > m_textureWidth || height > m_textureHeight) {
+      resize(std::max(width, m_textureWidth),
+             std::max(height, m_textureHeight));
+    }
+  }
+
+  collect();
+
+  // Skip this frame instead of waiting when all buffers are in flight
+  if (auto &slot{m_slots.at(m_nextSlot)}; slot.fence == nullptr) {
+    build(static_cast<GLuint>(framebuffer));
+
+    slot.viewProjMatrix = viewProjMatrix;
+    slot.frame = m_frame;
+    slot.width = width;
+    slot.height = height;
+    read(slot);
+    m_nextSlot = (m_nextSlot + 1) % ringSize;
+  }
+
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(framebuffer));
+#endif
+}
+
+/**
+ * @brief Deletes the OpenGL objects.
+ *
+ * Must be called with the OpenGL context current.
+ */
+void abcg::HiZBuffer::terminate() {
+#if !defined(__EMSCRIPTEN__)
+  if (m_program == 0) return;
+
+  for (auto &slot : m_slots) {
+    if (slot.fence != nullptr) abcg::glDeleteSync(slot.fence);
+    abcg::glDeleteBuffers(1, &slot.buffer);
+    slot = {};
+  }
+  abcg::glDeleteTextures(1, &m_pyramidTexture);
+  abcg::glDeleteTextures(1, &m_depthTexture);
+  abcg::glDeleteFramebuffers(1, &m_pyramidFramebuffer);
+  abcg::glDeleteFramebuffers(1, &m_depthFramebuffer);
+  abcg::glDeleteVertexArrays(1, &m_VAO);
+  abcg::glDeleteProgram(m_program);
+  m_program = 0;
+  m_sourceSizeLocation = 0;
+  m_VAO = 0;
+  m_depthFramebuffer = 0;
+  m_pyramidFramebuffer = 0;
+  m_depthTexture = 0;
+  m_pyramidTexture = 0;
+  m_textureWidth = 0;
+  m_textureHeight = 0;
+  m_textureLevels = 0;
+  m_layout = {};
+  m_depthsLayout = {};
+  m_nextSlot = 0;
+  m_hasDepths = false;
+  m_hasPreviousDepths = false;
+#endif
+}
+
+/**
+ * @brief Returns true if a bounding box is hidden behind the depth of a
+ * recent frame.
+ *
+ * @param boxMin Minimum corner of the box, in model space.
+ * @param boxMax Maximum corner of the box, in model space.
+ * @param modelMatrix Current model matrix of the object.
+ */
+bool abcg::HiZBuffer::isOccluded(const glm::vec3 &boxMin,
+                                 const glm::vec3 &boxMax,
+                                 const glm::mat4 &modelMatrix) const {
+  // Depths older than the ring are not trusted. The frame is counted by
+  // beginFrame, so frames without updates also age the depths
+  if (!m_hasDepths || !m_hasPreviousDepths ||
+      m_frame - m_depthsFrame > ringSize + 2) {
+    return false;
+  }
+
+  // Bounds of the box in window coordinates, in [0, 1]
+  const auto matrix{m_viewProjMatrix * modelMatrix};
+  glm::vec3 windowMin{std::numeric_limits<float>::max()};
+  glm::vec3 windowMax{std::numeric_limits<float>::lowest()};
+  for (const auto corner : {0, 1, 2, 3, 4, 5, 6, 7}) {
+    const glm::vec4 position{(corner & 1) != 0 ? boxMax.x : boxMin.x,
+                             (corner & 2) != 0 ? boxMax.y : boxMin.y,
+                             (corner & 4) != 0 ? boxMax.z : boxMin.z, 1.0f};
+    const auto clipPosition{matrix * position};
+    if (clipPosition.w <= 0.0f) return false;
+    const auto windowPosition{glm::vec3{clipPosition} / clipPosition.w * 0.5f +
+                              0.5f};
+    windowMin = glm::min(windowMin, windowPosition);
+    windowMax = glm::max(windowMax, windowPosition);
+  }
+
+  // Boxes outside the view are left to frustum culling
+  if (windowMax.x < 0.0f || windowMax.y < 0.0f || windowMin.x > 1.0f ||
+      windowMin.y > 1.0f || windowMin.z < 0.0f) {
+    return false;
+  }
+
+  // Use the finest read back level at which the box covers a few texels
+  const auto &levels{m_depthsLayout.levels};
+  for (auto levelIndex{m_depthsLayout.firstReadLevel};
+       levelIndex < levels.size(); ++levelIndex) {
+    const auto &level{levels.at(levelIndex)};
+
+    // Widen by one texel, as the truncation of odd sizes shifts the texels
+    // of coarse levels
+    const auto texel{[](float coordinate, int size, int offset) {
+      return std::clamp(
+          static_cast<int>(std::floor(coordinate * static_cast<float>(size))) +
+              offset,
+          0, size - 1);
+    }};
+    const auto x0{texel(windowMin.x, level.width, -1)};
+    const auto x1{texel(windowMax.x, level.width, 1)};
+    const auto y0{texel(windowMin.y, level.height, -1)};
+    const auto y1{texel(windowMax.y, level.height, 1)};
+
+    if (levelIndex + 1 < levels.size() &&
+        (x1 - x0 >= maxTestTexels || y1 - y0 >= maxTestTexels)) {
+      continue;
+    }
+
+    auto maxDepth{0.0f};
+    for (auto y{y0}; y <= y1; ++y) {
+      for (auto x{x0}; x <= x1; ++x) {
+        const auto index{level.offset +
+                         static_cast<std::size_t>(y * level.width + x)};
+        const auto depth{m_depths.at(index)};
+        // The region may have been revealed since the depths were read
+        if (std::abs(depth - m_previousDepths.at(index)) > minDepthChange) {
+          return false;
+        }
+        maxDepth = std::max(maxDepth, depth);
+      }
+    }
+    return windowMin.z > maxDepth;
+  }
+  return false;
+}
+
+void abcg::HiZBuffer::initialize() {
+#if !defined(__EMSCRIPTEN__)
+  const auto vertexShader{
+      compileShader(GL_VERTEX_SHADER, vertexShaderSource)};
+  const auto fragmentShader{
+      compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource)};
+  m_program = abcg::glCreateProgram();
+  abcg::glAttachShader(m_program, vertexShader);
+  abcg::glAttachShader(m_program, fragmentShader);
+  abcg::glLinkProgram(m_program);
+  abcg::glDeleteShader(vertexShader);
+  abcg::glDeleteShader(fragmentShader);
+
+  GLint linkStatus{};
+  abcg::glGetProgramiv(m_program, GL_LINK_STATUS, &linkStatus);
+  if (linkStatus == 0) {
+    GLint infoLogLength{};
+    abcg::glGetProgramiv(m_program, GL_INFO_LOG_LENGTH, &infoLogLength);
+    std::vector<GLchar> infoLog(static_cast<std::size_t>(infoLogLength) + 1);
+    abcg::glGetProgramInfoLog(m_program, infoLogLength, nullptr,
+                              infoLog.data());
+    abcg::glDeleteProgram(m_program);
+    m_program = 0;
+    throw abcg::Exception{abcg::Exception::Runtime(
+        "Failed to build depth reduction shader: " +
+        std::string{infoLog.data()})};
+  }
+
+  abcg::glUseProgram(m_program);
+  abcg::glUniform1i(abcg::glGetUniformLocation(m_program, "source"), 0);
+  m_sourceSizeLocation = abcg::glGetUniformLocation(m_program, "sourceSize");
+  abcg::glUseProgram(0);
+
+  abcg::glGenVertexArrays(1, &m_VAO);
+  abcg::glGenFramebuffers(1, &m_depthFramebuffer);
+  abcg::glGenFramebuffers(1, &m_pyramidFramebuffer);
+
+  // Sized for any framebuffer, so that resizes do not discard the reads in
+  // flight
+  for (auto &slot : m_slots) {
+    abcg::glGenBuffers(1, &slot.buffer);
+    abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    abcg::glBufferData(GL_PIXEL_PACK_BUFFER,
+                       static_cast<GLsizeiptr>(maxReadTexels * sizeof(float)),
+                       nullptr, GL_STREAM_READ);
+  }
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+}
+
+// Levels are half the size of the previous one, rounded down
+abcg::HiZBuffer::Layout abcg::HiZBuffer::makeLayout(int width, int height) {
+  Layout layout{.width = width, .height = height};
+  auto levelWidth{width};
+  auto levelHeight{height};
+  do {
+    levelWidth = std::max(levelWidth / 2, 1);
+    levelHeight = std::max(levelHeight / 2, 1);
+    if (std::max(levelWidth, levelHeight) > maxReadSize) {
+      layout.firstReadLevel = layout.levels.size() + 1;
+    }
+    layout.levels.push_back({.width = levelWidth, .height = levelHeight});
+  } while (levelWidth > 1 || levelHeight > 1);
+
+  for (auto index{layout.firstReadLevel}; index < layout.levels.size();
+       ++index) {
+    auto &level{layout.levels.at(index)};
+    level.offset = layout.readSize;
+    layout.readSize += static_cast<std::size_t>(level.width * level.height);
+  }
+  return layout;
+}
+
+// Reallocates the textures for a larger framebuffer. The depths read back
+// do not refer to the textures, so they are kept
+void abcg::HiZBuffer::resize([[maybe_unused]] int width,
+                             [[maybe_unused]] int height) {
+#if !defined(__EMSCRIPTEN__)
+  const auto layout{makeLayout(width, height)};
+  m_textureWidth = width;
+  m_textureHeight = height;
+  m_textureLevels = static_cast<GLsizei>(layout.levels.size());
+
+  // Copy of the depth buffer, in the format of the default framebuffer
+  abcg::glDeleteTextures(1, &m_depthTexture);
+  abcg::glGenTextures(1, &m_depthTexture);
+  abcg::glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+  abcg::glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  abcg::glDeleteTextures(1, &m_pyramidTexture);
+  abcg::glGenTextures(1, &m_pyramidTexture);
+  abcg::glBindTexture(GL_TEXTURE_2D, m_pyramidTexture);
+  abcg::glTexStorage2D(GL_TEXTURE_2D, m_textureLevels, GL_R32F,
+                       layout.levels.front().width,
+                       layout.levels.front().height);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  abcg::glBindTexture(GL_TEXTURE_2D, 0);
+
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, m_depthFramebuffer);
+  abcg::glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                               GL_TEXTURE_2D, m_depthTexture, 0);
+  const GLenum none{GL_NONE};
+  abcg::glDrawBuffers(1, &none);
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, 0);
+#endif
+}
+
+void abcg::HiZBuffer::build([[maybe_unused]] GLuint sourceFramebuffer) {
+#if !defined(__EMSCRIPTEN__)
+  ABCG_PROFILE_GPU_SCOPE("HiZBuffer::build");
+
+  abcg::glBindFramebuffer(GL_READ_FRAMEBUFFER, sourceFramebuffer);
+  abcg::glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_depthFramebuffer);
+  const auto width{m_layout.width};
+  const auto height{m_layout.height};
+  abcg::glBlitFramebuffer(0, 0, width, height, 0, 0, width, height,
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+  std::array<GLint, 4> viewport{};
+  abcg::glGetIntegerv(GL_VIEWPORT, viewport.data());
+  const auto depthTest{abcg::glIsEnabled(GL_DEPTH_TEST)};
+  const auto cullFace{abcg::glIsEnabled(GL_CULL_FACE)};
+  const auto blend{abcg::glIsEnabled(GL_BLEND)};
+  const auto scissorTest{abcg::glIsEnabled(GL_SCISSOR_TEST)};
+  abcg::glDisable(GL_DEPTH_TEST);
+  abcg::glDisable(GL_CULL_FACE);
+  abcg::glDisable(GL_BLEND);
+  abcg::glDisable(GL_SCISSOR_TEST);
+
+  abcg::glUseProgram(m_program);
+  abcg::glBindVertexArray(m_VAO);
+  abcg::glActiveTexture(GL_TEXTURE0);
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, m_pyramidFramebuffer);
+
+  const auto &levels{m_layout.levels};
+  for (std::size_t index{}; index < levels.size(); ++index) {
+    const auto &level{levels.at(index)};
+
+    // Read only the previous level, so that the level written is not also
+    // sampled
+    if (index == 0) {
+      abcg::glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+      abcg::glUniform2i(m_sourceSizeLocation, width, height);
+    } else {
+      abcg::glBindTexture(GL_TEXTURE_2D, m_pyramidTexture);
+      abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL,
+                            static_cast<GLint>(index - 1));
+      abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                            static_cast<GLint>(index - 1));
+      abcg::glUniform2i(m_sourceSizeLocation, levels.at(index - 1).width,
+                        levels.at(index - 1).height);
+    }
+
+    abcg::glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                 GL_TEXTURE_2D, m_pyramidTexture,
+                                 static_cast<GLint>(index));
+    abcg::glViewport(0, 0, level.width, level.height);
+    abcg::glDrawArrays(GL_TRIANGLES, 0, 3);
+  }
+
+  abcg::glBindTexture(GL_TEXTURE_2D, m_pyramidTexture);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                        m_textureLevels - 1);
+  abcg::glBindTexture(GL_TEXTURE_2D, 0);
+  abcg::glBindVertexArray(0);
+  abcg::glUseProgram(0);
+
+  abcg::glViewport(viewport.at(0), viewport.at(1), viewport.at(2),
+                   viewport.at(3));
+  if (depthTest == GL_TRUE) abcg::glEnable(GL_DEPTH_TEST);
+  if (cullFace == GL_TRUE) abcg::glEnable(GL_CULL_FACE);
+  if (blend == GL_TRUE) abcg::glEnable(GL_BLEND);
+  if (scissorTest == GL_TRUE) abcg::glEnable(GL_SCISSOR_TEST);
+#endif
+}
+
+void abcg::HiZBuffer::read([[maybe_unused]] Slot &slot) {
+#if !defined(__EMSCRIPTEN__)
+  abcg::glBindFramebuffer(GL_READ_FRAMEBUFFER, m_pyramidFramebuffer);
+  abcg::glReadBuffer(GL_COLOR_ATTACHMENT0);
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  const auto &levels{m_layout.levels};
+  for (auto index{m_layout.firstReadLevel}; index < levels.size(); ++index) {
+    const auto &level{levels.at(index)};
+    abcg::glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                 GL_TEXTURE_2D, m_pyramidTexture,
+                                 static_cast<GLint>(index));
+    abcg::glReadPixels(
+        0, 0, level.width, level.height, GL_RED, GL_FLOAT,
+        reinterpret_cast<void *>(level.offset * sizeof(float)));
+  }
+  slot.fence = abcg::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, 0);
+#endif
+}
+
+// Copies the most recent depths whose fence is signaled, without waiting
+void abcg::HiZBuffer::collect() {
+#if !defined(__EMSCRIPTEN__)
+  Slot *newest{};
+  for (auto &slot : m_slots) {
+    if (slot.fence == nullptr) continue;
+    if (abcg::glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+      continue;
+    }
+    abcg::glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (newest == nullptr || slot.frame > newest->frame) newest = &slot;
+  }
+  if (newest == nullptr) return;
+
+  // The size may have changed since the previous depths were read
+  if (newest->width != m_depthsLayout.width ||
+      newest->height != m_depthsLayout.height) {
+    m_depthsLayout = makeLayout(newest->width, newest->height);
+    m_hasDepths = false;
+  }
+  const auto readSize{m_depthsLayout.readSize};
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, newest->buffer);
+  if (const auto *data{abcg::glMapBufferRange(
+          GL_PIXEL_PACK_BUFFER, 0,
+          static_cast<GLsizeiptr>(readSize * sizeof(float)),
+          GL_MAP_READ_BIT)};
+      data != nullptr) {
+    m_previousDepths.swap(m_depths);
+    m_hasPreviousDepths = m_hasDepths;
+    m_depths.resize(readSize);
+    std::memcpy(m_depths.data(), data, readSize * sizeof(float));
+    abcg::glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    m_viewProjMatrix = newest->viewProjMatrix;
+    m_depthsFrame = newest->frame;
+    m_hasDepths = true;
+  }
+  abcg::glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+}
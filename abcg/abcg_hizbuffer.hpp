@@ -0,0 +1,153 @@
+/**
+ * @file abcg_hizbuffer.hpp
+ * @brief abcg::HiZBuffer header file.
+ *
+ * Declaration of abcg::HiZBuffer class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_HIZBUFFER_HPP_
+#define ABCG_HIZBUFFER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class HiZBuffer;
+}  // namespace abcg
+
+/**
+ * @brief abcg::HiZBuffer class.
+ *
+ * Hierarchical depth buffer used to skip objects hidden behind the objects
+ * rendered in a previous frame.
+ *
+ * abcg::HiZBuffer::update copies the depth buffer of the frame and reduces
+ * it to a pyramid of mipmaps, in which each texel holds the farthest depth
+ * of the texels it covers. The coarse levels are read back asynchronously
+ * through a ring of abcg::HiZBuffer::ringSize pixel pack buffers, so
+ * abcg::HiZBuffer::isOccluded tests bounding boxes against the depth of a
+ * frame that is one to three frames old, projected with the view and
+ * projection matrices of that frame.
+ *
+ * Frames are counted by abcg::HiZBuffer::beginFrame, which must be called
+ * every frame, including the frames in which abcg::HiZBuffer::update is not
+ * called (e.g. while occlusion culling is disabled), so that the age of the
+ * depths is known.
+ *
+ * The textures are reallocated only when the framebuffer grows beyond
+ * their size, so changes of the render scale (see
+ * abcg::OpenGLWindow::getRenderWidth) reduce a corner of them instead.
+ *
+ * Tests are conservative: objects are visible when no recent depth is
+ * available (e.g. on the first frames, or after frames without updates)
+ * and when their box crosses the near plane. As the depths are a few frames
+ * old, objects are also visible when the depth under their box changed
+ * between the two most recent read backs, e.g. behind a moving occluder or
+ * while the camera moves, so that objects revealed since then do not pop
+ * in late.
+ *
+ * Not available with Emscripten, as WebGL cannot read back depth.
+ */
+class abcg::HiZBuffer {
+ public:
+  static constexpr std::size_t ringSize{3};
+
+  HiZBuffer() = default;
+  ~HiZBuffer();
+
+  HiZBuffer(const HiZBuffer&) = delete;
+  HiZBuffer(HiZBuffer&&) = delete;
+  HiZBuffer& operator=(const HiZBuffer&) = delete;
+  HiZBuffer& operator=(HiZBuffer&&) = delete;
+
+  /**
+   * @brief Sets the index of the current frame, e.g. abcg::FramePacket::frame.
+   *
+   * Must be called every frame, before abcg::HiZBuffer::isOccluded and
+   * abcg::HiZBuffer::update.
+   */
+  void beginFrame(std::uint64_t frame) noexcept { m_frame = frame; }
+  void update(int width, int height, const glm::mat4& viewProjMatrix);
+  void terminate();
+
+  [[nodiscard]] bool isOccluded(const glm::vec3& boxMin,
+                                const glm::vec3& boxMax,
+                                const glm::mat4& modelMatrix) const;
+
+ private:
+  struct Level {
+    int width{};
+    int height{};
+    // Offset of the level in the read back depths, in floats
+    std::size_t offset{};
+  };
+
+  // Levels of the pyramid of a framebuffer size
+  struct Layout {
+    int width{};
+    int height{};
+    std::vector<Level> levels{};
+    // Index of the first level read back, and total size of the read back
+    // levels, in floats
+    std::size_t firstReadLevel{};
+    std::size_t readSize{};
+  };
+
+  struct Slot {
+    GLuint buffer{};
+    GLsync fence{};
+    glm::mat4 viewProjMatrix{1.0f};
+    std::uint64_t frame{};
+    // Framebuffer size of the depths read into the buffer
+    int width{};
+    int height{};
+  };
+
+  [[nodiscard]] static Layout makeLayout(int width, int height);
+
+  void initialize();
+  void resize(int width, int height);
+  void build(GLuint sourceFramebuffer);
+  void read(Slot& slot);
+  void collect();
+
+  GLuint m_program{};
+  GLint m_sourceSizeLocation{};
+  GLuint m_VAO{};
+  GLuint m_depthFramebuffer{};
+  GLuint m_pyramidFramebuffer{};
+  GLuint m_depthTexture{};
+  GLuint m_pyramidTexture{};
+
+  // Size of the textures, which only grow, so that a smaller framebuffer
+  // (e.g. a lower render scale) uses their bottom-left corner
+  int m_textureWidth{};
+  int m_textureHeight{};
+  GLsizei m_textureLevels{};
+  // Levels of the current framebuffer
+  Layout m_layout;
+
+  std::array<Slot, ringSize> m_slots{};
+  std::size_t m_nextSlot{};
+  std::uint64_t m_frame{};
+
+  // Most recent depths read back, their levels, and the matrix and frame
+  // they belong to. The depths read back before them have the same levels
+  std::vector<float> m_depths;
+  std::vector<float> m_previousDepths;
+  bool m_hasPreviousDepths{};
+  Layout m_depthsLayout;
+  glm::mat4 m_viewProjMatrix{1.0f};
+  std::uint64_t m_depthsFrame{};
+  bool m_hasDepths{};
+};
+
+#endif
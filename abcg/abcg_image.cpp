@@ -9,6 +9,8 @@
 
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <bit>
 #include <cppitertools/itertools.hpp>
 #include <fstream>
 #include <gsl/gsl>
@@ -18,6 +20,13 @@
 #include "SDL_image.h"
 #include "abcg_exception.hpp"
 #include "abcg_external.hpp"
+#include "abcg_openglfunctions.hpp"
+
+// Number of levels of a full mipmap chain
+GLsizei mipLevelCount(GLsizei width, GLsizei height) {
+  return static_cast<GLsizei>(
+      std::bit_width(static_cast<unsigned>(std::max(width, height))));
+}
 
 void flipHorizontally(gsl::not_null<SDL_Surface*> surface) {
   auto width{static_cast<size_t>(surface->w * surface->format->BytesPerPixel)};
@@ -93,37 +102,72 @@ GLuint abcg::opengl::loadTexture(std::string_view path, bool generateMipmaps) {
     // Flip upside down
     flipVertically(formattedSurface);
 
+    auto width{formattedSurface->w};
+    auto height{formattedSurface->h};
+
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+    if (abcg::isDirectStateAccessSupported()) {
+      // Allocate immutable storage for all mip levels and edit the texture
+      // without binding it
+      auto levels{generateMipmaps ? mipLevelCount(width, height) : 1};
+      const auto internalFormat{
+          static_cast<GLenum>(format == GL_RGB ? GL_RGB8 : GL_RGBA8)};
+      abcg::glCreateTextures(GL_TEXTURE_2D, 1, &textureID);
+      abcg::glTextureStorage2D(textureID, levels, internalFormat, width,
+                               height);
+      abcg::glTextureSubImage2D(textureID, 0, 0, 0, width, height, format,
+                                GL_UNSIGNED_BYTE, formattedSurface->pixels);
+
+      SDL_FreeSurface(formattedSurface);
+
+      // Set texture filtering
+      abcg::glTextureParameteri(textureID, GL_TEXTURE_MIN_FILTER,
+                                generateMipmaps ? GL_LINEAR_MIPMAP_LINEAR
+                                                : GL_LINEAR);
+      abcg::glTextureParameteri(textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+      // Generate the mipmap levels
+      if (generateMipmaps) abcg::glGenerateTextureMipmap(textureID);
+
+      // Set texture wrapping
+      abcg::glTextureParameteri(textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+      abcg::glTextureParameteri(textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+      return textureID;
+    }
+#endif
+
     // Generate the texture
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format),
-                 formattedSurface->w, formattedSurface->h, 0, format,
-                 GL_UNSIGNED_BYTE, formattedSurface->pixels);
+    abcg::glGenTextures(1, &textureID);
+    abcg::glBindTexture(GL_TEXTURE_2D, textureID);
+    abcg::glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format), width,
+                       height, 0, format, GL_UNSIGNED_BYTE,
+                       formattedSurface->pixels);
 
     SDL_FreeSurface(formattedSurface);
 
     // Set texture filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     // Generate the mipmap levels
     if (generateMipmaps) {
-      glGenerateMipmap(GL_TEXTURE_2D);
+      abcg::glGenerateMipmap(GL_TEXTURE_2D);
 
       // Override minifying filtering
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                      GL_LINEAR_MIPMAP_LINEAR);
+      abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                            GL_LINEAR_MIPMAP_LINEAR);
     }
 
     // Set texture wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
   } else {
     throw abcg::Exception{abcg::Exception::Runtime(
         fmt::format("Failed to load texture file {}", path))};
   }
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  abcg::glBindTexture(GL_TEXTURE_2D, 0);
 
   return textureID;
 }
@@ -131,8 +175,14 @@ GLuint abcg::opengl::loadTexture(std::string_view path, bool generateMipmaps) {
 GLuint abcg::opengl::loadCubemap(std::array<std::string_view, 6> paths,
                                  bool generateMipmaps, bool rightHandedSystem) {
   GLuint textureID{};
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+  const auto useDSA{abcg::isDirectStateAccessSupported()};
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (useDSA) abcg::glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &textureID);
+#endif
+  if (!useDSA) {
+    abcg::glGenTextures(1, &textureID);
+    abcg::glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+  }
 
   for (auto&& [index, path] : iter::enumerate(paths)) {
     // Copy file data into buffer
@@ -171,8 +221,28 @@ GLuint abcg::opengl::loadCubemap(std::array<std::string_view, 6> paths,
       }
 
       // Create texture
-      glTexImage2D(target, 0, GL_RGB, formattedSurface->w, formattedSurface->h,
-                   0, GL_RGB, GL_UNSIGNED_BYTE, formattedSurface->pixels);
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+      if (useDSA) {
+        // Storage is allocated with the size of the first face. Faces are
+        // layers of the cube map, in the order of the face targets
+        if (index == 0) {
+          auto levels{generateMipmaps ? mipLevelCount(formattedSurface->w,
+                                                       formattedSurface->h)
+                                      : 1};
+          abcg::glTextureStorage2D(textureID, levels, GL_RGB8,
+                                   formattedSurface->w, formattedSurface->h);
+        }
+        auto face{static_cast<GLint>(target - GL_TEXTURE_CUBE_MAP_POSITIVE_X)};
+        abcg::glTextureSubImage3D(textureID, 0, 0, 0, face, formattedSurface->w,
+                                  formattedSurface->h, 1, GL_RGB,
+                                  GL_UNSIGNED_BYTE, formattedSurface->pixels);
+      }
+#endif
+      if (!useDSA) {
+        abcg::glTexImage2D(target, 0, GL_RGB, formattedSurface->w,
+                           formattedSurface->h, 0, GL_RGB, GL_UNSIGNED_BYTE,
+                           formattedSurface->pixels);
+      }
 
       SDL_FreeSurface(formattedSurface);
     } else {
@@ -181,23 +251,48 @@ GLuint abcg::opengl::loadCubemap(std::array<std::string_view, 6> paths,
     }
   }
 
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (useDSA) {
+    // Set texture wrapping
+    abcg::glTextureParameteri(textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    abcg::glTextureParameteri(textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    abcg::glTextureParameteri(textureID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    // Set texture filtering
+    abcg::glTextureParameteri(textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    abcg::glTextureParameteri(textureID, GL_TEXTURE_MIN_FILTER,
+                              generateMipmaps ? GL_LINEAR_MIPMAP_LINEAR
+                                              : GL_LINEAR);
+
+    // Generate the mipmap levels
+    if (generateMipmaps) abcg::glGenerateTextureMipmap(textureID);
+
+    return textureID;
+  }
+#endif
+
   // Set texture wrapping
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+  abcg::glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S,
+                        GL_CLAMP_TO_EDGE);
+  abcg::glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T,
+                        GL_CLAMP_TO_EDGE);
+  abcg::glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R,
+                        GL_CLAMP_TO_EDGE);
 
   // Set texture filtering
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  abcg::glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  abcg::glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
   // Generate the mipmap levels
   if (generateMipmaps) {
-    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    abcg::glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
     // Override minifying filtering
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER,
-                    GL_LINEAR_MIPMAP_LINEAR);
+    abcg::glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER,
+                          GL_LINEAR_MIPMAP_LINEAR);
   }
 
+  abcg::glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
   return textureID;
 }
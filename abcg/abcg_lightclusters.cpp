@@ -0,0 +1,493 @@
+/**
+ * @file abcg_lightclusters.cpp
+ * @brief Definition of abcg::LightClusters class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_lightclusters.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <limits>
+
+#include "abcg_openglfunctions.hpp"
+#include "abcg_workerpool.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// Width of the textures used as arrays
+constexpr GLsizei textureWidth{1024};
+constexpr std::size_t numClusters{abcg::LightClusters::tilesX *
+                                  abcg::LightClusters::tilesY *
+                                  abcg::LightClusters::slices};
+
+// Lights are binned on the calling thread below this count
+constexpr std::size_t minParallelCount{256};
+
+// Rows of clusters start at multiples of 8, so that they are tested in whole
+// SIMD blocks
+static_assert(abcg::LightClusters::tilesX % 8 == 0);
+
+// Calls function(index, first, last) on ranges of [0, count), one range per
+// thread of the shared worker pool
+template <typename Function>
+void forEachRange(int count, std::size_t numThreads, const Function &function) {
+  if (numThreads <= 1) {
+    function(0, 0, count);
+    return;
+  }
+
+  const auto rangeSize{(count + static_cast<int>(numThreads) - 1) /
+                       static_cast<int>(numThreads)};
+  abcg::WorkerPool::shared().parallelFor(
+      numThreads, [&](std::size_t index) {
+        const auto first{std::min(static_cast<int>(index) * rangeSize, count)};
+        function(index, first, std::min(first + rangeSize, count));
+      });
+}
+
+GLuint createTexture(GLint internalFormat, GLsizei width, GLsizei height,
+                     GLenum format, GLenum type) {
+  GLuint texture{};
+  abcg::glGenTextures(1, &texture);
+  abcg::glBindTexture(GL_TEXTURE_2D, texture);
+  abcg::glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0,
+                     format, type, nullptr);
+  // Read with texelFetch only. Integer textures must not be filtered
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+  abcg::glBindTexture(GL_TEXTURE_2D, 0);
+  return texture;
+}
+}  // namespace
+
+abcg::LightClusters::~LightClusters() { terminate(); }
+
+/**
+ * @brief Creates the textures.
+ *
+ * Must be called with the OpenGL context current.
+ */
+void abcg::LightClusters::initialize() {
+  terminate();
+
+  m_lightsTexture = createTexture(
+      GL_RGBA32F, textureWidth,
+      static_cast<GLsizei>(2 * maxLights / textureWidth), GL_RGBA, GL_FLOAT);
+  m_clustersTexture = createTexture(GL_RG32UI, tilesX * tilesY, slices,
+                                    GL_RG_INTEGER, GL_UNSIGNED_INT);
+  m_lightIndicesRows = 1;
+  m_lightIndicesTexture =
+      createTexture(GL_R32UI, textureWidth, m_lightIndicesRows,
+                    GL_RED_INTEGER, GL_UNSIGNED_INT);
+}
+
+/**
+ * @brief Deletes the textures.
+ *
+ * Must be called with the OpenGL context current.
+ */
+void abcg::LightClusters::terminate() {
+  if (m_lightsTexture == 0) return;
+
+  abcg::glDeleteTextures(1, &m_lightsTexture);
+  abcg::glDeleteTextures(1, &m_clustersTexture);
+  abcg::glDeleteTextures(1, &m_lightIndicesTexture);
+  m_lightsTexture = 0;
+  m_clustersTexture = 0;
+  m_lightIndicesTexture = 0;
+  m_lightIndicesRows = 0;
+}
+
+/**
+ * @brief Bins the lights into the clusters of the view frustum and uploads
+ * the results.
+ *
+ * @param lights Lights of the scene. Only the first
+ * abcg::LightClusters::maxLights lights are used.
+ * @param viewMatrix View matrix.
+ * @param projMatrix Projection matrix.
+ * @param nearPlane Distance to the near plane of the projection.
+ * @param farPlane Distance to the far plane of the projection.
+ */
+void abcg::LightClusters::update(std::span<const PointLight> lights,
+                                 const glm::mat4 &viewMatrix,
+                                 const glm::mat4 &projMatrix, float nearPlane,
+                                 float farPlane) {
+  m_nearPlane = nearPlane;
+  m_farPlane = farPlane;
+  if (projMatrix != m_boundsProjMatrix || nearPlane != m_boundsNearPlane ||
+      farPlane != m_boundsFarPlane) {
+    computeClusterBounds(projMatrix);
+  }
+
+  // Skip the lights outside of the view frustum. The spheres are tested
+  // eight at a time when ABCg is built with AVX
+  const auto count{std::min(lights.size(), maxLights)};
+  m_spheres.resize(count);
+  for (std::size_t index{}; index < count; ++index) {
+    m_spheres.set(index, lights[index].position, lights[index].radius);
+  }
+  Frustum{projMatrix * viewMatrix}.cull(m_spheres, m_visibleLights);
+
+  m_lightData.resize(2 * m_visibleLights.size());
+  m_ranges.resize(m_visibleLights.size());
+  for (std::size_t index{}; index < m_visibleLights.size(); ++index) {
+    const auto &light{lights[m_visibleLights[index]]};
+    const glm::vec3 center{viewMatrix * glm::vec4{light.position, 1.0f}};
+    m_lightData[2 * index] = glm::vec4{center, light.radius};
+    m_lightData[2 * index + 1] = glm::vec4{light.color, 0.0f};
+    m_ranges[index] = computeRange(center, light.radius, projMatrix);
+  }
+
+  // Each thread bins the lights into the clusters of its own depth slices,
+  // first finding and counting the lights of each cluster, then writing
+  // their indices
+  auto numThreads{std::size_t{1}};
+  if (m_visibleLights.size() >= minParallelCount) {
+    numThreads = WorkerPool::shared().getThreadCount();
+  }
+
+  m_clusterData.assign(2 * numClusters, 0);
+  m_overlaps.resize(std::max(m_overlaps.size(), numThreads));
+  forEachRange(slices, numThreads,
+               [this](std::size_t range, int firstSlice, int lastSlice) {
+                 countRange(range, firstSlice, lastSlice);
+               });
+
+  // Offset of the indices of each cluster. The counts are reset and
+  // incremented again as the indices are written
+  std::uint32_t offset{};
+  for (std::size_t cluster{}; cluster < numClusters; ++cluster) {
+    m_clusterData[2 * cluster] = offset;
+    offset += m_clusterData[2 * cluster + 1];
+    m_clusterData[2 * cluster + 1] = 0;
+  }
+  m_lightIndexCount = offset;
+  m_lightIndices.resize(m_lightIndexCount);
+
+  forEachRange(slices, numThreads, [this](std::size_t range, int, int) {
+    fillRange(range);
+  });
+
+  upload();
+}
+
+/**
+ * @brief Binds the textures and sets the uniform variables read by the
+ * shaders.
+ *
+ * The program must be current. Sets the samplers lightsTex, clustersTex and
+ * lightIndicesTex, and clusterGrid (number of tiles and slices),
+ * clusterTileScale (tiles per pixel) and clusterDepthScaleBias, such that
+ * the slice of a fragment is log(-z) * scale - bias, z being its eye-space
+ * depth.
+ *
+ * @param program Shader program.
+ * @param viewportSize Size of the viewport, in pixels.
+ */
+void abcg::LightClusters::bind(GLuint program,
+                               const glm::ivec2 &viewportSize) const {
+  const GLint lightsTexLoc{abcg::glGetUniformLocation(program, "lightsTex")};
+  const GLint clustersTexLoc{
+      abcg::glGetUniformLocation(program, "clustersTex")};
+  const GLint lightIndicesTexLoc{
+      abcg::glGetUniformLocation(program, "lightIndicesTex")};
+  const GLint clusterGridLoc{
+      abcg::glGetUniformLocation(program, "clusterGrid")};
+  const GLint clusterTileScaleLoc{
+      abcg::glGetUniformLocation(program, "clusterTileScale")};
+  const GLint clusterDepthScaleBiasLoc{
+      abcg::glGetUniformLocation(program, "clusterDepthScaleBias")};
+
+  // Shaders without point lights
+  if (clustersTexLoc < 0) return;
+
+  const std::array textures{m_lightsTexture, m_clustersTexture,
+                            m_lightIndicesTexture};
+  for (GLuint index{}; index < textures.size(); ++index) {
+    abcg::glActiveTexture(GL_TEXTURE0 + firstTextureUnit + index);
+    abcg::glBindTexture(GL_TEXTURE_2D, textures.at(index));
+  }
+  abcg::glActiveTexture(GL_TEXTURE0);
+
+  abcg::glUniform1i(lightsTexLoc, static_cast<GLint>(firstTextureUnit));
+  abcg::glUniform1i(clustersTexLoc, static_cast<GLint>(firstTextureUnit + 1));
+  abcg::glUniform1i(lightIndicesTexLoc,
+                    static_cast<GLint>(firstTextureUnit + 2));
+  abcg::glUniform3i(clusterGridLoc, tilesX, tilesY, slices);
+  abcg::glUniform2f(clusterTileScaleLoc,
+                    static_cast<float>(tilesX) /
+                        static_cast<float>(std::max(viewportSize.x, 1)),
+                    static_cast<float>(tilesY) /
+                        static_cast<float>(std::max(viewportSize.y, 1)));
+  const auto depthScale{static_cast<float>(slices) /
+                        std::log(m_farPlane / m_nearPlane)};
+  abcg::glUniform2f(clusterDepthScaleBiasLoc, depthScale,
+                    depthScale * std::log(m_nearPlane));
+}
+
+abcg::LightClusters::ClusterRange
+abcg::LightClusters::computeRange(const glm::vec3 &center, float radius,
+                                  const glm::mat4 &projMatrix) const noexcept {
+  const auto sliceOf{[this](float depth) {
+    if (depth <= m_nearPlane) return 0;
+    const auto slice{static_cast<int>(std::log(depth / m_nearPlane) *
+                                      static_cast<float>(slices) /
+                                      std::log(m_farPlane / m_nearPlane))};
+    return std::clamp(slice, 0, slices - 1);
+  }};
+
+  ClusterRange range;
+  const auto nearDepth{-center.z - radius};
+  range.first.z = sliceOf(nearDepth);
+  range.last.z = sliceOf(-center.z + radius);
+
+  // A sphere that crosses the near plane may cover any tile
+  if (nearDepth <= m_nearPlane) {
+    range.first.x = 0;
+    range.first.y = 0;
+    range.last.x = tilesX - 1;
+    range.last.y = tilesY - 1;
+    return range;
+  }
+
+  // Screen-space bounds of the corners of the box around the sphere
+  glm::vec2 min{std::numeric_limits<float>::max()};
+  glm::vec2 max{std::numeric_limits<float>::lowest()};
+  for (auto corner{0U}; corner < 8U; ++corner) {
+    const glm::vec3 offset{(corner & 1U) != 0 ? radius : -radius,
+                           (corner & 2U) != 0 ? radius : -radius,
+                           (corner & 4U) != 0 ? radius : -radius};
+    const auto position{projMatrix * glm::vec4{center + offset, 1.0f}};
+    const auto ndc{glm::vec2{position} / position.w};
+    min = glm::min(min, ndc);
+    max = glm::max(max, ndc);
+  }
+
+  const glm::vec2 tiles{tilesX, tilesY};
+  const auto tileOf{[&](const glm::vec2 &ndc) {
+    const glm::ivec2 tile{glm::floor((ndc * 0.5f + 0.5f) * tiles)};
+    return glm::clamp(tile, glm::ivec2{0}, glm::ivec2{tilesX - 1, tilesY - 1});
+  }};
+  const auto firstTile{tileOf(min)};
+  const auto lastTile{tileOf(max)};
+  range.first.x = firstTile.x;
+  range.first.y = firstTile.y;
+  range.last.x = lastTile.x;
+  range.last.y = lastTile.y;
+  return range;
+}
+
+// Bounding box of each cluster, around the corners of its tile at the
+// depths of its slice. Each corner is on the line between its points on the
+// near and far planes, so that orthographic projections are also handled
+void abcg::LightClusters::computeClusterBounds(const glm::mat4 &projMatrix) {
+  m_boundsProjMatrix = projMatrix;
+  m_boundsNearPlane = m_nearPlane;
+  m_boundsFarPlane = m_farPlane;
+
+  const auto invProjMatrix{glm::inverse(projMatrix)};
+  const auto unproject{[&](const glm::vec3 &ndc) {
+    const auto position{invProjMatrix * glm::vec4{ndc, 1.0f}};
+    return glm::vec3{position} / position.w;
+  }};
+  std::vector<std::array<glm::vec3, 2>> corners;
+  corners.reserve(static_cast<std::size_t>((tilesX + 1) * (tilesY + 1)));
+  for (auto y{0}; y <= tilesY; ++y) {
+    for (auto x{0}; x <= tilesX; ++x) {
+      const glm::vec2 ndc{
+          2.0f * static_cast<float>(x) / static_cast<float>(tilesX) - 1.0f,
+          2.0f * static_cast<float>(y) / static_cast<float>(tilesY) - 1.0f};
+      corners.push_back(
+          {unproject({ndc, -1.0f}), unproject({ndc, 1.0f})});
+    }
+  }
+
+  // Same exponential spacing as the slice of a fragment in the shaders
+  const auto depthOf{[this](int slice) {
+    return m_nearPlane * std::pow(m_farPlane / m_nearPlane,
+                                  static_cast<float>(slice) /
+                                      static_cast<float>(slices));
+  }};
+
+  for (auto *bounds : {&m_clusterMinX, &m_clusterMinY, &m_clusterMinZ,
+                       &m_clusterMaxX, &m_clusterMaxY, &m_clusterMaxZ}) {
+    bounds->resize(numClusters);
+  }
+  for (auto slice{0}; slice < slices; ++slice) {
+    const std::array depths{depthOf(slice), depthOf(slice + 1)};
+    for (auto y{0}; y < tilesY; ++y) {
+      for (auto x{0}; x < tilesX; ++x) {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{std::numeric_limits<float>::lowest()};
+        for (auto corner{0}; corner < 4; ++corner) {
+          const auto &[nearPoint, farPoint]{corners.at(static_cast<std::size_t>(
+              (y + corner / 2) * (tilesX + 1) + x + corner % 2))};
+          for (const auto depth : depths) {
+            const auto t{(depth + nearPoint.z) / (nearPoint.z - farPoint.z)};
+            const auto point{nearPoint + (farPoint - nearPoint) * t};
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+          }
+        }
+
+        const auto cluster{
+            static_cast<std::size_t>((slice * tilesY + y) * tilesX + x)};
+        m_clusterMinX[cluster] = min.x;
+        m_clusterMinY[cluster] = min.y;
+        m_clusterMinZ[cluster] = min.z;
+        m_clusterMaxX[cluster] = max.x;
+        m_clusterMaxY[cluster] = max.y;
+        m_clusterMaxZ[cluster] = max.z;
+      }
+    }
+  }
+}
+
+// Calls function(cluster) for each cluster of the given slices whose
+// bounding box intersects the sphere of a visible light
+template <typename Function>
+void abcg::LightClusters::forEachCluster(std::size_t light, int firstSlice,
+                                         int lastSlice,
+                                         const Function &function) const {
+  const auto &range{m_ranges[light]};
+  const auto &sphere{m_lightData[2 * light]};
+  const auto radiusSquared{sphere.w * sphere.w};
+
+  const auto first{std::max(range.first.z, firstSlice)};
+  const auto last{std::min(range.last.z, lastSlice - 1)};
+  for (auto slice{first}; slice <= last; ++slice) {
+    for (auto y{range.first.y}; y <= range.last.y; ++y) {
+      const auto row{static_cast<std::size_t>((slice * tilesY + y) * tilesX)};
+      auto x{range.first.x};
+
+#if defined(__AVX__)
+      const auto centerX{_mm256_set1_ps(sphere.x)};
+      const auto centerY{_mm256_set1_ps(sphere.y)};
+      const auto centerZ{_mm256_set1_ps(sphere.z)};
+      const auto radius2{_mm256_set1_ps(radiusSquared)};
+      const auto zero{_mm256_setzero_ps()};
+      // Distance from the center to the box along one axis
+      const auto distance{[&](const float *min, const float *max,
+                              __m256 center) {
+        return _mm256_max_ps(
+            _mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(min), center),
+                          _mm256_sub_ps(center, _mm256_loadu_ps(max))),
+            zero);
+      }};
+
+      for (auto block{x / 8 * 8}; block <= range.last.x; block += 8) {
+        const auto cluster{row + static_cast<std::size_t>(block)};
+        const auto dx{distance(&m_clusterMinX[cluster],
+                               &m_clusterMaxX[cluster], centerX)};
+        const auto dy{distance(&m_clusterMinY[cluster],
+                               &m_clusterMaxY[cluster], centerY)};
+        const auto dz{distance(&m_clusterMinZ[cluster],
+                               &m_clusterMaxZ[cluster], centerZ)};
+        const auto distanceSquared{_mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+            _mm256_mul_ps(dz, dz))};
+
+        // Keep the clusters of the block that are in the range of the light
+        const auto firstBit{std::max(range.first.x - block, 0)};
+        const auto lastBit{std::min(range.last.x - block, 7)};
+        auto mask{static_cast<unsigned>(_mm256_movemask_ps(
+                      _mm256_cmp_ps(distanceSquared, radius2, _CMP_LE_OQ))) &
+                  ((2U << static_cast<unsigned>(lastBit)) - 1U) &
+                  ~((1U << static_cast<unsigned>(firstBit)) - 1U)};
+        while (mask != 0) {
+          function(cluster + static_cast<std::size_t>(std::countr_zero(mask)));
+          mask &= mask - 1;
+        }
+      }
+      x = range.last.x + 1;
+#endif
+
+      for (; x <= range.last.x; ++x) {
+        const auto cluster{row + static_cast<std::size_t>(x)};
+        const auto distanceOf{[](float center, float min, float max) {
+          return std::max(std::max(min - center, center - max), 0.0f);
+        }};
+        const glm::vec3 distance{
+            distanceOf(sphere.x, m_clusterMinX[cluster],
+                       m_clusterMaxX[cluster]),
+            distanceOf(sphere.y, m_clusterMinY[cluster],
+                       m_clusterMaxY[cluster]),
+            distanceOf(sphere.z, m_clusterMinZ[cluster],
+                       m_clusterMaxZ[cluster])};
+        if (glm::dot(distance, distance) <= radiusSquared) function(cluster);
+      }
+    }
+  }
+}
+
+// Each cluster is tested once, and the overlaps are kept for fillRange
+void abcg::LightClusters::countRange(std::size_t range, int firstSlice,
+                                     int lastSlice) {
+  auto &overlaps{m_overlaps[range]};
+  overlaps.clear();
+  for (std::size_t light{}; light < m_ranges.size(); ++light) {
+    forEachCluster(light, firstSlice, lastSlice, [&](std::size_t cluster) {
+      ++m_clusterData[2 * cluster + 1];
+      overlaps.push_back({static_cast<std::uint32_t>(cluster),
+                          static_cast<std::uint32_t>(light)});
+    });
+  }
+}
+
+void abcg::LightClusters::fillRange(std::size_t range) {
+  for (const auto &[cluster, light] : m_overlaps[range]) {
+    const auto index{m_clusterData[2 * cluster] +
+                     m_clusterData[2 * cluster + 1]++};
+    m_lightIndices[index] = light;
+  }
+}
+
+void abcg::LightClusters::upload() {
+  if (m_lightsTexture == 0) return;
+
+  // Whole rows are uploaded, so the arrays are padded to the texture width
+  const auto rowsOf{[](std::size_t size) {
+    return static_cast<GLsizei>((size + textureWidth - 1) / textureWidth);
+  }};
+
+  const auto lightRows{rowsOf(m_lightData.size())};
+  if (lightRows > 0) {
+    m_lightData.resize(static_cast<std::size_t>(lightRows) * textureWidth);
+    abcg::glBindTexture(GL_TEXTURE_2D, m_lightsTexture);
+    abcg::glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth, lightRows,
+                          GL_RGBA, GL_FLOAT, m_lightData.data());
+  }
+
+  abcg::glBindTexture(GL_TEXTURE_2D, m_clustersTexture);
+  abcg::glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tilesX * tilesY, slices,
+                        GL_RG_INTEGER, GL_UNSIGNED_INT, m_clusterData.data());
+
+  const auto indexRows{rowsOf(m_lightIndices.size())};
+  if (indexRows > 0) {
+    abcg::glBindTexture(GL_TEXTURE_2D, m_lightIndicesTexture);
+    if (indexRows > m_lightIndicesRows) {
+      m_lightIndicesRows = static_cast<GLsizei>(
+          std::bit_ceil(static_cast<unsigned>(indexRows)));
+      abcg::glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, textureWidth,
+                         m_lightIndicesRows, 0, GL_RED_INTEGER,
+                         GL_UNSIGNED_INT, nullptr);
+    }
+    m_lightIndices.resize(static_cast<std::size_t>(indexRows) * textureWidth);
+    abcg::glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth, indexRows,
+                          GL_RED_INTEGER, GL_UNSIGNED_INT,
+                          m_lightIndices.data());
+  }
+
+  abcg::glBindTexture(GL_TEXTURE_2D, 0);
+}
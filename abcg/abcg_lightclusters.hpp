@@ -0,0 +1,152 @@
+/**
+ * @file abcg_lightclusters.hpp
+ * @brief abcg::LightClusters header file.
+ *
+ * Declaration of abcg::LightClusters class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_LIGHTCLUSTERS_HPP_
+#define ABCG_LIGHTCLUSTERS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+#include "abcg_external.hpp"
+#include "abcg_frustum.hpp"
+
+namespace abcg {
+class LightClusters;
+}  // namespace abcg
+
+/**
+ * @brief abcg::LightClusters class.
+ *
+ * Clustered forward shading of point lights. The view frustum is divided
+ * into a grid of abcg::LightClusters::tilesX by abcg::LightClusters::tilesY
+ * screen tiles and abcg::LightClusters::slices depth slices, exponentially
+ * spaced between the near and far planes. abcg::LightClusters::update culls
+ * the lights against the frustum with abcg::Frustum::cull and bins the
+ * visible lights into the clusters their bounding spheres overlap, so that
+ * each fragment only iterates the lights of its cluster.
+ *
+ * Each light is first mapped to the range of clusters covered by the
+ * screen-space box of its sphere. The sphere is then tested against the
+ * view-space bounding box of each cluster of the range, eight clusters of a
+ * row at a time when ABCg is built with AVX (ABCG_AVX). The binning is split
+ * by depth slice across the threads of abcg::WorkerPool::shared.
+ *
+ * The results are stored in three 2D textures read with texelFetch. Texture
+ * buffers (samplerBuffer) would be simpler and are core since OpenGL 3.1,
+ * but OpenGL ES 3.0 and WebGL 2.0 lack them, and the same shaders run on
+ * all platforms:
+ * - lightsTex (RGBA32F): two texels per light, with the eye-space position
+ *   and radius, and the color;
+ * - clustersTex (RG32UI): one texel per cluster, with the offset and number
+ *   of its light indices, at (x + y * tilesX, slice);
+ * - lightIndicesTex (R32UI): the light indices of all clusters.
+ *
+ * abcg::LightClusters::bind binds these textures to the units starting at
+ * abcg::LightClusters::firstTextureUnit and sets the uniform variables used
+ * to find the cluster of a fragment.
+ */
+class abcg::LightClusters {
+ public:
+  struct PointLight {
+    // World-space position
+    glm::vec3 position{};
+    // Distance at which the light no longer has any effect
+    float radius{1.0f};
+    glm::vec3 color{1.0f};
+  };
+
+  static constexpr int tilesX{16};
+  static constexpr int tilesY{9};
+  static constexpr int slices{24};
+  static constexpr std::size_t maxLights{4096};
+  // Units 0 to 3 are left to the textures of the materials
+  static constexpr GLuint firstTextureUnit{4};
+
+  LightClusters() = default;
+  ~LightClusters();
+
+  LightClusters(const LightClusters&) = delete;
+  LightClusters(LightClusters&&) = delete;
+  LightClusters& operator=(const LightClusters&) = delete;
+  LightClusters& operator=(LightClusters&&) = delete;
+
+  void initialize();
+  void terminate();
+
+  void update(std::span<const PointLight> lights, const glm::mat4& viewMatrix,
+              const glm::mat4& projMatrix, float nearPlane, float farPlane);
+  void bind(GLuint program, const glm::ivec2& viewportSize) const;
+
+  [[nodiscard]] std::size_t getVisibleLightCount() const noexcept {
+    return m_visibleLights.size();
+  }
+  [[nodiscard]] std::size_t getLightIndexCount() const noexcept {
+    return m_lightIndexCount;
+  }
+
+ private:
+  // Clusters overlapped by a light, as inclusive ranges
+  struct ClusterRange {
+    glm::ivec3 first{};
+    glm::ivec3 last{};
+  };
+
+  [[nodiscard]] ClusterRange
+  computeRange(const glm::vec3& center, float radius,
+               const glm::mat4& projMatrix) const noexcept;
+  void computeClusterBounds(const glm::mat4& projMatrix);
+  template <typename Function>
+  void forEachCluster(std::size_t light, int firstSlice, int lastSlice,
+                      const Function& function) const;
+  void countRange(std::size_t range, int firstSlice, int lastSlice);
+  void fillRange(std::size_t range);
+  void upload();
+
+  GLuint m_lightsTexture{};
+  GLuint m_clustersTexture{};
+  GLuint m_lightIndicesTexture{};
+  // Number of rows allocated for lightIndicesTex
+  GLsizei m_lightIndicesRows{};
+
+  float m_nearPlane{0.1f};
+  float m_farPlane{100.0f};
+
+  // View-space bounding boxes of the clusters, one array for each
+  // coordinate, and the projection they were computed for
+  std::vector<float> m_clusterMinX;
+  std::vector<float> m_clusterMinY;
+  std::vector<float> m_clusterMinZ;
+  std::vector<float> m_clusterMaxX;
+  std::vector<float> m_clusterMaxY;
+  std::vector<float> m_clusterMaxZ;
+  glm::mat4 m_boundsProjMatrix{0.0f};
+  float m_boundsNearPlane{};
+  float m_boundsFarPlane{};
+
+  BoundingSpheres m_spheres;
+  std::vector<std::uint32_t> m_visibleLights;
+  std::vector<ClusterRange> m_ranges;
+  // Clusters overlapped by the lights, as (cluster, light) pairs, found in
+  // each range of slices by countRange and written by fillRange
+  std::vector<std::vector<std::array<std::uint32_t, 2>>> m_overlaps;
+  // Contents of the textures
+  std::vector<glm::vec4> m_lightData;
+  std::vector<std::uint32_t> m_clusterData;
+  std::vector<std::uint32_t> m_lightIndices;
+  std::size_t m_lightIndexCount{};
+};
+
+#endif
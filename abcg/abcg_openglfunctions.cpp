@@ -9,7 +9,95 @@
 
 #include "abcg_exception.hpp"
 
-#if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+#if defined(ABCG_GL_DEBUG_OUTPUT) && !defined(__EMSCRIPTEN__) && \
+    !defined(__APPLE__)
+#include <fmt/core.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#if !defined(GLAPIENTRY)
+#define GLAPIENTRY APIENTRY
+#endif
+#endif
+
+/**
+ * @brief Checks whether the current OpenGL context supports an extension.
+ *
+ * @param extension Extension name (e.g. "GL_KHR_debug").
+ * @return true if the extension is listed by the context, false otherwise.
+ */
+bool abcg::isExtensionSupported(std::string_view extension) {
+  GLint numExtensions{};
+  ::glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+  for (GLint index{}; index < numExtensions; ++index) {
+    const auto *name{reinterpret_cast<const char *>(
+        ::glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(index)))};
+    if (name != nullptr && extension == name) return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Checks whether the direct state access (DSA) functions can be used.
+ *
+ * DSA is core in OpenGL 4.5 and is also exposed by ARB_direct_state_access.
+ * Resource creation paths use it to edit objects without binding them, and
+ * fall back to bind-to-edit on OpenGL 4.1 (macOS) and OpenGL ES.
+ *
+ * The result is queried once, on the first call, which must be made with a
+ * current OpenGL context.
+ *
+ * @return true if DSA is supported, false otherwise.
+ */
+bool abcg::isDirectStateAccessSupported() {
+#if defined(__EMSCRIPTEN__) || defined(__APPLE__)
+  return false;
+#else
+  static const bool supported{[] {
+    GLint majorVersion{};
+    GLint minorVersion{};
+    ::glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+    ::glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+    return majorVersion * 10 + minorVersion >= 45 ||
+           isExtensionSupported("GL_ARB_direct_state_access");
+  }()};
+  return supported;
+#endif
+}
+
+/**
+ * @brief Checks whether immutable buffer storage (glBufferStorage) can be
+ * used.
+ *
+ * Buffer storage is core in OpenGL 4.4 and is also exposed by
+ * ARB_buffer_storage. It allows buffers to stay mapped while they are used
+ * for rendering (see abcg::StreamBuffer).
+ *
+ * The result is queried once, on the first call, which must be made with a
+ * current OpenGL context.
+ *
+ * @return true if buffer storage is supported, false otherwise.
+ */
+bool abcg::isBufferStorageSupported() {
+#if defined(__EMSCRIPTEN__) || defined(__APPLE__)
+  return false;
+#else
+  static const bool supported{[] {
+    GLint majorVersion{};
+    GLint minorVersion{};
+    ::glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+    ::glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+    return majorVersion * 10 + minorVersion >= 44 ||
+           isExtensionSupported("GL_ARB_buffer_storage");
+  }()};
+  return supported;
+#endif
+}
+
+#if !defined(ABCG_GL_DEBUG_OUTPUT) && !defined(NDEBUG) && \
+    !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
 /**
  * @brief Checks OpenGL error status and throws on error with a log message.
  *
@@ -27,4 +115,155 @@ void abcg::checkGLError(
         abcg::Exception::OpenGL(prefix, status, sourceLocation)};
   }
 }
-#endif
\ No newline at end of file
+#endif
+#if defined(ABCG_GL_DEBUG_OUTPUT) && !defined(__EMSCRIPTEN__) && \
+    !defined(__APPLE__)
+namespace {
+// Number of messages printed per call site before further messages from the
+// same call site are suppressed
+constexpr int maxMessagesPerCallSite{10};
+
+// Whether the callback runs in the call stack of the offending call
+bool synchronousOutput{};
+
+std::string_view debugSourceName(GLenum source) {
+  switch (source) {
+    case GL_DEBUG_SOURCE_API:
+      return "API";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+      return "window system";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER:
+      return "shader compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY:
+      return "third party";
+    case GL_DEBUG_SOURCE_APPLICATION:
+      return "application";
+    default:
+      return "other";
+  }
+}
+
+std::string_view debugTypeName(GLenum type) {
+  switch (type) {
+    case GL_DEBUG_TYPE_ERROR:
+      return "error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+      return "deprecated behavior";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+      return "undefined behavior";
+    case GL_DEBUG_TYPE_PORTABILITY:
+      return "portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:
+      return "performance";
+    default:
+      return "other";
+  }
+}
+
+std::string_view debugSeverityName(GLenum severity) {
+  switch (severity) {
+    case GL_DEBUG_SEVERITY_HIGH:
+      return "high";
+    case GL_DEBUG_SEVERITY_MEDIUM:
+      return "medium";
+    case GL_DEBUG_SEVERITY_LOW:
+      return "low";
+    default:
+      return "notification";
+  }
+}
+
+void GLAPIENTRY debugMessageCallback(GLenum source, GLenum type, GLuint id,
+                                     GLenum severity,
+                                     [[maybe_unused]] GLsizei length,
+                                     const GLchar *message,
+                                     [[maybe_unused]] const void *userParam) {
+  // With asynchronous output, the callback may run on a driver thread, or
+  // after the offending call has returned, so the call site is unknown
+  const auto *sourceLocation{synchronousOutput
+                                 ? abcg::detail::currentCallSite()
+                                 : nullptr};
+  auto callSite{sourceLocation == nullptr
+                    ? fmt::format("unknown call site (message id {})", id)
+                    : fmt::format("{}:{}:{}", sourceLocation->file_name(),
+                                  sourceLocation->function_name(),
+                                  sourceLocation->line())};
+
+  // Rate-limit per call site so that an error inside the render loop does
+  // not flood the output. The callback may run on any thread, hence the lock
+  static std::mutex mutex;
+  static std::unordered_map<std::string, int> messageCount;
+  int count{};
+  {
+    const std::scoped_lock lock{mutex};
+    count = ++messageCount[callSite];
+  }
+  if (count > maxMessagesPerCallSite) return;
+
+  fmt::print(stderr, "OpenGL {} ({} severity, {}, id {}): {}\n  in {}\n",
+             debugTypeName(type), debugSeverityName(severity),
+             debugSourceName(source), id, message, callSite);
+  if (count == maxMessagesPerCallSite) {
+    fmt::print(stderr, "  further messages from this call site suppressed\n");
+  }
+}
+}  // namespace
+
+/**
+ * @brief Enables OpenGL debug output through KHR_debug.
+ *
+ * Installs a debug message callback that reports errors and warnings.
+ * Messages are rate-limited per call site. Notifications are filtered out.
+ *
+ * By default, the output is synchronous: each message reports the source
+ * location of the abcg wrapper call that generated it, at the cost of
+ * serializing the driver and of recording the call site of every call.
+ * Asynchronous output lets the driver report messages when convenient,
+ * without serializing its work, but the call that generated a message is
+ * unknown, so call sites are not recorded.
+ *
+ * This replaces the glGetError checks done before and after every call in
+ * debug builds, and is enabled by defining ABCG_GL_DEBUG_OUTPUT.
+ *
+ * Must be called with a current OpenGL context.
+ *
+ * @param synchronous Whether to enable GL_DEBUG_OUTPUT_SYNCHRONOUS. See
+ * abcg::OpenGLSettings::synchronousDebugOutput.
+ */
+void abcg::enableDebugOutput(bool synchronous) {
+  GLint majorVersion{};
+  GLint minorVersion{};
+  ::glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+  ::glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+  if (majorVersion * 10 + minorVersion < 43 &&
+      !isExtensionSupported("GL_KHR_debug")) {
+    fmt::print("Warning: KHR_debug not supported, OpenGL debug output "
+               "disabled\n");
+    detail::recordCallSites = false;
+    return;
+  }
+
+  ::glEnable(GL_DEBUG_OUTPUT);
+  // Synchronous output makes the callback run in the thread and call stack of
+  // the offending call, so that the call site can be identified
+  synchronousOutput = synchronous;
+  detail::recordCallSites = synchronous;
+  if (synchronous) {
+    ::glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  } else {
+    ::glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  }
+  ::glDebugMessageCallback(debugMessageCallback, nullptr);
+  ::glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+                          GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr,
+                          GL_FALSE);
+
+  GLint contextFlags{};
+  ::glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
+  fmt::print("OpenGL debug output enabled ({}{})\n",
+             synchronous ? "synchronous" : "asynchronous",
+             (contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT) != 0
+                 ? ""
+                 : ", not a debug context");
+}
+#endif
@@ -0,0 +1,296 @@
+/**
+ * @file abcg_openglstatecache.hpp
+ * @brief abcg::OpenGLStateCache header file.
+ *
+ * Declaration and inline definition of abcg::OpenGLStateCache class, used by
+ * the abcg::gl* wrappers to elide redundant state changes when
+ * ABCG_GL_STATE_CACHE is defined.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGLSTATECACHE_HPP_
+#define ABCG_OPENGLSTATECACHE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <span>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class OpenGLStateCache;
+struct OpenGLStateCacheCounters;
+}  // namespace abcg
+
+/**
+ * @brief Number of state-setting calls issued to the driver and elided by
+ * abcg::OpenGLStateCache.
+ */
+struct abcg::OpenGLStateCacheCounters {
+  std::size_t issued{};
+  std::size_t elided{};
+};
+
+/**
+ * @brief abcg::OpenGLStateCache class.
+ *
+ * Shadow copy of the OpenGL state set through the abcg::gl* wrappers. It
+ * covers the bound program, vertex array, buffers per target, textures and
+ * samplers per texture unit, enable bits, blend and depth state, face culling
+ * state and the viewport.
+ *
+ * Each member function that sets a state returns true if the corresponding
+ * OpenGL call must be issued, and false if the call is redundant and can be
+ * skipped. Values that are not known (e.g. after a call to
+ * abcg::OpenGLStateCache::invalidate) never compare equal, so the next call
+ * is always issued.
+ *
+ * There is one cache per thread, which matches the context current in that
+ * thread. OpenGL calls that bypass the wrappers must be followed by a call to
+ * abcg::OpenGLStateCache::invalidate.
+ */
+class abcg::OpenGLStateCache {
+ public:
+  [[nodiscard]] static OpenGLStateCache& current() noexcept;
+
+  [[nodiscard]] bool useProgram(GLuint program) noexcept {
+    return update(m_program, program);
+  }
+  [[nodiscard]] bool bindVertexArray(GLuint array) noexcept {
+    if (!update(m_vertexArray, array)) return false;
+    // The element array buffer binding is part of the vertex array state
+    m_buffers.at(elementArrayBufferIndex).reset();
+    return true;
+  }
+  [[nodiscard]] bool bindBuffer(GLenum target, GLuint buffer) noexcept {
+    const auto index{bufferTargetIndex(target)};
+    if (index >= m_buffers.size()) return issue();
+    return update(m_buffers.at(index), buffer);
+  }
+  [[nodiscard]] bool activeTexture(GLenum texture) noexcept {
+    return update(m_activeTexture, texture);
+  }
+  [[nodiscard]] bool bindTexture(GLenum target, GLuint texture) noexcept {
+    const auto targetIndex{textureTargetIndex(target)};
+    if (!m_activeTexture || targetIndex >= numTextureTargets) return issue();
+    const auto unit{static_cast<std::size_t>(*m_activeTexture - GL_TEXTURE0)};
+    if (unit >= maxTextureUnits) return issue();
+    return update(m_textures.at(unit).at(targetIndex), texture);
+  }
+  [[nodiscard]] bool bindSampler(GLuint unit, GLuint sampler) noexcept {
+    if (unit >= maxTextureUnits) return issue();
+    return update(m_samplers.at(unit), sampler);
+  }
+  [[nodiscard]] bool enable(GLenum cap, bool enabled) noexcept {
+    const auto index{capabilityIndex(cap)};
+    if (index >= m_capabilities.size()) return issue();
+    return update(m_capabilities.at(index), enabled);
+  }
+  [[nodiscard]] bool blendFunc(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha,
+                               GLenum dstAlpha) noexcept {
+    return update(m_blendFunc,
+                  std::array<GLenum, 4>{srcRGB, dstRGB, srcAlpha, dstAlpha});
+  }
+  [[nodiscard]] bool blendEquation(GLenum modeRGB, GLenum modeAlpha) noexcept {
+    return update(m_blendEquation, std::array<GLenum, 2>{modeRGB, modeAlpha});
+  }
+  [[nodiscard]] bool depthFunc(GLenum func) noexcept {
+    return update(m_depthFunc, func);
+  }
+  [[nodiscard]] bool depthMask(GLboolean flag) noexcept {
+    return update(m_depthMask, flag);
+  }
+  [[nodiscard]] bool cullFace(GLenum mode) noexcept {
+    return update(m_cullFace, mode);
+  }
+  [[nodiscard]] bool frontFace(GLenum mode) noexcept {
+    return update(m_frontFace, mode);
+  }
+  [[nodiscard]] bool viewport(GLint x, GLint y, GLsizei width,
+                              GLsizei height) noexcept {
+    return update(m_viewport, std::array<GLint, 4>{x, y, width, height});
+  }
+
+  /**
+   * @brief Records the binding of a buffer to an indexed target, which also
+   * binds it to the generic target.
+   */
+  void bindBufferBase(GLenum target, GLuint buffer) noexcept {
+    const auto index{bufferTargetIndex(target)};
+    if (index < m_buffers.size()) m_buffers.at(index) = buffer;
+  }
+
+  // Deleted objects that are currently bound revert to the default binding
+  void deleteBuffers(std::span<const GLuint> buffers) noexcept {
+    for (const auto buffer : buffers) {
+      for (auto& binding : m_buffers) {
+        if (binding == buffer) binding = 0;
+      }
+    }
+  }
+  void deleteTextures(std::span<const GLuint> textures) noexcept {
+    for (const auto texture : textures) {
+      for (auto& unit : m_textures) {
+        for (auto& binding : unit) {
+          if (binding == texture) binding = 0;
+        }
+      }
+    }
+  }
+  void deleteSamplers(std::span<const GLuint> samplers) noexcept {
+    for (const auto sampler : samplers) {
+      for (auto& binding : m_samplers) {
+        if (binding == sampler) binding = 0;
+      }
+    }
+  }
+  void deleteVertexArrays(std::span<const GLuint> arrays) noexcept {
+    for (const auto array : arrays) {
+      if (m_vertexArray == array) {
+        m_vertexArray = 0;
+        m_buffers.at(elementArrayBufferIndex).reset();
+      }
+    }
+  }
+  void deleteProgram(GLuint program) noexcept {
+    // A program in use is only flagged for deletion
+    if (m_program == program) m_program.reset();
+  }
+
+  /**
+   * @brief Forgets all cached values. The counters are kept.
+   */
+  void invalidate() noexcept {
+    const auto counters{m_counters};
+    *this = OpenGLStateCache{};
+    m_counters = counters;
+  }
+
+  /**
+   * @brief Returns the counters accumulated since the last call and resets
+   * them.
+   */
+  [[nodiscard]] OpenGLStateCacheCounters takeCounters() noexcept {
+    const auto counters{m_counters};
+    m_counters = {};
+    return counters;
+  }
+
+ private:
+  static constexpr std::size_t maxTextureUnits{32};
+  static constexpr std::size_t numTextureTargets{4};
+  static constexpr std::size_t elementArrayBufferIndex{1};
+  static constexpr auto invalidIndex{static_cast<std::size_t>(-1)};
+
+  template <typename T>
+  [[nodiscard]] bool update(std::optional<T>& cached,
+                            const T& value) noexcept {
+    if (cached == value) {
+      ++m_counters.elided;
+      return false;
+    }
+    cached = value;
+    return issue();
+  }
+
+  [[nodiscard]] bool issue() noexcept {
+    ++m_counters.issued;
+    return true;
+  }
+
+  static std::size_t bufferTargetIndex(GLenum target) noexcept {
+    switch (target) {
+      case GL_ARRAY_BUFFER:
+        return 0;
+      case GL_ELEMENT_ARRAY_BUFFER:
+        return elementArrayBufferIndex;
+      case GL_UNIFORM_BUFFER:
+        return 2;
+      case GL_PIXEL_PACK_BUFFER:
+        return 3;
+      case GL_PIXEL_UNPACK_BUFFER:
+        return 4;
+      case GL_COPY_READ_BUFFER:
+        return 5;
+      case GL_COPY_WRITE_BUFFER:
+        return 6;
+      case GL_TRANSFORM_FEEDBACK_BUFFER:
+        return 7;
+      default:
+        return invalidIndex;
+    }
+  }
+
+  static std::size_t textureTargetIndex(GLenum target) noexcept {
+    switch (target) {
+      case GL_TEXTURE_2D:
+        return 0;
+      case GL_TEXTURE_CUBE_MAP:
+        return 1;
+      case GL_TEXTURE_3D:
+        return 2;
+      case GL_TEXTURE_2D_ARRAY:
+        return 3;
+      default:
+        return invalidIndex;
+    }
+  }
+
+  static std::size_t capabilityIndex(GLenum cap) noexcept {
+    switch (cap) {
+      case GL_BLEND:
+        return 0;
+      case GL_CULL_FACE:
+        return 1;
+      case GL_DEPTH_TEST:
+        return 2;
+      case GL_SCISSOR_TEST:
+        return 3;
+      case GL_STENCIL_TEST:
+        return 4;
+      case GL_POLYGON_OFFSET_FILL:
+        return 5;
+      case GL_RASTERIZER_DISCARD:
+        return 6;
+      case GL_SAMPLE_ALPHA_TO_COVERAGE:
+        return 7;
+      case GL_SAMPLE_COVERAGE:
+        return 8;
+      case GL_DITHER:
+        return 9;
+      default:
+        return invalidIndex;
+    }
+  }
+
+  std::optional<GLuint> m_program;
+  std::optional<GLuint> m_vertexArray;
+  std::array<std::optional<GLuint>, 8> m_buffers{};
+  std::optional<GLenum> m_activeTexture;
+  std::array<std::array<std::optional<GLuint>, numTextureTargets>,
+             maxTextureUnits>
+      m_textures{};
+  std::array<std::optional<GLuint>, maxTextureUnits> m_samplers{};
+  std::array<std::optional<bool>, 10> m_capabilities{};
+  std::optional<std::array<GLenum, 4>> m_blendFunc;
+  std::optional<std::array<GLenum, 2>> m_blendEquation;
+  std::optional<GLenum> m_depthFunc;
+  std::optional<GLboolean> m_depthMask;
+  std::optional<GLenum> m_cullFace;
+  std::optional<GLenum> m_frontFace;
+  std::optional<std::array<GLint, 4>> m_viewport;
+
+  OpenGLStateCacheCounters m_counters;
+};
+
+/**
+ * @brief Returns the state cache of the calling thread.
+ */
+inline abcg::OpenGLStateCache& abcg::OpenGLStateCache::current() noexcept {
+  static thread_local OpenGLStateCache cache{};
+  return cache;
+}
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ * @file abcg_opengltracer.cpp
+ * @brief Definition of abcg::OpenGLTracer class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#if defined(ABCG_GL_TRACE) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+
+#include "abcg_opengltracer.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "abcg_exception.hpp"
+#include "abcg_string.hpp"
+
+namespace {
+// Start times of the most recent frames, indexed by frame number
+constexpr std::size_t maxFrameMarkers{256};
+std::array<std::int64_t, maxFrameMarkers> frameStartTimes{};
+std::atomic<std::size_t> lastFrameCallCount{};
+}  // namespace
+
+std::mutex abcg::OpenGLTracer::m_registryMutex;
+std::vector<std::unique_ptr<abcg::OpenGLTracer::ThreadBuffer>>
+    abcg::OpenGLTracer::m_threadBuffers;
+
+/**
+ * @brief Marks the beginning of a new frame.
+ *
+ * Updates the call count of the frame that just ended. Must be called from a
+ * single thread, usually at the beginning of abcg::OpenGLWindow::paint.
+ */
+void abcg::OpenGLTracer::beginFrame() {
+  const auto frame{m_frame.load(std::memory_order_relaxed) + 1};
+
+  std::size_t callCount{};
+  {
+    const std::scoped_lock lock{m_registryMutex};
+    for (auto &buffer : m_threadBuffers) {
+      const auto count{buffer->count.load(std::memory_order_acquire)};
+      callCount += count - buffer->countAtFrameStart;
+      buffer->countAtFrameStart = count;
+    }
+  }
+  lastFrameCallCount = callCount;
+
+  frameStartTimes.at(frame % maxFrameMarkers) = now();
+  m_frame.store(frame, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the number of OpenGL calls recorded in the last frame, for
+ * all threads.
+ */
+std::size_t abcg::OpenGLTracer::getLastFrameCallCount() {
+  return lastFrameCallCount;
+}
+
+/**
+ * @brief Writes the calls recorded in the most recent frames to a file in the
+ * Chrome trace event format.
+ *
+ * Calls that are older than the capacity of the ring buffer of each thread
+ * are not available.
+ *
+ * @param path Path to the output file.
+ * @param numFrames Number of frames to export, including the current one.
+ *
+ * @throw abcg::Exception if the file cannot be written.
+ */
+void abcg::OpenGLTracer::writeChromeTrace(std::string_view path,
+                                          std::size_t numFrames) {
+  const auto currentFrame{m_frame.load(std::memory_order_relaxed)};
+  numFrames = std::min(numFrames, maxFrameMarkers);
+  const auto firstFrame{currentFrame >= numFrames ? currentFrame - numFrames + 1
+                                                  : 0};
+
+  std::ofstream stream{std::string{path}};
+  if (!stream) {
+    throw abcg::Exception{
+        abcg::Exception::Runtime(fmt::format("Failed to write {}", path))};
+  }
+
+  // Timestamps are relative to the beginning of the first exported frame
+  const auto origin{frameStartTimes.at(firstFrame % maxFrameMarkers)};
+  const auto toMicroseconds{[origin](std::int64_t time) {
+    return static_cast<double>(time - origin) / 1000.0;
+  }};
+
+  stream << R"({"displayTimeUnit":"ns","traceEvents":[)" << '\n';
+  auto separator{""};
+  for (auto frame{firstFrame}; frame <= currentFrame; ++frame) {
+    stream << separator
+           << fmt::format(
+                  R"({{"name":"Frame {}","ph":"i","s":"g","ts":{:.3f},)"
+                  R"("pid":0,"tid":0}})",
+                  frame,
+                  toMicroseconds(frameStartTimes.at(frame % maxFrameMarkers)));
+    separator = ",\n";
+  }
+
+  const std::scoped_lock lock{m_registryMutex};
+  std::vector<Record> records;
+  for (const auto &buffer : m_threadBuffers) {
+    const auto end{buffer->count.load(std::memory_order_acquire)};
+    const auto begin{end > ThreadBuffer::capacity
+                         ? end - ThreadBuffer::capacity
+                         : 0};
+    // Records that the owner thread overwrites while they are copied are
+    // discarded
+    records.clear();
+    for (auto index{begin}; index < end; ++index) {
+      if (Record record;
+          load(buffer->slots.at(index % ThreadBuffer::capacity), index,
+               record)) {
+        records.push_back(record);
+      }
+    }
+
+    for (const auto &record : records) {
+      if (record.frame < firstFrame || record.frame > currentFrame) continue;
+      stream << separator
+             << fmt::format(
+                    R"({{"name":"{}","cat":"gl","ph":"X","ts":{:.3f},)"
+                    R"("dur":{:.3f},"pid":0,"tid":{},"args":{{)"
+                    R"("callSite":"{}:{}","function":"{}"}}}})",
+                    record.name, toMicroseconds(record.start),
+                    static_cast<double>(record.duration) / 1000.0,
+                    buffer->threadID, escapeJSON(record.fileName), record.line,
+                    escapeJSON(record.functionName));
+      separator = ",\n";
+    }
+  }
+  stream << "\n]}\n";
+
+  if (!stream) {
+    throw abcg::Exception{
+        abcg::Exception::Runtime(fmt::format("Failed to write {}", path))};
+  }
+}
+
+/**
+ * @brief Copies the record with the given index from a slot written by
+ * another thread.
+ *
+ * @return Whether the slot held the record for the whole copy.
+ */
+bool abcg::OpenGLTracer::load(const Slot &slot, std::uint64_t index,
+                              Record &record) noexcept {
+  constexpr auto relaxed{std::memory_order_relaxed};
+  if (slot.sequence.load(std::memory_order_acquire) != index + 1) return false;
+  record.name = slot.name.load(relaxed);
+  record.fileName = slot.fileName.load(relaxed);
+  record.functionName = slot.functionName.load(relaxed);
+  record.line = slot.line.load(relaxed);
+  record.frame = slot.frame.load(relaxed);
+  record.start = slot.start.load(relaxed);
+  record.duration = slot.duration.load(relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(relaxed) == index + 1;
+}
+
+abcg::OpenGLTracer::ThreadBuffer *abcg::OpenGLTracer::registerThread() {
+  auto buffer{std::make_unique<ThreadBuffer>()};
+  auto *const pointer{buffer.get()};
+
+  const std::scoped_lock lock{m_registryMutex};
+  buffer->threadID = static_cast<std::uint32_t>(m_threadBuffers.size());
+  m_threadBuffers.push_back(std::move(buffer));
+  return pointer;
+}
+
+#endif
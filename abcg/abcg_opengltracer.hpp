@@ -0,0 +1,145 @@
+/**
+ * @file abcg_opengltracer.hpp
+ * @brief abcg::OpenGLTracer header file.
+ *
+ * Declaration of abcg::OpenGLTracer class, used by abcg::callGL to record
+ * every OpenGL call when ABCG_GL_TRACE is defined.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGLTRACER_HPP_
+#define ABCG_OPENGLTRACER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <experimental/source_location>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace abcg {
+class OpenGLTracer;
+}  // namespace abcg
+
+/**
+ * @brief abcg::OpenGLTracer class.
+ *
+ * Records the OpenGL calls made through the abcg::gl* wrappers. Each record
+ * holds the function name, the call site, the CPU timestamp and the duration
+ * of the call.
+ *
+ * Records are written to a ring buffer owned by the calling thread, so that
+ * recording does not take any lock. Each slot of the ring buffer is guarded
+ * by a sequence number, so that a record being overwritten while it is
+ * exported is detected and skipped. The most recent frames can be exported
+ * in the Chrome trace event format, which can be opened in chrome://tracing
+ * or https://ui.perfetto.dev.
+ */
+class abcg::OpenGLTracer {
+ public:
+  struct Record {
+    const char* name{};
+    const char* fileName{};
+    const char* functionName{};
+    std::uint_least32_t line{};
+    std::uint64_t frame{};
+    std::int64_t start{};
+    std::int64_t duration{};
+  };
+
+  /**
+   * @brief Records the OpenGL call made during the lifetime of the object.
+   */
+  class Scope {
+   public:
+    Scope(const std::experimental::source_location& sourceLocation,
+          const char* name) noexcept
+        : m_record{.name = name,
+                   .fileName = sourceLocation.file_name(),
+                   .functionName = sourceLocation.function_name(),
+                   .line = sourceLocation.line(),
+                   .frame = m_frame.load(std::memory_order_relaxed),
+                   .start = now()} {}
+    ~Scope() {
+      m_record.duration = now() - m_record.start;
+      record(m_record);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope(Scope&&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope& operator=(Scope&&) = delete;
+
+   private:
+    Record m_record;
+  };
+
+  static void beginFrame();
+  [[nodiscard]] static std::size_t getLastFrameCallCount();
+  static void writeChromeTrace(std::string_view path, std::size_t numFrames);
+
+ private:
+  // Record fields are atomic so that they can be read while the owner thread
+  // overwrites them
+  struct Slot {
+    // Index of the stored record plus one, or 0 while it is being written
+    std::atomic<std::uint64_t> sequence{};
+    std::atomic<const char*> name{};
+    std::atomic<const char*> fileName{};
+    std::atomic<const char*> functionName{};
+    std::atomic<std::uint_least32_t> line{};
+    std::atomic<std::uint64_t> frame{};
+    std::atomic<std::int64_t> start{};
+    std::atomic<std::int64_t> duration{};
+  };
+
+  struct ThreadBuffer {
+    static constexpr std::size_t capacity{std::size_t{1} << 16U};
+    std::array<Slot, capacity> slots{};
+    // Total number of records written. Only the owner thread writes to it
+    std::atomic<std::uint64_t> count{};
+    std::uint64_t countAtFrameStart{};
+    std::uint32_t threadID{};
+  };
+
+  static std::int64_t now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  static void record(const Record& record) noexcept {
+    thread_local ThreadBuffer* buffer{registerThread()};
+    const auto index{buffer->count.load(std::memory_order_relaxed)};
+    auto& slot{buffer->slots.at(index % ThreadBuffer::capacity)};
+
+    constexpr auto relaxed{std::memory_order_relaxed};
+    slot.sequence.store(0, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(record.name, relaxed);
+    slot.fileName.store(record.fileName, relaxed);
+    slot.functionName.store(record.functionName, relaxed);
+    slot.line.store(record.line, relaxed);
+    slot.frame.store(record.frame, relaxed);
+    slot.start.store(record.start, relaxed);
+    slot.duration.store(record.duration, relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+
+    buffer->count.store(index + 1, std::memory_order_release);
+  }
+
+  static bool load(const Slot& slot, std::uint64_t index,
+                   Record& record) noexcept;
+
+  static ThreadBuffer* registerThread();
+
+  inline static std::atomic<std::uint64_t> m_frame{};
+  static std::mutex m_registryMutex;
+  static std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+};
+
+#endif
@@ -13,17 +13,27 @@
 #include <imgui_impl_sdl.h>
 
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <regex>
+#include <span>
 #include <sstream>
 #include <string_view>
+#include <unordered_map>
 
 #include "SDL_events.h"
 #include "SDL_video.h"
 #include "abcg_application.hpp"
 #include "abcg_embeddedfonts.hpp"
+#include "abcg_profiler.hpp"
+#include "abcg_sampler.hpp"
 #include "abcg_string.hpp"
 
+#if defined(ABCG_GL_TRACE) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+// Number of frames exported when the OpenGL trace is written to a file
+constexpr std::size_t traceFrameCount{30};
+#endif
+
 void printShaderInfoLog(GLuint shader, std::string_view prefix) {
   GLint infoLogLength{};
   glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
@@ -48,6 +58,230 @@ void printProgramInfoLog(GLuint program) {
   }
 }
 
+std::string readShaderFile(std::string_view path, std::string_view type) {
+  std::stringstream source;
+  if (std::ifstream stream(path.data()); stream) {
+    source << stream.rdbuf();
+    stream.close();
+  } else {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to read {} shader file {}", type, path))};
+  }
+  return source.str();
+}
+
+#if !defined(__EMSCRIPTEN__)
+// Value of a uniform variable of the default block, saved across a reload
+struct SavedUniform {
+  GLenum type{};
+  std::array<GLfloat, 16> floats{};
+  std::array<GLint, 16> ints{};
+  std::array<GLuint, 16> uints{};
+};
+
+// Saved uniform variables and uniform block bindings of a program
+struct SavedUniforms {
+  std::unordered_map<std::string, SavedUniform> values;
+  std::unordered_map<std::string, GLint> blockBindings;
+};
+
+bool isFloatUniform(GLenum type) {
+  switch (type) {
+    case GL_FLOAT:
+    case GL_FLOAT_VEC2:
+    case GL_FLOAT_VEC3:
+    case GL_FLOAT_VEC4:
+    case GL_FLOAT_MAT2:
+    case GL_FLOAT_MAT3:
+    case GL_FLOAT_MAT4:
+    case GL_FLOAT_MAT2x3:
+    case GL_FLOAT_MAT2x4:
+    case GL_FLOAT_MAT3x2:
+    case GL_FLOAT_MAT3x4:
+    case GL_FLOAT_MAT4x2:
+    case GL_FLOAT_MAT4x3:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool isUnsignedUniform(GLenum type) {
+  return type == GL_UNSIGNED_INT || type == GL_UNSIGNED_INT_VEC2 ||
+         type == GL_UNSIGNED_INT_VEC3 || type == GL_UNSIGNED_INT_VEC4;
+}
+
+// Calls function(name, location, type) for each element of the uniform
+// variables of the default block
+template <typename Function>
+void forEachUniform(GLuint program, Function &&function) {
+  GLint numUniforms{};
+  abcg::glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numUniforms);
+  std::array<GLchar, 256> nameBuffer{};
+  for (GLuint index{}; index < static_cast<GLuint>(numUniforms); ++index) {
+    GLint blockIndex{};
+    abcg::glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX,
+                                &blockIndex);
+    if (blockIndex != -1) continue;
+
+    GLsizei length{};
+    GLint size{};
+    GLenum type{};
+    abcg::glGetActiveUniform(program, index,
+                             static_cast<GLsizei>(nameBuffer.size()), &length,
+                             &size, &type, nameBuffer.data());
+    std::string name{nameBuffer.data(), static_cast<std::size_t>(length)};
+    if (name.starts_with("gl_")) continue;
+    if (size == 1) {
+      function(name, abcg::glGetUniformLocation(program, name.c_str()), type);
+      continue;
+    }
+
+    // Arrays are reported as "name[0]"
+    if (name.ends_with("[0]")) name.resize(name.size() - 3);
+    for (GLint element{}; element < size; ++element) {
+      const auto elementName{fmt::format("{}[{}]", name, element)};
+      function(elementName,
+               abcg::glGetUniformLocation(program, elementName.c_str()), type);
+    }
+  }
+}
+
+SavedUniforms saveUniforms(GLuint program) {
+  SavedUniforms saved;
+  forEachUniform(
+      program, [&](const std::string &name, GLint location, GLenum type) {
+        if (location < 0) return;
+        SavedUniform value{.type = type};
+        if (isFloatUniform(type)) {
+          abcg::glGetUniformfv(program, location, value.floats.data());
+        } else if (isUnsignedUniform(type)) {
+          abcg::glGetUniformuiv(program, location, value.uints.data());
+        } else {
+          // Signed integers, booleans and samplers
+          abcg::glGetUniformiv(program, location, value.ints.data());
+        }
+        saved.values.emplace(name, value);
+      });
+
+  GLint numBlocks{};
+  abcg::glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &numBlocks);
+  std::array<GLchar, 256> nameBuffer{};
+  for (GLuint index{}; index < static_cast<GLuint>(numBlocks); ++index) {
+    GLsizei length{};
+    abcg::glGetActiveUniformBlockName(program, index,
+                                      static_cast<GLsizei>(nameBuffer.size()),
+                                      &length, nameBuffer.data());
+    GLint binding{};
+    abcg::glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_BINDING,
+                                    &binding);
+    saved.blockBindings.emplace(
+        std::string{nameBuffer.data(), static_cast<std::size_t>(length)},
+        binding);
+  }
+  return saved;
+}
+
+void setUniform(GLint location, const SavedUniform &value) {
+  const auto *floats{value.floats.data()};
+  const auto *ints{value.ints.data()};
+  const auto *uints{value.uints.data()};
+  switch (value.type) {
+    case GL_FLOAT:
+      abcg::glUniform1fv(location, 1, floats);
+      break;
+    case GL_FLOAT_VEC2:
+      abcg::glUniform2fv(location, 1, floats);
+      break;
+    case GL_FLOAT_VEC3:
+      abcg::glUniform3fv(location, 1, floats);
+      break;
+    case GL_FLOAT_VEC4:
+      abcg::glUniform4fv(location, 1, floats);
+      break;
+    case GL_FLOAT_MAT2:
+      abcg::glUniformMatrix2fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_FLOAT_MAT3:
+      abcg::glUniformMatrix3fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_FLOAT_MAT4:
+      abcg::glUniformMatrix4fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_FLOAT_MAT2x3:
+      abcg::glUniformMatrix2x3fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_FLOAT_MAT2x4:
+      abcg::glUniformMatrix2x4fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_FLOAT_MAT3x2:
+      abcg::glUniformMatrix3x2fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_FLOAT_MAT3x4:
+      abcg::glUniformMatrix3x4fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_FLOAT_MAT4x2:
+      abcg::glUniformMatrix4x2fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_FLOAT_MAT4x3:
+      abcg::glUniformMatrix4x3fv(location, 1, GL_FALSE, floats);
+      break;
+    case GL_INT_VEC2:
+    case GL_BOOL_VEC2:
+      abcg::glUniform2iv(location, 1, ints);
+      break;
+    case GL_INT_VEC3:
+    case GL_BOOL_VEC3:
+      abcg::glUniform3iv(location, 1, ints);
+      break;
+    case GL_INT_VEC4:
+    case GL_BOOL_VEC4:
+      abcg::glUniform4iv(location, 1, ints);
+      break;
+    case GL_UNSIGNED_INT:
+      abcg::glUniform1uiv(location, 1, uints);
+      break;
+    case GL_UNSIGNED_INT_VEC2:
+      abcg::glUniform2uiv(location, 1, uints);
+      break;
+    case GL_UNSIGNED_INT_VEC3:
+      abcg::glUniform3uiv(location, 1, uints);
+      break;
+    case GL_UNSIGNED_INT_VEC4:
+      abcg::glUniform4uiv(location, 1, uints);
+      break;
+    default:
+      // Signed integers, booleans and samplers
+      abcg::glUniform1iv(location, 1, ints);
+      break;
+  }
+}
+
+// Restores the saved values of the uniform variables that still exist with
+// the same type
+void restoreUniforms(GLuint program, const SavedUniforms &saved) {
+  GLint currentProgram{};
+  abcg::glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+  abcg::glUseProgram(program);
+  forEachUniform(
+      program, [&](const std::string &name, GLint location, GLenum type) {
+        const auto value{saved.values.find(name)};
+        if (location < 0 || value == saved.values.end() ||
+            value->second.type != type) {
+          return;
+        }
+        setUniform(location, value->second);
+      });
+  abcg::glUseProgram(static_cast<GLuint>(currentProgram));
+
+  for (const auto &[name, binding] : saved.blockBindings) {
+    const auto index{abcg::glGetUniformBlockIndex(program, name.c_str())};
+    if (index == GL_INVALID_INDEX) continue;
+    abcg::glUniformBlockBinding(program, index, static_cast<GLuint>(binding));
+  }
+}
+#endif
+
 ImVec4 ColorAlpha(const ImVec4 &color, float alpha) {
   return ImVec4(color.x, color.y, color.z, alpha);
 }
@@ -163,8 +397,21 @@ EM_BOOL abcg::fullscreenchangeCallback(
 
 abcg::OpenGLWindow::~OpenGLWindow() {
   if (m_window != nullptr) {
+    stopRenderThread();
+    m_uploadThread.stop();
+    m_frameCapture.stop();
+
     if (ImGui::GetCurrentContext() != nullptr) {
       terminateGL();
+      m_postProcessChain.terminate();
+      for (const auto &entry : m_hotReloadPrograms) {
+        glDeleteProgram(entry.pendingProgram);
+      }
+      opengl::releaseSamplers();
+      m_frameGPUTimer.reset();
+#if defined(ABCG_PROFILE)
+      Profiler::terminateGPU();
+#endif
       ImGui_ImplOpenGL3_Shutdown();
       ImGui_ImplSDL2_Shutdown();
       ImGui::DestroyContext();
@@ -202,6 +449,9 @@ void abcg::OpenGLWindow::setWindowSettings(
   }
 
   m_windowSettings = windowSettings;
+  m_frameScheduler.setMode(windowSettings.frameMode, windowSettings.targetFPS,
+                           windowSettings.hiddenFPS);
+  m_fixedTimestep.setRate(windowSettings.fixedUpdateRate);
 }
 
 void abcg::OpenGLWindow::handleEvent([[maybe_unused]] SDL_Event &event) {}
@@ -236,7 +486,28 @@ void abcg::OpenGLWindow::paintUI() {
                      static_cast<int>(offset), label.c_str(), 0.0f,
                      *std::max_element(frames.begin(), frames.end()) * 2,
                      ImVec2(static_cast<float>(frames.size()), 50));
+#if defined(ABCG_GL_TRACE) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+    ImGui::Text("GL calls: %zu", OpenGLTracer::getLastFrameCallCount());
+#endif
+    if (m_openGLSettings.dynamicResolution) {
+      ImGui::Text("Render scale: %.0f%%",
+                  static_cast<double>(m_renderScale.load()) * 100.0);
+    }
+#if defined(ABCG_GL_STATE_CACHE)
+    ImGui::Text("GL state: %zu issued, %zu elided",
+                m_glStateCacheCounters.issued, m_glStateCacheCounters.elided);
+#endif
+#if defined(ABCG_PROFILE)
+    const auto profilerPosition{
+        ImVec2(5, ImGui::GetWindowPos().y + ImGui::GetWindowSize().y + 5)};
+#endif
     ImGui::End();
+
+#if defined(ABCG_PROFILE)
+    // Timeline of the last frame, below the FPS counter
+    ImGui::SetNextWindowPos(profilerPosition, ImGuiCond_FirstUseEver);
+    Profiler::drawWindow();
+#endif
   }
 
   // Fullscreen button
@@ -281,37 +552,69 @@ void abcg::OpenGLWindow::resizeGL(int width, int height) {
 
 void abcg::OpenGLWindow::terminateGL() {}
 
+/**
+ * @brief Custom handler for recording a frame.
+ *
+ * Called on the main thread after paintUI. The commands recorded in the
+ * command list of the packet are executed after paintGL, on the thread that
+ * owns the OpenGL context.
+ *
+ * If abcg::WindowSettings::renderThread is true, paintGL, resizeGL and the
+ * recorded commands run on the render thread while the main thread handles
+ * the events and records the next frame. State shared by both threads must
+ * then be passed through the packet (camera, world matrices and
+ * abcg::FramePacket::userData), and paintGL and resizeGL should only read
+ * the packet returned by abcg::OpenGLWindow::getFramePacket and state owned
+ * by the render thread. paintUI, recordFrame and updateFixed must not make
+ * OpenGL calls in that case.
+ *
+ * @param packet Packet of the frame. The command list and the world matrices
+ * are empty, and the viewport size and times are already set.
+ */
+void abcg::OpenGLWindow::recordFrame([[maybe_unused]] FramePacket &packet) {}
+
+/**
+ * @brief Custom handler for fixed-timestep updates.
+ *
+ * Called abcg::WindowSettings::fixedUpdateRate times per second of frame
+ * time, in bursts at the beginning of each frame, so that simulations do not
+ * depend on the frame rate. paintGL can interpolate between the last two
+ * states with abcg::OpenGLWindow::getInterpolationAlpha.
+ *
+ * If abcg::WindowSettings::fixedUpdateOnWorker is true, the updates run on a
+ * worker thread while the current frame is being swapped, and paintGL of the
+ * next frame renders their result. The updates must not make OpenGL calls in
+ * that case.
+ *
+ * @param deltaTime Fixed time step, in seconds.
+ */
+void abcg::OpenGLWindow::updateFixed([[maybe_unused]] double deltaTime) {}
+
 GLuint abcg::OpenGLWindow::createProgramFromFile(
     std::string_view pathToVertexShader,
     std::string_view pathToFragmentShader) {
-  std::stringstream vertexShaderSource;
-  if (std::ifstream stream(pathToVertexShader.data()); stream) {
-    vertexShaderSource << stream.rdbuf();
-    stream.close();
-  } else {
-    throw abcg::Exception{abcg::Exception::Runtime(fmt::format(
-        "Failed to read vertex shader file {}", pathToVertexShader))};
+  const auto program{
+      createProgramFromString(readShaderFile(pathToVertexShader, "vertex"),
+                              readShaderFile(pathToFragmentShader, "fragment"))};
+
+  // Keep track of the source files so that the program can be rebuilt when
+  // they change
+  if (m_shaderWatcher != nullptr) {
+    m_shaderWatcher->addPath(pathToVertexShader);
+    m_shaderWatcher->addPath(pathToFragmentShader);
+    m_hotReloadPrograms.push_back(
+        {.program = program,
+         .vertexShaderPath = FileWatcher::normalizePath(pathToVertexShader),
+         .fragmentShaderPath =
+             FileWatcher::normalizePath(pathToFragmentShader)});
   }
 
-  std::stringstream fragmentShaderSource;
-  if (std::ifstream stream(pathToFragmentShader.data()); stream) {
-    fragmentShaderSource << stream.rdbuf();
-    stream.close();
-  } else {
-    throw abcg::Exception{abcg::Exception::Runtime(fmt::format(
-        "Failed to read fragment shader file {}", pathToFragmentShader))};
-  }
-
-  return createProgramFromString(vertexShaderSource.str(),
-                                 fragmentShaderSource.str());
+  return program;
 }
 
-GLuint abcg::OpenGLWindow::createProgramFromString(
-    std::string_view vertexShaderSource,
-    std::string_view fragmentShaderSource) {
-  using namespace std::string_literals;
-
-  std::string vsSource{abcg::trimCopy(std::string{vertexShaderSource})};
+std::string abcg::OpenGLWindow::prepareVertexShaderSource(
+    std::string_view source) const {
+  std::string vsSource{abcg::trimCopy(std::string{source})};
 #if defined(__EMSCRIPTEN__) || defined(__APPLE__)
   // Remove version header, if any
   vsSource =
@@ -323,8 +626,12 @@ GLuint abcg::OpenGLWindow::createProgramFromString(
   if (!vsSource.starts_with("#version"))
     vsSource = m_GLSLVersion + "\n\n" + vsSource;
 #endif
+  return vsSource;
+}
 
-  std::string fsSource{abcg::trimCopy(std::string{fragmentShaderSource})};
+std::string abcg::OpenGLWindow::prepareFragmentShaderSource(
+    std::string_view source) const {
+  std::string fsSource{abcg::trimCopy(std::string{source})};
 #if defined(__EMSCRIPTEN__) || defined(__APPLE__)
   // Remove version header, if any
   fsSource =
@@ -348,6 +655,14 @@ GLuint abcg::OpenGLWindow::createProgramFromString(
     fsSource = m_GLSLVersion + "\n\n" + fsSource;
   }
 #endif
+  return fsSource;
+}
+
+GLuint abcg::OpenGLWindow::createProgramFromString(
+    std::string_view vertexShaderSource,
+    std::string_view fragmentShaderSource) {
+  const auto vsSource{prepareVertexShaderSource(vertexShaderSource)};
+  const auto fsSource{prepareFragmentShaderSource(fragmentShaderSource)};
 
   GLint compileStatus{};
   GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
@@ -393,14 +708,300 @@ GLuint abcg::OpenGLWindow::createProgramFromString(
   return shaderProgram;
 }
 
+/**
+ * @brief Rebuilds the programs whose shader files have been modified.
+ *
+ * Called at the beginning of each frame when
+ * abcg::OpenGLSettings::shaderHotReload is enabled. Modified programs are
+ * compiled and linked into a separate program object. If the driver supports
+ * parallel shader compilation, the new program is polled on the following
+ * frames until it is ready, so the frame is never stalled. On success, the
+ * binary of the new program is loaded into the original program object with
+ * glProgramBinary, so the program name held by the application remains valid
+ * without linking again, and the values of the uniform variables and the
+ * uniform block bindings are carried over. If the binary cannot be loaded,
+ * the original program keeps its previous executable and is not linked
+ * again. Only if the driver exposes no program binary format are the new
+ * shaders attached to the original program, which is then linked again. On
+ * error, the old program is kept and the information log is printed.
+ */
+void abcg::OpenGLWindow::reloadShaders() {
+#if !defined(__EMSCRIPTEN__)
+  if (m_shaderWatcher == nullptr) return;
+
+  // Start building the programs that use the modified files
+  for (const auto &path : m_shaderWatcher->poll()) {
+    for (auto &entry : m_hotReloadPrograms) {
+      if (entry.vertexShaderPath != path && entry.fragmentShaderPath != path)
+        continue;
+
+      // Discard any build in flight for this program
+      glDeleteProgram(entry.pendingProgram);
+      entry.pendingProgram = 0;
+
+      std::string vsSource;
+      std::string fsSource;
+      try {
+        vsSource = prepareVertexShaderSource(
+            readShaderFile(entry.vertexShaderPath, "vertex"));
+        fsSource = prepareFragmentShaderSource(
+            readShaderFile(entry.fragmentShaderPath, "fragment"));
+      } catch (const abcg::Exception &exception) {
+        fmt::print("{}", exception.what());
+        continue;
+      }
+
+      fmt::print("Reloading {} and {}\n", entry.vertexShaderPath,
+                 entry.fragmentShaderPath);
+
+      // Statuses are not queried here so that the compilation can proceed in
+      // the background
+      GLuint vertexShader{glCreateShader(GL_VERTEX_SHADER)};
+      const char *vsSourceConstChar{vsSource.c_str()};
+      glShaderSource(vertexShader, 1, &vsSourceConstChar, nullptr);
+      glCompileShader(vertexShader);
+
+      GLuint fragmentShader{glCreateShader(GL_FRAGMENT_SHADER)};
+      const char *fsSourceConstChar{fsSource.c_str()};
+      glShaderSource(fragmentShader, 1, &fsSourceConstChar, nullptr);
+      glCompileShader(fragmentShader);
+
+      entry.pendingProgram = glCreateProgram();
+      glAttachShader(entry.pendingProgram, vertexShader);
+      glAttachShader(entry.pendingProgram, fragmentShader);
+      if (m_programBinary) {
+        glProgramParameteri(entry.pendingProgram,
+                            GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      }
+      glLinkProgram(entry.pendingProgram);
+
+      // Shaders are released together with the program
+      glDeleteShader(fragmentShader);
+      glDeleteShader(vertexShader);
+    }
+  }
+
+  // Swap in the programs that finished building
+  for (auto &entry : m_hotReloadPrograms) {
+    if (entry.pendingProgram == 0) continue;
+
+    if (m_parallelShaderCompile) {
+      GLint completionStatus{};
+      glGetProgramiv(entry.pendingProgram, GL_COMPLETION_STATUS_KHR,
+                     &completionStatus);
+      if (completionStatus == GL_FALSE) continue;
+    }
+
+    std::array<GLuint, 2> newShaders{};
+    GLsizei numNewShaders{};
+    glGetAttachedShaders(entry.pendingProgram,
+                         static_cast<GLsizei>(newShaders.size()),
+                         &numNewShaders, newShaders.data());
+
+    GLint linkStatus{};
+    glGetProgramiv(entry.pendingProgram, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE || glIsProgram(entry.program) == GL_FALSE) {
+      for (const auto shader : std::span{newShaders.data(),
+                                         static_cast<size_t>(numNewShaders)}) {
+        GLint compileStatus{};
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+        if (compileStatus == GL_FALSE) printShaderInfoLog(shader, "Shader");
+      }
+      printProgramInfoLog(entry.pendingProgram);
+      fmt::print("Failed to reload shaders, keeping the previous program\n");
+      glDeleteProgram(entry.pendingProgram);
+      entry.pendingProgram = 0;
+      continue;
+    }
+
+    const auto savedUniforms{saveUniforms(entry.program)};
+    if (m_programBinary) {
+      GLint binaryLength{};
+      glGetProgramiv(entry.pendingProgram, GL_PROGRAM_BINARY_LENGTH,
+                     &binaryLength);
+      std::vector<std::byte> binary(static_cast<std::size_t>(binaryLength));
+      GLenum binaryFormat{};
+      glGetProgramBinary(entry.pendingProgram, binaryLength, nullptr,
+                         &binaryFormat, binary.data());
+
+      // A failed glProgramBinary discards the executable of the program it is
+      // given, so the binary is checked on a scratch program first. If it is
+      // rejected, the original program is left untouched
+      const auto scratchProgram{glCreateProgram()};
+      glProgramBinary(scratchProgram, binaryFormat, binary.data(),
+                      binaryLength);
+      GLint binaryLoaded{};
+      glGetProgramiv(scratchProgram, GL_LINK_STATUS, &binaryLoaded);
+      glDeleteProgram(scratchProgram);
+      if (binaryLoaded == GL_FALSE) {
+        fmt::print(
+            "Failed to load the program binary, keeping the previous "
+            "program\n");
+        glDeleteProgram(entry.pendingProgram);
+        entry.pendingProgram = 0;
+        continue;
+      }
+
+      // Load the executable of the new program into the original one
+      glProgramBinary(entry.program, binaryFormat, binary.data(),
+                      binaryLength);
+    } else {
+      // Without a program binary format, the shaders of the original program
+      // are replaced and it is linked again. The link cannot fail since the
+      // same shaders were just linked successfully
+      std::array<GLuint, 2> oldShaders{};
+      GLsizei numOldShaders{};
+      glGetAttachedShaders(entry.program,
+                           static_cast<GLsizei>(oldShaders.size()),
+                           &numOldShaders, oldShaders.data());
+      for (const auto shader :
+           std::span{oldShaders.data(), static_cast<size_t>(numOldShaders)}) {
+        glDetachShader(entry.program, shader);
+      }
+      for (const auto shader :
+           std::span{newShaders.data(), static_cast<size_t>(numNewShaders)}) {
+        glAttachShader(entry.program, shader);
+      }
+      glLinkProgram(entry.program);
+    }
+    restoreUniforms(entry.program, savedUniforms);
+
+    glDeleteProgram(entry.pendingProgram);
+    entry.pendingProgram = 0;
+  }
+#endif
+}
+
 std::string abcg::OpenGLWindow::getAssetsPath() { return m_assetsPath; }
 
 double abcg::OpenGLWindow::getDeltaTime() const { return m_lastDeltaTime; }
 
+#if defined(ABCG_GL_STATE_CACHE)
+/**
+ * @brief Returns the number of state-setting calls issued and elided by the
+ * OpenGL state cache in the last frame.
+ */
+abcg::OpenGLStateCacheCounters abcg::OpenGLWindow::getGLStateCacheCounters()
+    const {
+  return m_glStateCacheCounters;
+}
+#endif
+
 double abcg::OpenGLWindow::getElapsedTime() const {
   return m_windowStartTime.elapsed();
 }
 
+/**
+ * @brief Returns the time step of abcg::OpenGLWindow::updateFixed, in
+ * seconds.
+ */
+double abcg::OpenGLWindow::getFixedDeltaTime() const {
+  return m_fixedTimestep.getStep();
+}
+
+/**
+ * @brief Returns the packet of the frame being rendered.
+ *
+ * Only valid in paintGL. The packet holds the viewport size, delta time and
+ * interpolation factor of the main thread when the frame was recorded, and
+ * the state set by abcg::OpenGLWindow::recordFrame.
+ */
+const abcg::FramePacket &abcg::OpenGLWindow::getFramePacket() const {
+  return *m_renderPacket;
+}
+
+/**
+ * @brief Returns the upload thread of the window.
+ *
+ * Runs uploads in the background if abcg::OpenGLSettings::uploadThread is
+ * true. Otherwise, uploads run at the beginning of the next frame. Ready
+ * functions are called at the beginning of a frame, before paintGL, on the
+ * thread that renders.
+ */
+abcg::UploadThread &abcg::OpenGLWindow::getUploadThread() noexcept {
+  return m_uploadThread;
+}
+
+/**
+ * @brief Returns the post-processing chain of the window.
+ *
+ * Passes can be added in initializeGL. While a pass is enabled, paintGL and
+ * the commands of recordFrame render to an offscreen framebuffer, and the
+ * passes write the result to the default framebuffer before the UI is
+ * drawn. Holds an FXAA pass if abcg::OpenGLSettings::fxaa is true.
+ */
+abcg::PostProcessChain &abcg::OpenGLWindow::getPostProcessChain() noexcept {
+  return m_postProcessChain;
+}
+
+/**
+ * @brief Returns the width at which the scene is rendered.
+ *
+ * Only valid in paintGL and in the commands of recordFrame, which should
+ * use it instead of the viewport width for glViewport and for anything
+ * that maps gl_FragCoord. It is smaller than the viewport width while
+ * abcg::OpenGLSettings::dynamicResolution lowers the resolution. Windows
+ * that use it set abcg::OpenGLSettings::supportsRenderScale.
+ */
+int abcg::OpenGLWindow::getRenderWidth() const noexcept {
+  return m_postProcessChain.getRenderWidth();
+}
+
+/**
+ * @brief Returns the height at which the scene is rendered.
+ *
+ * See abcg::OpenGLWindow::getRenderWidth.
+ */
+int abcg::OpenGLWindow::getRenderHeight() const noexcept {
+  return m_postProcessChain.getRenderHeight();
+}
+
+/**
+ * @brief Starts writing the rendered frames to a directory, as a numbered
+ * image sequence.
+ *
+ * The frames are captured after paintGL, without the UI, starting with the
+ * next frame. Reading back a frame does not stall the rendering, and images
+ * are encoded on worker threads. Not available with Emscripten.
+ *
+ * @param directory Output directory, created if needed.
+ * @param format Image format.
+ */
+void abcg::OpenGLWindow::startCapture(const std::filesystem::path &directory,
+                                      CaptureFormat format) {
+  m_captureRequested = true;
+  m_captureDirectory = directory;
+  m_captureFormat = format;
+}
+
+/**
+ * @brief Stops the capture started with abcg::OpenGLWindow::startCapture.
+ *
+ * The frames in flight are written when the next frame is rendered.
+ */
+void abcg::OpenGLWindow::stopCapture() { m_captureRequested = false; }
+
+/**
+ * @brief Returns the interpolation factor in [0, 1) between the states before
+ * and after the last call to abcg::OpenGLWindow::updateFixed.
+ *
+ * The factor is the fraction of a time step that has elapsed but has not been
+ * simulated yet.
+ */
+double abcg::OpenGLWindow::getInterpolationAlpha() const {
+  return m_fixedTimestep.getAlpha();
+}
+
+/**
+ * @brief Requests a new frame when abcg::WindowSettings::frameMode is
+ * abcg::FrameMode::OnDemand.
+ *
+ * Events received by the window already trigger a redraw. This is meant for
+ * changes that do not come from events, such as animations (by calling it in
+ * paintGL) or data produced by other threads. Thread-safe.
+ */
+void abcg::OpenGLWindow::requestRedraw() { m_frameScheduler.requestRedraw(); }
+
 void abcg::OpenGLWindow::toggleFullscreen() {
 #if defined(__EMSCRIPTEN__)
   EM_ASM(toggleFullscreen(););
@@ -431,11 +1032,23 @@ void abcg::OpenGLWindow::toggleFullscreen() {
 
 void abcg::OpenGLWindow::handleEvent(SDL_Event &event, bool &done) {
   ImGui_ImplSDL2_ProcessEvent(&event);
+  m_frameScheduler.notifyEvent();
 
   if (event.window.windowID != m_windowID) return;
 
   if (event.type == SDL_WINDOWEVENT) {
     switch (event.window.event) {
+      case SDL_WINDOWEVENT_HIDDEN:
+      case SDL_WINDOWEVENT_MINIMIZED:
+        // Offscreen windows are never displayed, but must not be throttled
+        m_frameScheduler.setVisible(m_windowSettings.headless);
+        break;
+      case SDL_WINDOWEVENT_SHOWN:
+      case SDL_WINDOWEVENT_RESTORED:
+      case SDL_WINDOWEVENT_MAXIMIZED:
+      case SDL_WINDOWEVENT_EXPOSED:
+        m_frameScheduler.setVisible(true);
+        break;
       case SDL_WINDOWEVENT_CLOSE:
         done = true;
         break;
@@ -446,7 +1059,7 @@ void abcg::OpenGLWindow::handleEvent(SDL_Event &event, bool &done) {
             (newWidth != m_viewportWidth || newHeight != m_viewportHeight)) {
           m_viewportWidth = newWidth;
           m_viewportHeight = newHeight;
-          resizeGL(newWidth, newHeight);
+          if (!m_renderThreadRunning) resizeGL(newWidth, newHeight);
         }
       } break;
       case SDL_WINDOWEVENT_RESIZED: {
@@ -464,7 +1077,9 @@ void abcg::OpenGLWindow::handleEvent(SDL_Event &event, bool &done) {
 #endif
         m_viewportWidth = event.window.data1;
         m_viewportHeight = event.window.data2;
-        resizeGL(event.window.data1, event.window.data2);
+        if (!m_renderThreadRunning) {
+          resizeGL(event.window.data1, event.window.data2);
+        }
       } break;
     }
   }
@@ -479,6 +1094,18 @@ void abcg::OpenGLWindow::handleEvent(SDL_Event &event, bool &done) {
 #endif
         toggleFullscreen();
     }
+#if defined(ABCG_GL_TRACE) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+    if (event.key.keysym.sym == SDLK_F9) {
+      const auto path{fmt::format("abcg_trace_{}.json", SDL_GetTicks())};
+      try {
+        OpenGLTracer::writeChromeTrace(path, traceFrameCount);
+        fmt::print("OpenGL trace of the last {} frames written to {}\n",
+                   traceFrameCount, path);
+      } catch (const abcg::Exception &exception) {
+        fmt::print("{}", exception.what());
+      }
+    }
+#endif
   }
 
   // Won't pass mouse events to the application if ImGUI has captured the
@@ -502,11 +1129,22 @@ void abcg::OpenGLWindow::handleEvent(SDL_Event &event, bool &done) {
   if (useCustomEventHandler) handleEvent(event);
 }
 
-void abcg::OpenGLWindow::initialize(std::string_view basePath) {
+void abcg::OpenGLWindow::initialize(std::string_view assetsPath) {
   m_deltaTime.restart();
   m_windowStartTime.restart();
 
-  m_assetsPath = std::string(basePath) + "/assets/";
+  m_frameScheduler.initialize();
+  if (m_windowSettings.headless) {
+    // There is no input to wait for
+    m_windowSettings.frameMode = FrameMode::Continuous;
+  }
+  m_frameScheduler.setMode(m_windowSettings.frameMode,
+                           m_windowSettings.targetFPS,
+                           m_windowSettings.hiddenFPS);
+  m_fixedTimestep.setRate(m_windowSettings.fixedUpdateRate);
+  m_fixedUpdateTimer.restart();
+
+  m_assetsPath = assetsPath;
 
 #if defined(__EMSCRIPTEN__)
   if (m_openGLSettings.preserveWebGLDrawingBuffer) {
@@ -540,16 +1178,25 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
   m_GLSLVersion +=
       fmt::format("#version {:d}{:02d}", majorVersion, minorVersion * 10);
 
+#if defined(ABCG_GL_DEBUG_OUTPUT) && !defined(__EMSCRIPTEN__) && \
+    !defined(__APPLE__)
+  // Debug contexts are required to reliably generate KHR_debug messages
+  const int debugContextFlag{SDL_GL_CONTEXT_DEBUG_FLAG};
+#else
+  const int debugContextFlag{0};
+#endif
+
   switch (profile) {
     case OpenGLProfile::Core:
       SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS,
-                          SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+                          SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG |
+                              debugContextFlag);
       SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
                           SDL_GL_CONTEXT_PROFILE_CORE);
       m_GLSLVersion += " core";
       break;
     case OpenGLProfile::Compatibility:
-      SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+      SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, debugContextFlag);
       SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
                           SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
       m_GLSLVersion += " compatibility";
@@ -557,7 +1204,7 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
     case OpenGLProfile::ES:
       majorVersion = 3;
       minorVersion = 0;
-      SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+      SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, debugContextFlag);
       SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
                           SDL_GL_CONTEXT_PROFILE_ES);
       m_GLSLVersion = "#version 300 es";
@@ -583,12 +1230,17 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
     SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 0);
   }
 
+  // With the offscreen video driver, the window is backed by an EGL pbuffer
+  // surface of fixed size, which is the default framebuffer
+  Uint32 windowFlags{SDL_WINDOW_OPENGL};
+  if (!m_windowSettings.headless) windowFlags |= SDL_WINDOW_RESIZABLE;
+
   // Create window with graphics context
   while (true) {
     m_window = SDL_CreateWindow(m_windowSettings.title.c_str(),
                                 SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
                                 m_windowSettings.width, m_windowSettings.height,
-                                SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+                                windowFlags);
     if (m_window == nullptr && m_openGLSettings.samples > 0) {
       // Try again, but this time with multisampling disabled
       m_openGLSettings.samples = 0;
@@ -622,7 +1274,15 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
 #endif
 
 #if !defined(__EMSCRIPTEN__)
-  if (GLenum err{glewInit()}; GLEW_OK != err) {
+  GLenum err{glewInit()};
+#if defined(GLEW_ERROR_NO_GLX_DISPLAY)
+  // GLEW built for GLX loads the core functions of an EGL context, but fails
+  // to find a GLX display afterwards
+  if (m_windowSettings.headless && err == GLEW_ERROR_NO_GLX_DISPLAY) {
+    err = GLEW_OK;
+  }
+#endif
+  if (GLEW_OK != err) {
     std::string header{"Failed to initialize OpenGL loader: "};
     const auto *const message{
         reinterpret_cast<const char *>(glewGetErrorString(err))};
@@ -635,6 +1295,45 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
   fmt::print("OpenGL renderer: {}\n", glGetString(GL_RENDERER));
   fmt::print("OpenGL version.: {}\n", glGetString(GL_VERSION));
   fmt::print("GLSL version...: {}\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
+  if (m_windowSettings.headless) {
+    fmt::print("Headless.......: {}x{} ({} video driver)\n",
+               m_windowSettings.width, m_windowSettings.height,
+               SDL_GetCurrentVideoDriver());
+  }
+
+#if defined(ABCG_GL_DEBUG_OUTPUT) && !defined(__EMSCRIPTEN__) && \
+    !defined(__APPLE__)
+  enableDebugOutput(m_openGLSettings.synchronousDebugOutput);
+#endif
+
+#if !defined(__EMSCRIPTEN__)
+  if (m_openGLSettings.uploadThread) {
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    auto *uploadContext{SDL_GL_CreateContext(m_window)};
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    if (uploadContext == nullptr) {
+      throw abcg::Exception{
+          abcg::Exception::SDL("SDL_GL_CreateContext failed")};
+    }
+    // Creating a context makes it current
+    SDL_GL_MakeCurrent(m_window, m_GLContext);
+    m_uploadThread.start(m_window, uploadContext);
+  }
+#endif
+
+#if !defined(__EMSCRIPTEN__)
+  if (m_openGLSettings.shaderHotReload) {
+    m_shaderWatcher = std::make_unique<FileWatcher>();
+    m_parallelShaderCompile =
+        isExtensionSupported("GL_KHR_parallel_shader_compile") ||
+        isExtensionSupported("GL_ARB_parallel_shader_compile");
+    GLint numBinaryFormats{};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+    m_programBinary = numBinaryFormats > 0;
+    fmt::print("Shader hot reload enabled{}\n",
+               m_parallelShaderCompile ? " (parallel compile)" : "");
+  }
+#endif
 
   // Setup Dear ImGui context
   IMGUI_CHECKVERSION();
@@ -668,6 +1367,23 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
     throw abcg::Exception{abcg::Exception::Runtime("Failed to load font file")};
   }
 
+#if defined(ABCG_PROFILE)
+  Profiler::initializeGPU();
+#endif
+
+  m_postProcessChain.initialize(m_GLSLVersion);
+  if (m_openGLSettings.fxaa) m_postProcessChain.addFXAAPass();
+  m_postProcessChain.setSharpness(m_openGLSettings.upscaleSharpness);
+  if (m_openGLSettings.dynamicResolution) {
+    m_resolutionScaler.setBudget(m_openGLSettings.gpuFrameBudget);
+    m_resolutionScaler.setScaleRange(m_openGLSettings.minRenderScale, 1.0f);
+    if (GPUTimer::isSupported()) {
+      m_frameGPUTimer = std::make_unique<GPUTimer>();
+    } else {
+      fmt::print("Dynamic resolution unavailable: no GPU timer queries\n");
+    }
+  }
+
   initializeGL();
 
   if (io.DisplaySize.x >= 0 && io.DisplaySize.y >= 0) {
@@ -682,30 +1398,57 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
 }
 
 void abcg::OpenGLWindow::paint() {
-  SDL_GL_MakeCurrent(m_window, m_GLContext);
+  if (m_renderThreadRunning && m_renderThreadFailed) {
+    stopRenderThread();
+    std::rethrow_exception(m_renderThreadException);
+  }
 
-#if defined(__EMSCRIPTEN__)
-  // Force window size in windowed mode
-  EmscriptenFullscreenChangeEvent fullscreenStatus{};
-  emscripten_get_fullscreen_status(&fullscreenStatus);
-  if (fullscreenStatus.isFullscreen == EM_FALSE) {
-    SDL_SetWindowSize(m_window, m_windowSettings.width,
-                      m_windowSettings.height);
+  const auto updateFixedFunction{[this](double deltaTime) {
+    ABCG_PROFILE_SCOPE("updateFixed");
+    updateFixed(deltaTime);
+  }};
+  m_fixedTimestep.advance(m_fixedUpdateTimer.restart());
+  // With the render thread, this thread only runs the simulation, so the
+  // updates always run inline
+  if (!m_windowSettings.fixedUpdateOnWorker || m_renderThreadRunning) {
+    m_fixedTimestep.update(updateFixedFunction);
   }
+
+  if (m_renderThreadRunning) {
+    // Wait until the render thread starts rendering the previous packet, so
+    // that this thread is never more than one frame ahead
+    {
+      ABCG_PROFILE_SCOPE("waitRenderThread");
+      m_framePackets.waitConsumed();
+    }
+    recordFramePacket(m_framePackets.getWriteBuffer());
+    m_framePackets.publish();
+  } else {
+    SDL_GL_MakeCurrent(m_window, m_GLContext);
+
+#if defined(__EMSCRIPTEN__)
+    // Force window size in windowed mode
+    EmscriptenFullscreenChangeEvent fullscreenStatus{};
+    emscripten_get_fullscreen_status(&fullscreenStatus);
+    if (fullscreenStatus.isFullscreen == EM_FALSE) {
+      SDL_SetWindowSize(m_window, m_windowSettings.width,
+                        m_windowSettings.height);
+    }
 #endif
 
-  ImGui_ImplOpenGL3_NewFrame();
-  ImGui_ImplSDL2_NewFrame();
-  ImGui::NewFrame();
-  paintUI();
-  ImGui::Render();
-  paintGL();
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    auto &packet{m_framePackets.getWriteBuffer()};
+    recordFramePacket(packet);
+    renderFramePacket(packet);
 
-  if (m_openGLSettings.preserveWebGLDrawingBuffer) {
-    glFinish();
-  } else {
-    SDL_GL_SwapWindow(m_window);
+    // Run the updates while the GPU finishes the frame. They are rendered in
+    // the next frame
+    if (m_windowSettings.fixedUpdateOnWorker) {
+      m_fixedTimestep.launch(updateFixedFunction);
+    }
+
+    presentFrame();
+
+    m_fixedTimestep.wait();
   }
 
   // Cap to 480 Hz
@@ -713,4 +1456,222 @@ void abcg::OpenGLWindow::paint() {
     m_lastDeltaTime = m_deltaTime.restart();
   } else
     m_lastDeltaTime = 0.0;
+}
+
+/**
+ * @brief Builds the UI and records the draws of a frame.
+ *
+ * Runs on the main thread. When the packet is rendered on the render thread,
+ * the ImGui draw data is copied into the packet.
+ */
+void abcg::OpenGLWindow::recordFramePacket(FramePacket &packet) {
+#if defined(ABCG_GL_STATE_CACHE)
+  // Counters written when this packet was last rendered
+  m_glStateCacheCounters = packet.glStateCacheCounters;
+#endif
+
+  // The ImGui renderer objects were created before the render thread was
+  // started, so that its new frame function does not need the context
+  if (!m_renderThreadRunning) ImGui_ImplOpenGL3_NewFrame();
+  ImGui_ImplSDL2_NewFrame();
+  ImGui::NewFrame();
+  {
+    ABCG_PROFILE_SCOPE("paintUI");
+    paintUI();
+  }
+  {
+    ABCG_PROFILE_SCOPE("ImGui::Render");
+    ImGui::Render();
+  }
+
+  packet.frame = m_frameCount++;
+  packet.viewportWidth = m_viewportWidth;
+  packet.viewportHeight = m_viewportHeight;
+  packet.deltaTime = m_lastDeltaTime;
+  packet.interpolationAlpha = m_fixedTimestep.getAlpha();
+  packet.capture = m_captureRequested;
+  packet.captureFormat = m_captureFormat;
+  if (packet.captureDirectory != m_captureDirectory) {
+    packet.captureDirectory = m_captureDirectory;
+  }
+  packet.commandList.clear();
+  packet.transforms.clear();
+  {
+    ABCG_PROFILE_SCOPE("recordFrame");
+    recordFrame(packet);
+  }
+
+  if (m_renderThreadRunning) {
+    packet.drawSnapshot.capture(*ImGui::GetDrawData());
+    packet.drawData = packet.drawSnapshot.get();
+  } else {
+    packet.drawData = ImGui::GetDrawData();
+  }
+}
+
+/**
+ * @brief Issues the OpenGL commands of a frame.
+ *
+ * Runs on the thread that owns the OpenGL context.
+ */
+void abcg::OpenGLWindow::renderFramePacket(FramePacket &packet) {
+#if defined(ABCG_GL_TRACE) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  OpenGLTracer::beginFrame();
+#endif
+
+  reloadShaders();
+  {
+    ABCG_PROFILE_SCOPE("uploads");
+    m_uploadThread.poll();
+  }
+
+  // Resize events are handled on the main thread, which cannot call resizeGL
+  // while the render thread owns the context
+  if (m_renderThreadRunning &&
+      (packet.viewportWidth != m_renderViewportWidth ||
+       packet.viewportHeight != m_renderViewportHeight)) {
+    m_renderViewportWidth = packet.viewportWidth;
+    m_renderViewportHeight = packet.viewportHeight;
+    resizeGL(packet.viewportWidth, packet.viewportHeight);
+  }
+
+  if (packet.capture != m_frameCapture.isCapturing()) {
+    if (packet.capture) {
+      m_frameCapture.start(packet.captureDirectory, packet.captureFormat);
+    } else {
+      m_frameCapture.stop();
+    }
+  }
+
+  // Results of the timer queries arrive a few frames late
+  if (m_openGLSettings.dynamicResolution && m_frameGPUTimer != nullptr) {
+    if (const auto gpuTime{m_frameGPUTimer->takeLatestResult()}) {
+      m_resolutionScaler.update(*gpuTime);
+      m_postProcessChain.setRenderScale(m_resolutionScaler.getScale());
+      m_renderScale = m_resolutionScaler.getScale();
+    }
+  }
+
+  m_renderPacket = &packet;
+  if (m_frameGPUTimer != nullptr) m_frameGPUTimer->begin();
+  m_postProcessChain.begin(packet.viewportWidth, packet.viewportHeight);
+  {
+    ABCG_PROFILE_SCOPE("paintGL");
+    ABCG_PROFILE_GPU_SCOPE("paintGL");
+    paintGL();
+    if (packet.commandList.size() > 0) {
+      // Copied, as the packet and its memory are reused by the main thread
+      m_frameRenderQueue.submit(packet.commandList);
+      m_frameRenderQueue.execute();
+    }
+  }
+  m_postProcessChain.end();
+  {
+    // Captured before the UI is drawn
+    ABCG_PROFILE_SCOPE("capture");
+    m_frameCapture.capture(packet.viewportWidth, packet.viewportHeight);
+  }
+  {
+    ABCG_PROFILE_SCOPE("ImGui draw");
+    ABCG_PROFILE_GPU_SCOPE("ImGui draw");
+    ImGui_ImplOpenGL3_RenderDrawData(packet.drawData);
+  }
+  if (m_frameGPUTimer != nullptr) m_frameGPUTimer->end();
+
+#if defined(ABCG_GL_STATE_CACHE)
+  // The ImGui renderer changes the state through calls that bypass the cache
+  OpenGLStateCache::current().invalidate();
+  packet.glStateCacheCounters = OpenGLStateCache::current().takeCounters();
+#endif
+}
+
+void abcg::OpenGLWindow::presentFrame() {
+  {
+    ABCG_PROFILE_SCOPE("swap");
+    if (m_openGLSettings.preserveWebGLDrawingBuffer) {
+      glFinish();
+    } else {
+      SDL_GL_SwapWindow(m_window);
+    }
+  }
+
+#if defined(ABCG_PROFILE)
+  Profiler::endFrame();
+#endif
+}
+
+/**
+ * @brief Moves the OpenGL context to a new render thread that renders the
+ * packets published by abcg::OpenGLWindow::paint.
+ *
+ * Must be called on the main thread after abcg::OpenGLWindow::initialize.
+ */
+void abcg::OpenGLWindow::startRenderThread() {
+#if !defined(__EMSCRIPTEN__)
+  if (m_renderThreadRunning) return;
+
+  // Create the ImGui renderer objects while the context is current
+  ImGui_ImplOpenGL3_NewFrame();
+
+  m_renderViewportWidth = m_viewportWidth;
+  m_renderViewportHeight = m_viewportHeight;
+  m_renderThreadFailed = false;
+  m_renderThreadRunning = true;
+
+  SDL_GL_MakeCurrent(m_window, nullptr);
+  m_renderThread = std::thread{&OpenGLWindow::renderLoop, this};
+#endif
+}
+
+/**
+ * @brief Stops the render thread and makes the OpenGL context current on the
+ * calling thread again.
+ *
+ * Does nothing if the render thread is not running.
+ */
+void abcg::OpenGLWindow::stopRenderThread() {
+  if (!m_renderThreadRunning) return;
+
+  // Publish the write buffer to wake up the render thread
+  m_stopRenderThread = true;
+  m_framePackets.publish();
+  m_renderThread.join();
+  m_stopRenderThread = false;
+  m_renderThreadRunning = false;
+  // Otherwise the packet published above would still be pending, and a
+  // restarted render thread would render it again
+  m_framePackets.reset();
+
+  SDL_GL_MakeCurrent(m_window, m_GLContext);
+#if defined(ABCG_GL_STATE_CACHE)
+  // The state was changed by the render thread
+  OpenGLStateCache::current().invalidate();
+#endif
+}
+
+void abcg::OpenGLWindow::renderLoop() {
+  SDL_GL_MakeCurrent(m_window, m_GLContext);
+#if defined(ABCG_GL_STATE_CACHE)
+  // The state was changed by the main thread during initialization
+  OpenGLStateCache::current().invalidate();
+#endif
+
+  while (true) {
+    m_framePackets.waitPublished();
+    if (m_stopRenderThread) break;
+    m_framePackets.acquire();
+
+    // After a failure, packets are still consumed so that the main thread
+    // does not block before rethrowing the exception
+    if (m_renderThreadFailed) continue;
+    try {
+      renderFramePacket(m_framePackets.getReadBuffer());
+      presentFrame();
+    } catch (...) {
+      m_renderThreadException = std::current_exception();
+      m_renderThreadFailed = true;
+    }
+  }
+
+  SDL_GL_MakeCurrent(m_window, nullptr);
 }
\ No newline at end of file
@@ -10,10 +10,27 @@
 #ifndef ABCG_OPENGLWINDOW_HPP_
 #define ABCG_OPENGLWINDOW_HPP_
 
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "abcg_elapsedtimer.hpp"
+#include "abcg_filewatcher.hpp"
+#include "abcg_fixedtimestep.hpp"
+#include "abcg_framecapture.hpp"
+#include "abcg_framepacket.hpp"
+#include "abcg_framescheduler.hpp"
+#include "abcg_gputimer.hpp"
 #include "abcg_openglfunctions.hpp"
+#include "abcg_postprocesschain.hpp"
+#include "abcg_renderqueue.hpp"
+#include "abcg_resolutionscaler.hpp"
+#include "abcg_triplebuffer.hpp"
+#include "abcg_uploadthread.hpp"
 
 namespace abcg {
 enum class OpenGLProfile;
@@ -43,6 +60,30 @@ struct alignas(32) abcg::OpenGLSettings {
   int samples{0};
   bool vsync{false};
   bool preserveWebGLDrawingBuffer{false};
+  bool shaderHotReload{false};
+  // Create a shared context for OpenGLWindow::getUploadThread
+  bool uploadThread{false};
+  // Antialias with an FXAA pass of OpenGLWindow::getPostProcessChain. Use
+  // with samples set to 0
+  bool fxaa{false};
+  // Lower the resolution of paintGL while the GPU time of a frame exceeds
+  // gpuFrameBudget seconds, down to minRenderScale times the viewport size.
+  // See OpenGLWindow::getRenderWidth
+  bool dynamicResolution{false};
+  // paintGL renders at OpenGLWindow::getRenderWidth x getRenderHeight, so
+  // the --dynamic-resolution command-line option can enable
+  // dynamicResolution. The option is ignored otherwise
+  bool supportsRenderScale{false};
+  double gpuFrameBudget{1.0 / 60.0};
+  float minRenderScale{0.5f};
+  // Strength of the sharpening applied when upscaling, from 0 (bilinear) to
+  // 1
+  float upscaleSharpness{0.5f};
+  // With ABCG_GL_DEBUG_OUTPUT, report the call site of each debug message.
+  // This serializes the driver and records the call site of every OpenGL
+  // call. Set to false to let the driver report messages asynchronously, by
+  // message id only, and to skip the recording
+  bool synchronousDebugOutput{true};
 };
 
 struct alignas(64) abcg::WindowSettings {
@@ -51,6 +92,21 @@ struct alignas(64) abcg::WindowSettings {
   bool showFPS{true};
   bool showFullscreenButton{true};
   std::string title{"ABCg Window"};
+  FrameMode frameMode{FrameMode::Continuous};
+  double targetFPS{60.0};
+  // Frame rate limit while the window is hidden or minimized (0 to stop)
+  double hiddenFPS{1.0};
+  // Number of calls to OpenGLWindow::updateFixed per second
+  double fixedUpdateRate{60.0};
+  // Run OpenGLWindow::updateFixed on a worker thread, overlapping the buffer
+  // swap of the current frame
+  bool fixedUpdateOnWorker{false};
+  // Render offscreen at width x height, without a visible window. Set by the
+  // --headless command-line option
+  bool headless{false};
+  // Render on a dedicated thread that owns the OpenGL context, one frame
+  // behind the main thread. See OpenGLWindow::recordFrame
+  bool renderThread{false};
 };
 
 /**
@@ -77,8 +133,10 @@ class abcg::OpenGLWindow {
   virtual void initializeGL();
   virtual void paintGL();
   virtual void paintUI();
+  virtual void recordFrame(FramePacket& packet);
   virtual void resizeGL(int width, int height);
   virtual void terminateGL();
+  virtual void updateFixed(double deltaTime);
 
   [[nodiscard]] GLuint createProgramFromFile(
       std::string_view pathToVertexShader,
@@ -89,12 +147,38 @@ class abcg::OpenGLWindow {
   std::string getAssetsPath();
   [[nodiscard]] double getDeltaTime() const;
   [[nodiscard]] double getElapsedTime() const;
+  [[nodiscard]] double getFixedDeltaTime() const;
+  [[nodiscard]] const FramePacket& getFramePacket() const;
+  [[nodiscard]] double getInterpolationAlpha() const;
+  [[nodiscard]] PostProcessChain& getPostProcessChain() noexcept;
+  [[nodiscard]] int getRenderWidth() const noexcept;
+  [[nodiscard]] int getRenderHeight() const noexcept;
+#if defined(ABCG_GL_STATE_CACHE)
+  [[nodiscard]] OpenGLStateCacheCounters getGLStateCacheCounters() const;
+#endif
+  [[nodiscard]] UploadThread& getUploadThread() noexcept;
   void toggleFullscreen();
+  void requestRedraw();
+  void startCapture(const std::filesystem::path& directory,
+                    CaptureFormat format = CaptureFormat::PNG);
+  void stopCapture();
 
  private:
   void handleEvent(SDL_Event& event, bool& done);
-  void initialize(std::string_view basePath);
+  void initialize(std::string_view assetsPath);
   void paint();
+  void recordFramePacket(FramePacket& packet);
+  void renderFramePacket(FramePacket& packet);
+  void presentFrame();
+  void startRenderThread();
+  void stopRenderThread();
+  void renderLoop();
+
+  [[nodiscard]] std::string prepareVertexShaderSource(
+      std::string_view source) const;
+  [[nodiscard]] std::string prepareFragmentShaderSource(
+      std::string_view source) const;
+  void reloadShaders();
 
   WindowSettings m_windowSettings{};
   OpenGLSettings m_openGLSettings{};
@@ -113,6 +197,66 @@ class abcg::OpenGLWindow {
   ElapsedTimer m_windowStartTime;
   double m_lastDeltaTime{0.0};
 
+  FrameScheduler m_frameScheduler;
+
+  ElapsedTimer m_fixedUpdateTimer;
+  FixedTimestep m_fixedTimestep;
+
+  // Packets recorded by the main thread. Without the render thread, only the
+  // write buffer is used
+  TripleBuffer<FramePacket> m_framePackets;
+  FramePacket* m_renderPacket{};
+  RenderQueue m_frameRenderQueue;
+  std::uint64_t m_frameCount{};
+
+  // Render thread
+  std::thread m_renderThread;
+  bool m_renderThreadRunning{};
+  std::atomic<bool> m_stopRenderThread{};
+  std::atomic<bool> m_renderThreadFailed{};
+  std::exception_ptr m_renderThreadException;
+  // Viewport size last passed to resizeGL by the render thread
+  int m_renderViewportWidth{};
+  int m_renderViewportHeight{};
+
+  UploadThread m_uploadThread;
+
+  // Frame capture. The requested state is passed to the thread that renders
+  // in the frame packets
+  FrameCapture m_frameCapture;
+  bool m_captureRequested{};
+  CaptureFormat m_captureFormat{};
+  std::filesystem::path m_captureDirectory;
+
+  // Passes applied to the output of paintGL and recordFrame
+  PostProcessChain m_postProcessChain;
+  // Render scale of the chain, driven by the GPU time of the frames when
+  // OpenGLSettings::dynamicResolution is true
+  ResolutionScaler m_resolutionScaler;
+  std::atomic<float> m_renderScale{1.0f};
+
+  // GPU time of each frame, measured in benchmark mode and with dynamic
+  // resolution
+  std::unique_ptr<GPUTimer> m_frameGPUTimer;
+
+  // Shader hot reload
+  struct HotReloadProgram {
+    GLuint program{};
+    std::string vertexShaderPath;
+    std::string fragmentShaderPath;
+    GLuint pendingProgram{};
+  };
+  std::unique_ptr<FileWatcher> m_shaderWatcher;
+  std::vector<HotReloadProgram> m_hotReloadPrograms;
+  bool m_parallelShaderCompile{};
+  // Reloaded programs are swapped in with glProgramBinary
+  bool m_programBinary{};
+
+#if defined(ABCG_GL_STATE_CACHE)
+  // State cache counters of the last frame
+  OpenGLStateCacheCounters m_glStateCacheCounters{};
+#endif
+
   friend Application;
 
 #if defined(__EMSCRIPTEN__)
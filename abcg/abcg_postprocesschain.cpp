@@ -0,0 +1,471 @@
+/**
+ * @file abcg_postprocesschain.cpp
+ * @brief Definition of abcg::PostProcessChain class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_postprocesschain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+#include "abcg_exception.hpp"
+#include "abcg_openglfunctions.hpp"
+#include "abcg_profiler.hpp"
+
+namespace {
+// Fullscreen triangle. The texture coordinates of the viewport are in
+// [0, 1]
+constexpr std::string_view vertexShaderSource{R"glsl(
+out vec2 fragTexCoord;
+
+void main() {
+  vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  fragTexCoord = position;
+  gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+})glsl"};
+
+constexpr std::string_view fragmentShaderHeader{R"glsl(
+uniform sampler2D inputTex;
+uniform vec2 texelSize;
+
+in vec2 fragTexCoord;
+
+out vec4 outColor;
+)glsl"};
+
+// Fast approximate antialiasing. Blurs along the edge direction estimated
+// from the luma of the four diagonal neighbors, and falls back to a
+// narrower blur when the wider one leaves the local luma range
+constexpr std::string_view fxaaShaderSource{R"glsl(
+const float reduceMin = 1.0 / 128.0;
+const float reduceMul = 1.0 / 8.0;
+const float spanMax = 8.0;
+
+float luma(vec3 color) { return dot(color, vec3(0.299, 0.587, 0.114)); }
+
+vec3 sampleAt(vec2 offset) {
+  return texture(inputTex, fragTexCoord + offset).rgb;
+}
+
+void main() {
+  vec4 colorM = texture(inputTex, fragTexCoord);
+  float lumaNW = luma(sampleAt(vec2(-1.0, -1.0) * texelSize));
+  float lumaNE = luma(sampleAt(vec2(1.0, -1.0) * texelSize));
+  float lumaSW = luma(sampleAt(vec2(-1.0, 1.0) * texelSize));
+  float lumaSE = luma(sampleAt(vec2(1.0, 1.0) * texelSize));
+  float lumaM = luma(colorM.rgb);
+  float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+  float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+  vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)),
+                        (lumaNW + lumaSW) - (lumaNE + lumaSE));
+  float directionReduce =
+      max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * reduceMul),
+          reduceMin);
+  float inverseMin =
+      1.0 / (min(abs(direction.x), abs(direction.y)) + directionReduce);
+  direction = clamp(direction * inverseMin, vec2(-spanMax), vec2(spanMax)) *
+              texelSize;
+
+  vec3 colorA = 0.5 * (sampleAt(direction * (1.0 / 3.0 - 0.5)) +
+                       sampleAt(direction * (2.0 / 3.0 - 0.5)));
+  vec3 colorB = colorA * 0.5 + 0.25 * (sampleAt(direction * -0.5) +
+                                       sampleAt(direction * 0.5));
+  float lumaB = luma(colorB);
+  outColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? colorA : colorB,
+                  colorM.a);
+})glsl"};
+
+// Upscales the rendered region of the scene, at the bottom left of
+// inputTex, to the whole viewport. With a positive sharpness, adds the
+// difference between the bilinear sample and its four neighbors, limited to
+// their range so that edges do not get halos
+constexpr std::string_view upscaleShaderSource{R"glsl(
+uniform vec2 inputScale;
+uniform float sharpness;
+
+vec3 sampleAt(vec2 coord) {
+  // The texels outside the rendered region are stale
+  return texture(inputTex, min(coord, inputScale - 0.5 * texelSize)).rgb;
+}
+
+void main() {
+  vec2 coord = fragTexCoord * inputScale;
+  vec4 color = texture(inputTex, min(coord, inputScale - 0.5 * texelSize));
+  if (sharpness > 0.0) {
+    vec3 north = sampleAt(coord + vec2(0.0, texelSize.y));
+    vec3 south = sampleAt(coord - vec2(0.0, texelSize.y));
+    vec3 east = sampleAt(coord + vec2(texelSize.x, 0.0));
+    vec3 west = sampleAt(coord - vec2(texelSize.x, 0.0));
+    vec3 minColor = min(color.rgb, min(min(north, south), min(east, west)));
+    vec3 maxColor = max(color.rgb, max(max(north, south), max(east, west)));
+    vec3 detail = color.rgb - 0.25 * (north + south + east + west);
+    color.rgb = clamp(color.rgb + sharpness * detail, minColor, maxColor);
+  }
+  outColor = color;
+})glsl"};
+
+GLuint compileShader(GLenum type, const std::string &source,
+                     std::string_view name) {
+  const auto shader{abcg::glCreateShader(type)};
+  const auto *sourceData{source.c_str()};
+  abcg::glShaderSource(shader, 1, &sourceData, nullptr);
+  abcg::glCompileShader(shader);
+
+  GLint compileStatus{};
+  abcg::glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+  if (compileStatus == 0) {
+    GLint infoLogLength{};
+    abcg::glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+    std::vector<GLchar> infoLog(static_cast<std::size_t>(infoLogLength) + 1);
+    abcg::glGetShaderInfoLog(shader, infoLogLength, nullptr, infoLog.data());
+    abcg::glDeleteShader(shader);
+    throw abcg::Exception{abcg::Exception::Runtime(
+        "Failed to compile " + std::string{name} +
+        " shader: " + std::string{infoLog.data()})};
+  }
+  return shader;
+}
+}  // namespace
+
+abcg::PostProcessChain::~PostProcessChain() { terminate(); }
+
+/**
+ * @brief Compiles the shaders of the chain.
+ *
+ * Must be called with the OpenGL context current, before adding passes.
+ *
+ * @param GLSLVersion Version directive of the shaders, e.g.
+ * `#version 300 es`.
+ *
+ * @throw abcg::Exception if the shaders fail to build.
+ */
+void abcg::PostProcessChain::initialize(std::string_view GLSLVersion) {
+  terminate();
+
+  m_GLSLVersion = GLSLVersion;
+  m_GLSLVersion += '\n';
+  // Texture coordinates need more than the 10-bit mantissa of mediump
+  if (GLSLVersion.ends_with("es")) {
+    m_GLSLVersion += "precision highp float;\n";
+  }
+
+  m_vertexShader = compileShader(
+      GL_VERTEX_SHADER, m_GLSLVersion + std::string{vertexShaderSource},
+      "post-processing vertex");
+  abcg::glGenVertexArrays(1, &m_VAO);
+
+  m_upscalePass = createPass(upscaleShaderSource);
+  m_inputScaleLocation =
+      abcg::glGetUniformLocation(m_upscalePass.program, "inputScale");
+  m_sharpnessLocation =
+      abcg::glGetUniformLocation(m_upscalePass.program, "sharpness");
+}
+
+/**
+ * @brief Deletes the OpenGL objects and removes all passes.
+ *
+ * Must be called with the OpenGL context current.
+ */
+void abcg::PostProcessChain::terminate() {
+  if (m_vertexShader == 0) return;
+
+  for (const auto &pass : m_passes) {
+    abcg::glDeleteProgram(pass.program);
+  }
+  m_passes.clear();
+  m_enabledCount = 0;
+  abcg::glDeleteProgram(m_upscalePass.program);
+  m_upscalePass = {};
+
+  deleteTarget(m_sceneTarget);
+  deleteTarget(m_pingPongTarget);
+  abcg::glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+  abcg::glDeleteVertexArrays(1, &m_VAO);
+  abcg::glDeleteShader(m_vertexShader);
+  m_depthRenderbuffer = 0;
+  m_VAO = 0;
+  m_vertexShader = 0;
+  m_width = 0;
+  m_height = 0;
+  m_began = false;
+}
+
+/**
+ * @brief Adds an enabled pass after the existing passes.
+ *
+ * Must be called with the OpenGL context current, after
+ * abcg::PostProcessChain::initialize.
+ *
+ * @param fragmentShaderSource Fragment shader of the pass, without the
+ * version directive and the declarations prepended by the chain.
+ *
+ * @return Index of the pass.
+ *
+ * @throw abcg::Exception if the shader fails to build.
+ */
+abcg::PostProcessChain::Pass
+abcg::PostProcessChain::addPass(std::string_view fragmentShaderSource) {
+  if (m_vertexShader == 0) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        "Post-processing chain used before initialization")};
+  }
+
+  m_passes.push_back(createPass(fragmentShaderSource));
+  ++m_enabledCount;
+  return m_passes.size() - 1;
+}
+
+/**
+ * @brief Adds a fast approximate antialiasing (FXAA) pass.
+ *
+ * Smooths the edges of the image at the cost of a few texture reads per
+ * pixel, instead of rendering every pixel with multiple samples. Best added
+ * after the passes that change the colors, e.g. tone mapping.
+ *
+ * @return Index of the pass.
+ */
+abcg::PostProcessChain::Pass abcg::PostProcessChain::addFXAAPass() {
+  return addPass(fxaaShaderSource);
+}
+
+void abcg::PostProcessChain::setEnabled(Pass pass, bool enabled) {
+  auto &data{m_passes.at(pass)};
+  if (data.enabled == enabled) return;
+  data.enabled = enabled;
+  if (enabled) {
+    ++m_enabledCount;
+  } else {
+    --m_enabledCount;
+  }
+}
+
+bool abcg::PostProcessChain::isEnabled(Pass pass) const {
+  return m_passes.at(pass).enabled;
+}
+
+/**
+ * @brief Sets the fraction of the width and height of the viewport at which
+ * the scene is rendered.
+ *
+ * Below 1, the scene is rendered to the bottom left of the offscreen
+ * framebuffer and upscaled to the viewport before the other passes. Takes
+ * effect on the next call to abcg::PostProcessChain::begin.
+ *
+ * @param scale Render scale, clamped to (0, 1].
+ */
+void abcg::PostProcessChain::setRenderScale(float scale) noexcept {
+  m_renderScale = std::clamp(scale, minRenderScale, 1.0f);
+}
+
+/**
+ * @brief Sets the strength of the sharpening applied while upscaling.
+ *
+ * @param sharpness 0 for a bilinear upscale, up to 1 for the strongest
+ * sharpening.
+ */
+void abcg::PostProcessChain::setSharpness(float sharpness) noexcept {
+  m_sharpness = std::clamp(sharpness, 0.0f, 1.0f);
+}
+
+/**
+ * @brief Binds the offscreen framebuffer that the frame is rendered to, and
+ * sets the viewport to the render size.
+ *
+ * Does nothing if no pass is enabled and the render scale is 1. The
+ * framebuffers are resized when the size of the viewport changes.
+ *
+ * @param width Width of the viewport.
+ * @param height Height of the viewport.
+ */
+void abcg::PostProcessChain::begin(int width, int height) {
+  if (width <= 0 || height <= 0) return;
+
+  const auto scaled{[this](int size) {
+    return std::max(
+        static_cast<int>(std::lround(static_cast<float>(size) * m_renderScale)),
+        1);
+  }};
+  m_renderWidth = scaled(width);
+  m_renderHeight = scaled(height);
+  const auto upscale{m_renderWidth != width || m_renderHeight != height};
+  if (m_enabledCount == 0 && !upscale) return;
+
+  if (width != m_width || height != m_height) resize(width, height);
+  if (m_enabledCount + (upscale ? 1 : 0) > 1 &&
+      m_pingPongTarget.framebuffer == 0) {
+    createTarget(m_pingPongTarget);
+  }
+
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, m_sceneTarget.framebuffer);
+  abcg::glViewport(0, 0, m_renderWidth, m_renderHeight);
+  m_began = true;
+}
+
+/**
+ * @brief Runs the upscale and the enabled passes, the last one writing to
+ * the default framebuffer.
+ *
+ * Does nothing if abcg::PostProcessChain::begin did not bind the offscreen
+ * framebuffer. Resets the current program, vertex array, and the texture and
+ * sampler bound to texture unit 0.
+ */
+void abcg::PostProcessChain::end() {
+  if (!m_began) return;
+  m_began = false;
+  ABCG_PROFILE_SCOPE("PostProcessChain::end");
+  ABCG_PROFILE_GPU_SCOPE("post-processing");
+
+  std::array<GLint, 4> viewport{};
+  abcg::glGetIntegerv(GL_VIEWPORT, viewport.data());
+  const auto depthTest{abcg::glIsEnabled(GL_DEPTH_TEST)};
+  const auto cullFace{abcg::glIsEnabled(GL_CULL_FACE)};
+  const auto blend{abcg::glIsEnabled(GL_BLEND)};
+  const auto scissorTest{abcg::glIsEnabled(GL_SCISSOR_TEST)};
+  const auto stencilTest{abcg::glIsEnabled(GL_STENCIL_TEST)};
+  abcg::glDisable(GL_DEPTH_TEST);
+  abcg::glDisable(GL_CULL_FACE);
+  abcg::glDisable(GL_BLEND);
+  abcg::glDisable(GL_SCISSOR_TEST);
+  abcg::glDisable(GL_STENCIL_TEST);
+  abcg::glViewport(0, 0, m_width, m_height);
+
+  abcg::glBindVertexArray(m_VAO);
+  abcg::glActiveTexture(GL_TEXTURE0);
+  abcg::glBindSampler(0, 0);
+
+  const auto width{static_cast<float>(m_width)};
+  const auto height{static_cast<float>(m_height)};
+  const auto upscale{m_renderWidth != m_width || m_renderHeight != m_height};
+  const auto *input{&m_sceneTarget};
+  const auto *output{&m_pingPongTarget};
+  auto remaining{m_enabledCount + (upscale ? 1 : 0)};
+  const auto runPass{[&](const PassData &pass) {
+    --remaining;
+    abcg::glBindFramebuffer(GL_FRAMEBUFFER,
+                            remaining == 0 ? 0 : output->framebuffer);
+    abcg::glUseProgram(pass.program);
+    abcg::glUniform2f(pass.texelSizeLocation, 1.0f / width, 1.0f / height);
+    abcg::glBindTexture(GL_TEXTURE_2D, input->colorTexture);
+    abcg::glDrawArrays(GL_TRIANGLES, 0, 3);
+    std::swap(input, output);
+  }};
+
+  if (upscale) {
+    abcg::glUseProgram(m_upscalePass.program);
+    abcg::glUniform2f(m_inputScaleLocation,
+                      static_cast<float>(m_renderWidth) / width,
+                      static_cast<float>(m_renderHeight) / height);
+    abcg::glUniform1f(m_sharpnessLocation, m_sharpness);
+    runPass(m_upscalePass);
+  }
+  for (const auto &pass : m_passes) {
+    if (pass.enabled) runPass(pass);
+  }
+
+  abcg::glBindTexture(GL_TEXTURE_2D, 0);
+  abcg::glBindVertexArray(0);
+  abcg::glUseProgram(0);
+
+  abcg::glViewport(viewport.at(0), viewport.at(1), viewport.at(2),
+                   viewport.at(3));
+  if (depthTest == GL_TRUE) abcg::glEnable(GL_DEPTH_TEST);
+  if (cullFace == GL_TRUE) abcg::glEnable(GL_CULL_FACE);
+  if (blend == GL_TRUE) abcg::glEnable(GL_BLEND);
+  if (scissorTest == GL_TRUE) abcg::glEnable(GL_SCISSOR_TEST);
+  if (stencilTest == GL_TRUE) abcg::glEnable(GL_STENCIL_TEST);
+}
+
+abcg::PostProcessChain::PassData
+abcg::PostProcessChain::createPass(std::string_view fragmentShaderSource) {
+  const auto fragmentShader{compileShader(
+      GL_FRAGMENT_SHADER,
+      m_GLSLVersion + std::string{fragmentShaderHeader} +
+          std::string{fragmentShaderSource},
+      "post-processing fragment")};
+
+  PassData pass;
+  pass.program = abcg::glCreateProgram();
+  abcg::glAttachShader(pass.program, m_vertexShader);
+  abcg::glAttachShader(pass.program, fragmentShader);
+  abcg::glLinkProgram(pass.program);
+  abcg::glDetachShader(pass.program, m_vertexShader);
+  abcg::glDeleteShader(fragmentShader);
+
+  GLint linkStatus{};
+  abcg::glGetProgramiv(pass.program, GL_LINK_STATUS, &linkStatus);
+  if (linkStatus == 0) {
+    GLint infoLogLength{};
+    abcg::glGetProgramiv(pass.program, GL_INFO_LOG_LENGTH, &infoLogLength);
+    std::vector<GLchar> infoLog(static_cast<std::size_t>(infoLogLength) + 1);
+    abcg::glGetProgramInfoLog(pass.program, infoLogLength, nullptr,
+                              infoLog.data());
+    abcg::glDeleteProgram(pass.program);
+    throw abcg::Exception{abcg::Exception::Runtime(
+        "Failed to link post-processing program: " +
+        std::string{infoLog.data()})};
+  }
+
+  abcg::glUseProgram(pass.program);
+  abcg::glUniform1i(abcg::glGetUniformLocation(pass.program, "inputTex"), 0);
+  abcg::glUseProgram(0);
+  pass.texelSizeLocation =
+      abcg::glGetUniformLocation(pass.program, "texelSize");
+  return pass;
+}
+
+void abcg::PostProcessChain::createTarget(Target &target) const {
+  abcg::glGenTextures(1, &target.colorTexture);
+  abcg::glBindTexture(GL_TEXTURE_2D, target.colorTexture);
+  abcg::glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, m_width, m_height);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  abcg::glBindTexture(GL_TEXTURE_2D, 0);
+
+  abcg::glGenFramebuffers(1, &target.framebuffer);
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+  abcg::glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, target.colorTexture, 0);
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void abcg::PostProcessChain::deleteTarget(Target &target) {
+  abcg::glDeleteFramebuffers(1, &target.framebuffer);
+  abcg::glDeleteTextures(1, &target.colorTexture);
+  target = {};
+}
+
+void abcg::PostProcessChain::resize(int width, int height) {
+  m_width = width;
+  m_height = height;
+
+  deleteTarget(m_sceneTarget);
+  deleteTarget(m_pingPongTarget);
+  createTarget(m_sceneTarget);
+
+  // Same format as the default framebuffer, so that its depth can be copied
+  // with glBlitFramebuffer (e.g. by abcg::HiZBuffer)
+  abcg::glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+  abcg::glGenRenderbuffers(1, &m_depthRenderbuffer);
+  abcg::glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+  abcg::glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width,
+                              height);
+  abcg::glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, m_sceneTarget.framebuffer);
+  abcg::glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                                  GL_RENDERBUFFER, m_depthRenderbuffer);
+  if (abcg::glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+      GL_FRAMEBUFFER_COMPLETE) {
+    abcg::glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    throw abcg::Exception{abcg::Exception::Runtime(
+        "Post-processing framebuffer is incomplete")};
+  }
+  abcg::glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
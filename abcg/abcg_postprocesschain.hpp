@@ -0,0 +1,149 @@
+/**
+ * @file abcg_postprocesschain.hpp
+ * @brief abcg::PostProcessChain header file.
+ *
+ * Declaration of abcg::PostProcessChain class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_POSTPROCESSCHAIN_HPP_
+#define ABCG_POSTPROCESSCHAIN_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class PostProcessChain;
+}  // namespace abcg
+
+/**
+ * @brief abcg::PostProcessChain class.
+ *
+ * Sequence of fullscreen passes applied to the rendered frame before the UI
+ * is drawn.
+ *
+ * While at least one pass is enabled, abcg::PostProcessChain::begin binds an
+ * offscreen framebuffer with a color texture and a depth/stencil
+ * renderbuffer of the size of the viewport, so that paintGL renders into it
+ * unchanged. abcg::PostProcessChain::end then runs the enabled passes in the
+ * order they were added. Each pass reads the output of the previous one, and
+ * the last pass writes to the default framebuffer. With no enabled pass and
+ * a render scale of 1, both functions do nothing and the frame is rendered
+ * directly to the default framebuffer.
+ *
+ * With a render scale below 1 (see abcg::PostProcessChain::setRenderScale),
+ * the scene is rendered to a smaller region of the offscreen framebuffer,
+ * of abcg::PostProcessChain::getRenderWidth by
+ * abcg::PostProcessChain::getRenderHeight pixels, and an internal pass
+ * upscales it to the viewport, with optional sharpening, before the other
+ * passes. The framebuffers keep the size of the viewport, so changing the
+ * scale does not allocate memory.
+ *
+ * The fragment shader of a pass is given without the version directive.
+ * The chain prepends the version used by the window and these
+ * declarations:
+ * - `uniform sampler2D inputTex`: output of the previous pass, sampled with
+ *   linear filtering and clamped to the edges;
+ * - `uniform vec2 texelSize`: size of a texel of inputTex, in texture
+ *   coordinates;
+ * - `in vec2 fragTexCoord`: texture coordinates of the fragment;
+ * - `out vec4 outColor`: color written by the pass.
+ *
+ * abcg::OpenGLWindow owns a chain, which adds an FXAA pass if
+ * abcg::OpenGLSettings::fxaa is true. Post-process antialiasing replaces
+ * multisampling, as the offscreen framebuffer has a single sample.
+ */
+class abcg::PostProcessChain {
+ public:
+  using Pass = std::size_t;
+
+  static constexpr float minRenderScale{0.25f};
+
+  PostProcessChain() = default;
+  ~PostProcessChain();
+
+  PostProcessChain(const PostProcessChain&) = delete;
+  PostProcessChain(PostProcessChain&&) = delete;
+  PostProcessChain& operator=(const PostProcessChain&) = delete;
+  PostProcessChain& operator=(PostProcessChain&&) = delete;
+
+  void initialize(std::string_view GLSLVersion);
+  void terminate();
+
+  Pass addPass(std::string_view fragmentShaderSource);
+  Pass addFXAAPass();
+  void setEnabled(Pass pass, bool enabled);
+  [[nodiscard]] bool isEnabled(Pass pass) const;
+  /**
+   * @brief Returns the program of a pass, e.g. to set its own uniform
+   * variables.
+   */
+  [[nodiscard]] GLuint getProgram(Pass pass) const {
+    return m_passes.at(pass).program;
+  }
+  [[nodiscard]] bool isActive() const noexcept {
+    return m_enabledCount > 0 || m_renderScale < 1.0f;
+  }
+
+  void setRenderScale(float scale) noexcept;
+  [[nodiscard]] float getRenderScale() const noexcept { return m_renderScale; }
+  void setSharpness(float sharpness) noexcept;
+  /**
+   * @brief Returns the size at which the scene is rendered, as of the last
+   * call to abcg::PostProcessChain::begin.
+   */
+  [[nodiscard]] int getRenderWidth() const noexcept { return m_renderWidth; }
+  [[nodiscard]] int getRenderHeight() const noexcept { return m_renderHeight; }
+
+  void begin(int width, int height);
+  void end();
+
+ private:
+  struct PassData {
+    GLuint program{};
+    GLint texelSizeLocation{-1};
+    bool enabled{true};
+  };
+
+  // Framebuffer with a single color texture
+  struct Target {
+    GLuint framebuffer{};
+    GLuint colorTexture{};
+  };
+
+  [[nodiscard]] PassData createPass(std::string_view fragmentShaderSource);
+  void createTarget(Target& target) const;
+  void deleteTarget(Target& target);
+  void resize(int width, int height);
+
+  std::string m_GLSLVersion;
+  GLuint m_vertexShader{};
+  GLuint m_VAO{};
+  std::vector<PassData> m_passes;
+  std::size_t m_enabledCount{};
+
+  // Upscale from the render size to the size of the viewport
+  PassData m_upscalePass;
+  GLint m_inputScaleLocation{-1};
+  GLint m_sharpnessLocation{-1};
+  float m_renderScale{1.0f};
+  float m_sharpness{0.5f};
+  int m_renderWidth{};
+  int m_renderHeight{};
+
+  // The scene is rendered to the first target, which also alternates with
+  // the second as the input and output of the intermediate passes
+  Target m_sceneTarget;
+  Target m_pingPongTarget;
+  GLuint m_depthRenderbuffer{};
+  int m_width{};
+  int m_height{};
+  bool m_began{};
+};
+
+#endif
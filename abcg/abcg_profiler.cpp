@@ -0,0 +1,330 @@
+/**
+ * @file abcg_profiler.cpp
+ * @brief Definition of abcg::Profiler class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#if defined(ABCG_PROFILE)
+
+#include "abcg_profiler.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "abcg_gputimer.hpp"
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+using Event = abcg::Profiler::Event;
+
+// Number of frames whose GPU queries are in flight
+constexpr std::size_t gpuFrameLatency{3};
+
+std::int64_t now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// GPU scopes issued in one frame, with two GL_TIMESTAMP queries per scope
+struct GPUFrame {
+  std::vector<GLuint> queries;
+  std::vector<Event> events;
+  // Index of the query issued last. The end query of an outer scope is
+  // issued after the queries of its nested scopes
+  std::size_t lastQuery{};
+};
+
+struct ProfilerState {
+  std::mutex mutex;
+  std::int64_t frameStart{now()};
+  std::vector<Event> events;
+  std::vector<Event> lastFrameEvents;
+  std::int64_t lastFrameDuration{};
+  std::atomic<std::uint32_t> threadCount{};
+
+  // Guarded by the mutex, as the render thread may resolve them
+  std::vector<Event> lastGPUFrameEvents;
+  std::int64_t lastGPUFrameDuration{};
+
+  // Only accessed by the thread that owns the OpenGL context
+  bool gpuEnabled{};
+  std::array<GPUFrame, gpuFrameLatency> gpuFrames;
+  std::size_t gpuFrame{};
+  std::uint32_t gpuDepth{};
+};
+
+ProfilerState &state() {
+  static ProfilerState profilerState;
+  return profilerState;
+}
+
+thread_local std::uint32_t threadDepth{};
+
+std::uint32_t threadIndex() {
+  thread_local const std::uint32_t index{state().threadCount++};
+  return index;
+}
+
+// Resolves the GPU scopes of the oldest frame in flight, which is about to
+// be reused. Results that are not available yet are dropped instead of
+// waiting for them
+void resolveGPUFrame(GPUFrame &frame) {
+#if !defined(__EMSCRIPTEN__)
+  if (frame.events.empty()) return;
+
+  // Queries complete in the order they are issued, so the last one issued
+  // is checked
+  GLuint available{};
+  abcg::glGetQueryObjectuiv(frame.queries.at(frame.lastQuery),
+                            GL_QUERY_RESULT_AVAILABLE, &available);
+  if (available == GL_TRUE) {
+    std::vector<GLuint64> timestamps(frame.events.size() * 2);
+    for (std::size_t index{}; index < timestamps.size(); ++index) {
+      abcg::glGetQueryObjectui64v(frame.queries.at(index), GL_QUERY_RESULT,
+                                  &timestamps.at(index));
+    }
+    const auto frameStart{*std::ranges::min_element(timestamps)};
+    for (std::size_t index{}; index < frame.events.size(); ++index) {
+      auto &event{frame.events.at(index)};
+      event.start =
+          static_cast<std::int64_t>(timestamps.at(index * 2) - frameStart);
+      event.end =
+          static_cast<std::int64_t>(timestamps.at(index * 2 + 1) - frameStart);
+    }
+
+    auto &profilerState{state()};
+    const std::scoped_lock lock{profilerState.mutex};
+    profilerState.lastGPUFrameDuration =
+        static_cast<std::int64_t>(*std::ranges::max_element(timestamps) -
+                                  frameStart);
+    profilerState.lastGPUFrameEvents.swap(frame.events);
+  }
+  frame.events.clear();
+#endif
+}
+
+ImU32 eventColor(const char *name) {
+  const auto hash{std::hash<std::string_view>{}(name)};
+  const auto hue{static_cast<float>(hash % 360) / 360.0f};
+  return ImColor::HSV(hue, 0.5f, 0.8f);
+}
+
+// Draws the events of one lane as bars, one row per nesting depth
+void drawLane(const std::vector<Event> &events, std::uint32_t thread,
+              std::int64_t duration) {
+  constexpr auto rowHeight{18.0f};
+
+  std::uint32_t numRows{};
+  for (const auto &event : events) {
+    if (event.thread == thread) numRows = std::max(numRows, event.depth + 1);
+  }
+
+  const auto origin{ImGui::GetCursorScreenPos()};
+  const auto width{ImGui::GetContentRegionAvail().x};
+  ImGui::Dummy(ImVec2(width, static_cast<float>(numRows) * rowHeight));
+  if (duration <= 0) return;
+
+  auto *drawList{ImGui::GetWindowDrawList()};
+  const auto scale{width / static_cast<float>(duration)};
+  for (const auto &event : events) {
+    if (event.thread != thread) continue;
+
+    const auto start{std::clamp<std::int64_t>(event.start, 0, duration)};
+    const auto end{std::clamp<std::int64_t>(event.end, start, duration)};
+    const ImVec2 min{origin.x + static_cast<float>(start) * scale,
+                     origin.y + static_cast<float>(event.depth) * rowHeight};
+    const ImVec2 max{std::max(origin.x + static_cast<float>(end) * scale,
+                              min.x + 1.0f),
+                     min.y + rowHeight - 1.0f};
+
+    drawList->AddRectFilled(min, max, eventColor(event.name));
+    drawList->PushClipRect(min, max, true);
+    drawList->AddText(ImVec2(min.x + 2.0f, min.y + 1.0f),
+                      IM_COL32(0, 0, 0, 255), event.name);
+    drawList->PopClipRect();
+
+    if (ImGui::IsMouseHoveringRect(min, max)) {
+      ImGui::SetTooltip("%s: %.3f ms", event.name,
+                        static_cast<double>(event.end - event.start) * 1e-6);
+    }
+  }
+}
+}  // namespace
+
+/**
+ * @brief Starts recording a CPU scope.
+ *
+ * @param name Name of the scope. Must outlive the profiler.
+ */
+abcg::Profiler::Scope::Scope(const char *name) noexcept
+    : m_name{name}, m_start{now()} {
+  ++threadDepth;
+}
+
+abcg::Profiler::Scope::~Scope() {
+  const auto end{now()};
+  --threadDepth;
+
+  auto &profilerState{state()};
+  const Event event{.name = m_name,
+                    .thread = threadIndex(),
+                    .depth = threadDepth,
+                    .start = m_start,
+                    .end = end};
+  const std::scoped_lock lock{profilerState.mutex};
+  profilerState.events.push_back(event);
+}
+
+/**
+ * @brief Starts recording a GPU scope.
+ *
+ * Does nothing if abcg::Profiler::initializeGPU did not enable GPU
+ * profiling.
+ *
+ * @param name Name of the scope. Must outlive the profiler.
+ */
+abcg::Profiler::GPUScope::GPUScope([[maybe_unused]] const char *name) {
+#if !defined(__EMSCRIPTEN__)
+  auto &profilerState{state()};
+  if (!profilerState.gpuEnabled) return;
+
+  auto &frame{profilerState.gpuFrames.at(profilerState.gpuFrame)};
+  m_index = frame.events.size();
+  m_active = true;
+  if (frame.queries.size() < (m_index + 1) * 2) {
+    frame.queries.resize((m_index + 1) * 2);
+    abcg::glGenQueries(2, &frame.queries.at(m_index * 2));
+  }
+  frame.events.push_back(Event{.name = name, .depth = profilerState.gpuDepth});
+  ++profilerState.gpuDepth;
+
+  frame.lastQuery = m_index * 2;
+  abcg::glQueryCounter(frame.queries.at(frame.lastQuery), GL_TIMESTAMP);
+#endif
+}
+
+abcg::Profiler::GPUScope::~GPUScope() {
+#if !defined(__EMSCRIPTEN__)
+  if (!m_active) return;
+  auto &profilerState{state()};
+  auto &frame{profilerState.gpuFrames.at(profilerState.gpuFrame)};
+  --profilerState.gpuDepth;
+  frame.lastQuery = m_index * 2 + 1;
+  abcg::glQueryCounter(frame.queries.at(frame.lastQuery), GL_TIMESTAMP);
+#endif
+}
+
+/**
+ * @brief Enables GPU scopes if the current OpenGL context supports timer
+ * queries.
+ *
+ * Must be called with the OpenGL context current.
+ */
+void abcg::Profiler::initializeGPU() {
+  state().gpuEnabled = GPUTimer::isSupported();
+}
+
+/**
+ * @brief Destroys the query objects of the GPU scopes.
+ *
+ * Must be called with the OpenGL context current.
+ */
+void abcg::Profiler::terminateGPU() {
+#if !defined(__EMSCRIPTEN__)
+  auto &profilerState{state()};
+  for (auto &frame : profilerState.gpuFrames) {
+    if (!frame.queries.empty()) {
+      abcg::glDeleteQueries(static_cast<GLsizei>(frame.queries.size()),
+                            frame.queries.data());
+    }
+    frame = {};
+  }
+  profilerState.gpuEnabled = false;
+#endif
+}
+
+/**
+ * @brief Marks the end of the current frame.
+ *
+ * CPU scopes that ended since the previous call become the timeline of the
+ * last frame. Must be called from the thread that owns the OpenGL context,
+ * outside of any scope, usually at the end of abcg::OpenGLWindow::paint.
+ */
+void abcg::Profiler::endFrame() {
+  auto &profilerState{state()};
+  {
+    const std::scoped_lock lock{profilerState.mutex};
+    const auto frameEnd{now()};
+    for (auto &event : profilerState.events) {
+      event.start -= profilerState.frameStart;
+      event.end -= profilerState.frameStart;
+    }
+    profilerState.lastFrameEvents.swap(profilerState.events);
+    profilerState.events.clear();
+    profilerState.lastFrameDuration = frameEnd - profilerState.frameStart;
+    profilerState.frameStart = frameEnd;
+  }
+
+  if (profilerState.gpuEnabled) {
+    profilerState.gpuFrame = (profilerState.gpuFrame + 1) % gpuFrameLatency;
+    resolveGPUFrame(profilerState.gpuFrames.at(profilerState.gpuFrame));
+  }
+}
+
+/**
+ * @brief Draws an ImGui window with the timeline of the last frame.
+ *
+ * Each thread and the GPU have a lane in which the scopes are drawn as a
+ * flame graph, with nested scopes below their parent. Hovering a scope shows
+ * its duration.
+ */
+void abcg::Profiler::drawWindow() {
+  auto &profilerState{state()};
+  std::vector<Event> events;
+  std::int64_t duration{};
+  std::uint32_t threadCount{};
+  std::vector<Event> gpuEvents;
+  std::int64_t gpuDuration{};
+  {
+    const std::scoped_lock lock{profilerState.mutex};
+    events = profilerState.lastFrameEvents;
+    duration = profilerState.lastFrameDuration;
+    threadCount = profilerState.threadCount;
+    gpuEvents = profilerState.lastGPUFrameEvents;
+    gpuDuration = profilerState.lastGPUFrameDuration;
+  }
+
+  ImGui::SetNextWindowSize(ImVec2(400, 0), ImGuiCond_FirstUseEver);
+  ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_NoFocusOnAppearing);
+
+  ImGui::Text("CPU: %.3f ms", static_cast<double>(duration) * 1e-6);
+  for (std::uint32_t thread{}; thread < threadCount; ++thread) {
+    if (std::ranges::none_of(events, [thread](const Event &event) {
+          return event.thread == thread;
+        })) {
+      continue;
+    }
+    ImGui::TextDisabled("Thread %u", thread);
+    drawLane(events, thread, duration);
+  }
+
+  if (profilerState.gpuEnabled) {
+    ImGui::Separator();
+    ImGui::Text("GPU: %.3f ms", static_cast<double>(gpuDuration) * 1e-6);
+    drawLane(gpuEvents, 0, gpuDuration);
+  }
+
+  ImGui::End();
+}
+
+#endif
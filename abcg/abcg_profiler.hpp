@@ -0,0 +1,126 @@
+/**
+ * @file abcg_profiler.hpp
+ * @brief abcg::Profiler header file.
+ *
+ * Declaration of abcg::Profiler class and of the ABCG_PROFILE_SCOPE and
+ * ABCG_PROFILE_GPU_SCOPE macros, which are enabled when ABCG_PROFILE is
+ * defined.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_PROFILER_HPP_
+#define ABCG_PROFILER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace abcg {
+class Profiler;
+}  // namespace abcg
+
+/**
+ * @brief abcg::Profiler class.
+ *
+ * Records the CPU time of named scopes on every thread and the GPU time of
+ * named scopes on the thread that owns the OpenGL context. Scopes can be
+ * nested, and the timeline of the last frame is shown as a flame graph by
+ * abcg::Profiler::drawWindow.
+ *
+ * GPU times are measured with GL_TIMESTAMP queries that are read three
+ * frames later, so that the CPU does not wait for the GPU. Timer queries are
+ * not available in OpenGL ES and WebGL, in which case only CPU times are
+ * recorded.
+ *
+ * Use the ABCG_PROFILE_SCOPE and ABCG_PROFILE_GPU_SCOPE macros instead of
+ * the scope classes, so that profiling compiles to nothing when ABCG_PROFILE
+ * is not defined.
+ */
+class abcg::Profiler {
+ public:
+  struct Event {
+    const char* name{};
+    std::uint32_t thread{};
+    std::uint32_t depth{};
+    // Nanoseconds since the beginning of the frame
+    std::int64_t start{};
+    std::int64_t end{};
+  };
+
+  /**
+   * @brief Records the CPU time of the calling thread during the lifetime of
+   * the object.
+   */
+  class Scope {
+   public:
+    explicit Scope(const char* name) noexcept;
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope(Scope&&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope& operator=(Scope&&) = delete;
+
+   private:
+    const char* m_name{};
+    std::int64_t m_start{};
+  };
+
+  /**
+   * @brief Records the GPU time of the OpenGL commands issued during the
+   * lifetime of the object.
+   *
+   * Must be used on the thread that owns the OpenGL context.
+   */
+  class GPUScope {
+   public:
+    explicit GPUScope(const char* name);
+    ~GPUScope();
+
+    GPUScope(const GPUScope&) = delete;
+    GPUScope(GPUScope&&) = delete;
+    GPUScope& operator=(const GPUScope&) = delete;
+    GPUScope& operator=(GPUScope&&) = delete;
+
+   private:
+    std::size_t m_index{};
+    bool m_active{};
+  };
+
+  static void initializeGPU();
+  static void terminateGPU();
+  static void endFrame();
+  static void drawWindow();
+};
+
+#if defined(ABCG_PROFILE)
+#define ABCG_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ABCG_PROFILE_CONCAT(a, b) ABCG_PROFILE_CONCAT_IMPL(a, b)
+/**
+ * @brief Records the CPU time from this point to the end of the enclosing
+ * block.
+ *
+ * @param name Name of the scope. Must be a string literal.
+ */
+#define ABCG_PROFILE_SCOPE(name)                                    \
+  const abcg::Profiler::Scope ABCG_PROFILE_CONCAT(abcgProfileScope, \
+                                                  __LINE__) {       \
+    name                                                            \
+  }
+/**
+ * @brief Records the GPU time of the OpenGL commands issued from this point
+ * to the end of the enclosing block.
+ *
+ * @param name Name of the scope. Must be a string literal.
+ */
+#define ABCG_PROFILE_GPU_SCOPE(name)                                       \
+  const abcg::Profiler::GPUScope ABCG_PROFILE_CONCAT(abcgProfileGPUScope, \
+                                                     __LINE__) {          \
+    name                                                                   \
+  }
+#else
+#define ABCG_PROFILE_SCOPE(name)
+#define ABCG_PROFILE_GPU_SCOPE(name)
+#endif
+
+#endif
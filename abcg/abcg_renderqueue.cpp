@@ -0,0 +1,337 @@
+/**
+ * @file abcg_renderqueue.cpp
+ * @brief Definition of abcg::CommandList and abcg::RenderQueue members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_renderqueue.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+// Sort key layout, from the most to the least significant bits:
+// - Front to back: pass (4) | program (12) | material (16) | VAO (12) |
+//   depth (20)
+// - Back to front: pass (4) | inverted depth (20) | program (12) |
+//   material (16) | VAO (12)
+constexpr unsigned passBits{4};
+constexpr unsigned programBits{12};
+constexpr unsigned materialBits{16};
+constexpr unsigned vertexArrayBits{12};
+constexpr unsigned depthBits{20};
+
+constexpr std::uint64_t mask(unsigned bits) {
+  return (std::uint64_t{1} << bits) - 1;
+}
+
+std::uint64_t quantizeDepth(float depth) {
+  const auto maxDepth{static_cast<float>(mask(depthBits))};
+  return static_cast<std::uint64_t>(std::clamp(depth, 0.0f, 1.0f) * maxDepth);
+}
+
+// Folds the texture and sampler names into a material identifier
+std::uint64_t materialID(const abcg::RenderCommand& command) {
+  std::uint64_t hash{14695981039346656037ULL};
+  for (const auto& binding : command.textures) {
+    for (const auto value : {binding.texture, binding.sampler}) {
+      hash = (hash ^ value) * 1099511628211ULL;
+    }
+  }
+  return (hash ^ (hash >> 16U) ^ (hash >> 32U) ^ (hash >> 48U)) &
+         mask(materialBits);
+}
+}  // namespace
+
+void abcg::CommandList::setUniform(GLint location, GLint value) {
+  addUniform(location, UniformType::Int, std::as_bytes(std::span{&value, 1}));
+}
+
+void abcg::CommandList::setUniform(GLint location, GLfloat value) {
+  addUniform(location, UniformType::Float,
+             std::as_bytes(std::span{&value, 1}));
+}
+
+void abcg::CommandList::setUniform(GLint location, const glm::vec2& value) {
+  addUniform(location, UniformType::Vec2, std::as_bytes(std::span{&value, 1}));
+}
+
+void abcg::CommandList::setUniform(GLint location, const glm::vec3& value) {
+  addUniform(location, UniformType::Vec3, std::as_bytes(std::span{&value, 1}));
+}
+
+void abcg::CommandList::setUniform(GLint location, const glm::vec4& value) {
+  addUniform(location, UniformType::Vec4, std::as_bytes(std::span{&value, 1}));
+}
+
+void abcg::CommandList::setUniform(GLint location, const glm::mat3& value) {
+  addUniform(location, UniformType::Mat3, std::as_bytes(std::span{&value, 1}));
+}
+
+void abcg::CommandList::setUniform(GLint location, const glm::mat4& value) {
+  addUniform(location, UniformType::Mat4, std::as_bytes(std::span{&value, 1}));
+}
+
+/**
+ * @brief Records a draw command.
+ *
+ * The uniforms set since the previous call are attached to the command, and
+ * the sort key is computed from the command state.
+ *
+ * @param command Draw command. Its uniform range and sort key are ignored.
+ */
+void abcg::CommandList::draw(const RenderCommand& command) {
+  auto& recorded{m_commands.emplace_back(command)};
+  const auto numUniforms{static_cast<std::uint32_t>(m_uniforms.size())};
+  recorded.firstUniform = m_firstPendingUniform;
+  recorded.numUniforms = numUniforms - m_firstPendingUniform;
+  recorded.sortKey = RenderQueue::makeSortKey(recorded);
+  m_firstPendingUniform = numUniforms;
+}
+
+/**
+ * @brief Removes all recorded commands and uniforms, keeping the allocated
+ * memory.
+ */
+void abcg::CommandList::clear() {
+  m_commands.clear();
+  m_uniforms.clear();
+  m_uniformData.clear();
+  m_firstPendingUniform = 0;
+}
+
+void abcg::CommandList::addUniform(GLint location, UniformType type,
+                                   std::span<const std::byte> data) {
+  if (location < 0) return;
+  const auto offset{static_cast<std::uint32_t>(m_uniformData.size())};
+  m_uniformData.insert(m_uniformData.end(), data.begin(), data.end());
+  m_uniforms.push_back({.location = location, .type = type, .offset = offset});
+}
+
+/**
+ * @brief Computes the sort key of a command.
+ *
+ * Commands are grouped by pass, then by program, material and vertex array,
+ * and sorted front to back within each group so that early depth testing
+ * discards occluded fragments. Commands flagged as back to front are sorted
+ * by decreasing depth first.
+ *
+ * @param command Render command.
+ *
+ * @return 64-bit sort key.
+ */
+std::uint64_t abcg::RenderQueue::makeSortKey(const RenderCommand& command) {
+  const auto pass{std::uint64_t{command.pass} & mask(passBits)};
+  const auto program{std::uint64_t{command.program} & mask(programBits)};
+  const auto material{materialID(command)};
+  const auto vertexArray{std::uint64_t{command.vertexArray} &
+                         mask(vertexArrayBits)};
+  const auto depth{quantizeDepth(command.depth)};
+
+  auto key{pass};
+  if (command.backToFront) {
+    key = (key << depthBits) | (mask(depthBits) - depth);
+    key = (key << programBits) | program;
+    key = (key << materialBits) | material;
+    key = (key << vertexArrayBits) | vertexArray;
+  } else {
+    key = (key << programBits) | program;
+    key = (key << materialBits) | material;
+    key = (key << vertexArrayBits) | vertexArray;
+    key = (key << depthBits) | depth;
+  }
+  return key;
+}
+
+/**
+ * @brief Submits a command list for execution in the current frame.
+ *
+ * Thread-safe.
+ *
+ * @param commandList Command list to be moved into the queue.
+ */
+void abcg::RenderQueue::submit(CommandList&& commandList) {
+  const std::scoped_lock lock{m_mutex};
+  nextList() = std::move(commandList);
+}
+
+/**
+ * @brief Submits a copy of a command list for execution in the current
+ * frame.
+ *
+ * Thread-safe. Unlike the overload that moves the list, the submitted list
+ * is left untouched, e.g. when it is owned by a frame packet that is reused
+ * by another thread. The copy reuses the memory of a list submitted in a
+ * previous frame.
+ *
+ * @param commandList Command list to be copied into the queue.
+ */
+void abcg::RenderQueue::submit(const CommandList& commandList) {
+  const std::scoped_lock lock{m_mutex};
+  nextList() = commandList;
+}
+
+/**
+ * @brief Sorts and executes the submitted commands, then empties the queue.
+ *
+ * Programs, vertex arrays, textures and samplers are only bound when they
+ * differ from those of the previous command. On return, the vertex array and
+ * the samplers used by the queue are unbound.
+ */
+void abcg::RenderQueue::execute() {
+  const std::scoped_lock lock{m_mutex};
+
+  m_entries.clear();
+  for (std::uint32_t listIndex{}; listIndex < m_numLists; ++listIndex) {
+    const auto& commands{m_lists.at(listIndex).m_commands};
+    for (std::uint32_t index{}; index < commands.size(); ++index) {
+      m_entries.push_back({.key = commands.at(index).sortKey,
+                           .list = listIndex,
+                           .command = index});
+    }
+  }
+  sort();
+
+  m_statistics = {.commands = m_entries.size()};
+  GLuint currentProgram{};
+  GLuint currentVertexArray{};
+  std::array<RenderCommand::TextureBinding, RenderCommand::maxTextureUnits>
+      currentTextures{};
+  bool first{true};
+
+  for (const auto& entry : m_entries) {
+    const auto& list{m_lists.at(entry.list)};
+    const auto& command{list.m_commands.at(entry.command)};
+
+    if (first || command.program != currentProgram) {
+      abcg::glUseProgram(command.program);
+      currentProgram = command.program;
+      ++m_statistics.programChanges;
+    }
+    if (first || command.vertexArray != currentVertexArray) {
+      abcg::glBindVertexArray(command.vertexArray);
+      currentVertexArray = command.vertexArray;
+      ++m_statistics.vertexArrayChanges;
+    }
+    for (GLuint unit{}; unit < RenderCommand::maxTextureUnits; ++unit) {
+      const auto& binding{command.textures.at(unit)};
+      auto& current{currentTextures.at(unit)};
+      if (binding.texture == 0 && current.texture == 0) continue;
+      if (binding.target != current.target ||
+          binding.texture != current.texture) {
+        abcg::glActiveTexture(GL_TEXTURE0 + unit);
+        if (current.texture != 0 && binding.target != current.target) {
+          abcg::glBindTexture(current.target, 0);
+        }
+        abcg::glBindTexture(binding.target, binding.texture);
+        ++m_statistics.textureChanges;
+      }
+      if (binding.sampler != current.sampler) {
+        abcg::glBindSampler(unit, binding.sampler);
+      }
+      current = binding;
+    }
+    first = false;
+
+    applyUniforms(list, command);
+
+    if (command.indexType == GL_NONE) {
+      abcg::glDrawArraysInstanced(command.mode,
+                                  static_cast<GLint>(command.first),
+                                  command.count, command.instanceCount);
+    } else {
+      // NOLINTNEXTLINE(performance-no-int-to-ptr)
+      const auto* indices{reinterpret_cast<const void*>(command.first)};
+      abcg::glDrawElementsInstanced(command.mode, command.count,
+                                    command.indexType, indices,
+                                    command.instanceCount);
+    }
+  }
+
+  // Samplers left bound would override the parameters of textures used
+  // later, e.g. by the ImGui renderer
+  for (GLuint unit{}; unit < RenderCommand::maxTextureUnits; ++unit) {
+    if (currentTextures.at(unit).sampler != 0) abcg::glBindSampler(unit, 0);
+  }
+  if (!m_entries.empty()) abcg::glBindVertexArray(0);
+
+  m_numLists = 0;
+}
+
+// Returns the next free slot of the current frame. Must be called with the
+// mutex locked
+abcg::CommandList& abcg::RenderQueue::nextList() {
+  if (m_numLists == m_lists.size()) m_lists.emplace_back();
+  return m_lists.at(m_numLists++);
+}
+
+// LSD radix sort on the 64-bit keys, one byte per pass. Passes in which all
+// keys have the same byte are skipped, which is common as most keys share
+// the pass and program bits
+void abcg::RenderQueue::sort() {
+  constexpr std::size_t numDigits{sizeof(std::uint64_t)};
+  constexpr std::size_t radix{256};
+
+  std::array<std::array<std::size_t, radix>, numDigits> histograms{};
+  for (const auto& entry : m_entries) {
+    for (std::size_t digit{}; digit < numDigits; ++digit) {
+      ++histograms.at(digit).at((entry.key >> (digit * 8U)) & 0xFFU);
+    }
+  }
+
+  m_scratch.resize(m_entries.size());
+  for (std::size_t digit{}; digit < numDigits; ++digit) {
+    auto& histogram{histograms.at(digit)};
+    const auto shift{digit * 8U};
+    if (std::ranges::find(histogram, m_entries.size()) != histogram.end()) {
+      continue;
+    }
+
+    // Convert counts to starting offsets
+    std::size_t offset{};
+    for (auto& count : histogram) {
+      offset += std::exchange(count, offset);
+    }
+    for (const auto& entry : m_entries) {
+      m_scratch.at(histogram.at((entry.key >> shift) & 0xFFU)++) = entry;
+    }
+    std::swap(m_entries, m_scratch);
+  }
+}
+
+void abcg::RenderQueue::applyUniforms(const CommandList& list,
+                                      const RenderCommand& command) {
+  const auto first{list.m_uniforms.begin() + command.firstUniform};
+  for (const auto& uniform :
+       std::span{first, first + command.numUniforms}) {
+    const auto* data{&list.m_uniformData.at(uniform.offset)};
+    const auto* floats{reinterpret_cast<const GLfloat*>(data)};
+    switch (uniform.type) {
+      case CommandList::UniformType::Int:
+        abcg::glUniform1iv(uniform.location, 1,
+                           reinterpret_cast<const GLint*>(data));
+        break;
+      case CommandList::UniformType::Float:
+        abcg::glUniform1fv(uniform.location, 1, floats);
+        break;
+      case CommandList::UniformType::Vec2:
+        abcg::glUniform2fv(uniform.location, 1, floats);
+        break;
+      case CommandList::UniformType::Vec3:
+        abcg::glUniform3fv(uniform.location, 1, floats);
+        break;
+      case CommandList::UniformType::Vec4:
+        abcg::glUniform4fv(uniform.location, 1, floats);
+        break;
+      case CommandList::UniformType::Mat3:
+        abcg::glUniformMatrix3fv(uniform.location, 1, GL_FALSE, floats);
+        break;
+      case CommandList::UniformType::Mat4:
+        abcg::glUniformMatrix4fv(uniform.location, 1, GL_FALSE, floats);
+        break;
+    }
+  }
+}
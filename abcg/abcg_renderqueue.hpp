@@ -0,0 +1,178 @@
+/**
+ * @file abcg_renderqueue.hpp
+ * @brief abcg::RenderQueue header file.
+ *
+ * Declaration of abcg::RenderCommand, abcg::CommandList and
+ * abcg::RenderQueue.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_RENDERQUEUE_HPP_
+#define ABCG_RENDERQUEUE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+struct RenderCommand;
+class CommandList;
+class RenderQueue;
+}  // namespace abcg
+
+/**
+ * @brief Draw call recorded in an abcg::CommandList.
+ *
+ * The sort key is computed from the render pass, program, textures, vertex
+ * array and depth when the command is recorded.
+ */
+struct abcg::RenderCommand {
+  static constexpr std::size_t maxTextureUnits{4};
+
+  struct TextureBinding {
+    GLenum target{GL_TEXTURE_2D};
+    GLuint texture{};
+    GLuint sampler{};
+  };
+
+  // Render pass. Passes are executed in increasing order (0 to 15)
+  std::uint8_t pass{};
+  // Normalized view depth in [0, 1], 0 being the nearest
+  float depth{};
+  // Sort by decreasing depth within the pass (e.g. for transparent objects)
+  bool backToFront{};
+
+  GLuint program{};
+  GLuint vertexArray{};
+  // Textures bound to units 0 to maxTextureUnits - 1
+  std::array<TextureBinding, maxTextureUnits> textures{};
+
+  GLenum mode{GL_TRIANGLES};
+  GLsizei count{};
+  // Index type for glDrawElements, or GL_NONE for glDrawArrays
+  GLenum indexType{GL_NONE};
+  // First vertex, or byte offset into the element array buffer
+  std::size_t first{};
+  GLsizei instanceCount{1};
+
+  // Range of the per-command uniforms in the command list
+  std::uint32_t firstUniform{};
+  std::uint32_t numUniforms{};
+  std::uint64_t sortKey{};
+};
+
+/**
+ * @brief abcg::CommandList class.
+ *
+ * Records render commands and their uniform values. A command list is not
+ * thread-safe, but each thread can record into its own list and submit it
+ * to a shared abcg::RenderQueue.
+ *
+ * Uniforms set with abcg::CommandList::setUniform apply to the next command
+ * recorded with abcg::CommandList::draw. Uniforms that do not change between
+ * draws (e.g. the view and projection matrices) should be set directly on the
+ * program instead, as uniform values are part of the program state.
+ */
+class abcg::CommandList {
+ public:
+  void setUniform(GLint location, GLint value);
+  void setUniform(GLint location, GLfloat value);
+  void setUniform(GLint location, const glm::vec2& value);
+  void setUniform(GLint location, const glm::vec3& value);
+  void setUniform(GLint location, const glm::vec4& value);
+  void setUniform(GLint location, const glm::mat3& value);
+  void setUniform(GLint location, const glm::mat4& value);
+  void draw(const RenderCommand& command);
+  void clear();
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_commands.size(); }
+
+ private:
+  friend RenderQueue;
+
+  enum class UniformType : std::uint8_t {
+    Int,
+    Float,
+    Vec2,
+    Vec3,
+    Vec4,
+    Mat3,
+    Mat4
+  };
+
+  struct Uniform {
+    GLint location{};
+    UniformType type{};
+    std::uint32_t offset{};
+  };
+
+  void addUniform(GLint location, UniformType type,
+                  std::span<const std::byte> data);
+
+  std::vector<RenderCommand> m_commands;
+  std::vector<Uniform> m_uniforms;
+  std::vector<std::byte> m_uniformData;
+  std::uint32_t m_firstPendingUniform{};
+};
+
+/**
+ * @brief abcg::RenderQueue class.
+ *
+ * Collects the command lists recorded for a frame, sorts their commands by
+ * sort key and executes them with the least number of state changes.
+ *
+ * abcg::RenderQueue::submit can be called from any thread.
+ * abcg::RenderQueue::execute must be called from the thread that owns the
+ * OpenGL context, after all command lists of the frame have been submitted.
+ */
+class abcg::RenderQueue {
+ public:
+  struct Statistics {
+    std::size_t commands{};
+    std::size_t programChanges{};
+    std::size_t vertexArrayChanges{};
+    std::size_t textureChanges{};
+  };
+
+  void submit(CommandList&& commandList);
+  void submit(const CommandList& commandList);
+  void execute();
+
+  [[nodiscard]] static std::uint64_t makeSortKey(const RenderCommand& command);
+  [[nodiscard]] Statistics getLastStatistics() const noexcept {
+    return m_statistics;
+  }
+
+ private:
+  struct SortEntry {
+    std::uint64_t key{};
+    std::uint32_t list{};
+    std::uint32_t command{};
+  };
+
+  CommandList& nextList();
+  void sort();
+  void applyUniforms(const CommandList& list, const RenderCommand& command);
+
+  std::mutex m_mutex;
+  // Lists of the current frame. Slots are reused across frames, so that
+  // copied lists recycle the memory of previous ones
+  std::vector<CommandList> m_lists;
+  std::size_t m_numLists{};
+  std::vector<SortEntry> m_entries;
+  std::vector<SortEntry> m_scratch;
+  Statistics m_statistics{};
+};
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @file abcg_resolutionscaler.cpp
+ * @brief Definition of abcg::ResolutionScaler class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_resolutionscaler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Fraction of the budget aimed at, leaving room for the frames that are
+// more expensive than the ones measured
+constexpr double targetRatio{0.85};
+// The scale is kept while the GPU time is within these fractions of the
+// budget
+constexpr double minRatio{0.7};
+constexpr double maxRatio{1.0};
+// Largest change of the scale in a single update
+constexpr float maxDecrease{0.85f};
+constexpr float maxIncrease{1.05f};
+// Frames between the change of scale and the first frame measured at the
+// new scale, covering the latency of the timer queries
+constexpr int settleFrames{4};
+}  // namespace
+
+/**
+ * @brief Sets the GPU time budget of a frame.
+ *
+ * @param seconds Budget in seconds. Must be positive.
+ */
+void abcg::ResolutionScaler::setBudget(double seconds) noexcept {
+  if (seconds > 0.0) m_budget = seconds;
+}
+
+/**
+ * @brief Sets the range of the render scale.
+ *
+ * @param minScale Smallest scale, in (0, 1].
+ * @param maxScale Largest scale, in [minScale, 1].
+ */
+void abcg::ResolutionScaler::setScaleRange(float minScale,
+                                           float maxScale) noexcept {
+  m_maxScale = std::clamp(maxScale, scaleStep, 1.0f);
+  m_minScale = std::clamp(minScale, scaleStep, m_maxScale);
+  m_scale = std::clamp(m_scale, m_minScale, m_maxScale);
+}
+
+/**
+ * @brief Adjusts the render scale to the GPU time of a frame.
+ *
+ * @param gpuTime GPU time of a recent frame, in seconds.
+ */
+void abcg::ResolutionScaler::update(double gpuTime) noexcept {
+  if (m_settleFrames > 0) {
+    --m_settleFrames;
+    return;
+  }
+  if (gpuTime <= 0.0) return;
+
+  const auto ratio{gpuTime / m_budget};
+  if (ratio >= minRatio && ratio <= maxRatio) return;
+  if (ratio < minRatio && m_scale >= m_maxScale) return;
+
+  const auto ideal{m_scale *
+                   static_cast<float>(std::sqrt(targetRatio / ratio))};
+  auto scale{std::clamp(ideal, m_scale * maxDecrease, m_scale * maxIncrease)};
+  // Round away from the current scale, so that small increases are not lost
+  scale = (ratio > maxRatio ? std::floor(scale / scaleStep)
+                            : std::ceil(scale / scaleStep)) *
+          scaleStep;
+  scale = std::clamp(scale, m_minScale, m_maxScale);
+  if (scale == m_scale) return;
+
+  m_scale = scale;
+  m_settleFrames = settleFrames;
+}
+
+/**
+ * @brief Restores the largest scale, e.g. after the content changes.
+ */
+void abcg::ResolutionScaler::reset() noexcept {
+  m_scale = m_maxScale;
+  m_settleFrames = settleFrames;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file abcg_resolutionscaler.hpp
+ * @brief abcg::ResolutionScaler header file.
+ *
+ * Declaration of abcg::ResolutionScaler class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_RESOLUTIONSCALER_HPP_
+#define ABCG_RESOLUTIONSCALER_HPP_
+
+namespace abcg {
+class ResolutionScaler;
+}  // namespace abcg
+
+/**
+ * @brief abcg::ResolutionScaler class.
+ *
+ * Controller of the render scale that keeps the GPU time of a frame within
+ * a budget. The scale multiplies the width and height of the rendered image,
+ * so the cost of the fragments is assumed to grow with its square.
+ *
+ * Each call to abcg::ResolutionScaler::update takes the GPU time of a
+ * recent frame. The scale is lowered quickly when the time goes over the
+ * budget and raised slowly when there is room left, in steps of
+ * abcg::ResolutionScaler::scaleStep. As GPU times are measured a few frames
+ * late, the times that follow a change are ignored until the frames
+ * rendered at the new scale are measured.
+ */
+class abcg::ResolutionScaler {
+ public:
+  static constexpr float scaleStep{1.0f / 32.0f};
+
+  void setBudget(double seconds) noexcept;
+  void setScaleRange(float minScale, float maxScale) noexcept;
+  void update(double gpuTime) noexcept;
+  void reset() noexcept;
+
+  [[nodiscard]] float getScale() const noexcept { return m_scale; }
+
+ private:
+  double m_budget{1.0 / 60.0};
+  float m_minScale{0.5f};
+  float m_maxScale{1.0f};
+  float m_scale{1.0f};
+  // Number of GPU times left to ignore after a change of scale
+  int m_settleFrames{};
+};
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ * @file abcg_sampler.cpp
+ * @brief Definition of sampler object helper functions.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_sampler.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+// Same values in EXT_texture_filter_anisotropic, ARB_texture_filter_anisotropic
+// and OpenGL 4.6
+constexpr GLenum textureMaxAnisotropy{0x84FE};
+constexpr GLenum maxTextureMaxAnisotropy{0x84FF};
+
+struct SamplerSettingsHash {
+  std::size_t operator()(
+      const abcg::opengl::SamplerSettings &settings) const noexcept {
+    std::size_t seed{};
+    const auto combine{[&seed](std::size_t hash) {
+      seed ^= hash + 0x9e3779b9 + (seed << 6U) + (seed >> 2U);
+    }};
+    combine(std::hash<GLenum>{}(settings.minFilter));
+    combine(std::hash<GLenum>{}(settings.magFilter));
+    combine(std::hash<GLenum>{}(settings.wrapS));
+    combine(std::hash<GLenum>{}(settings.wrapT));
+    combine(std::hash<GLenum>{}(settings.wrapR));
+    combine(std::hash<float>{}(settings.maxAnisotropy));
+    return seed;
+  }
+};
+
+std::unordered_map<abcg::opengl::SamplerSettings, GLuint, SamplerSettingsHash>
+    samplers;
+std::optional<float> maxSupportedAnisotropy;
+}  // namespace
+
+/**
+ * @brief Returns a sampler object with the given settings.
+ *
+ * Sampler objects are shared: requesting the same settings twice returns the
+ * same object. The samplers are owned by abcg and are deleted by
+ * abcg::opengl::releaseSamplers when the window is destroyed.
+ *
+ * @param settings Filtering, wrapping and anisotropy state of the sampler.
+ *
+ * @return Name of the sampler object, to be used with glBindSampler.
+ */
+GLuint abcg::opengl::getSampler(const SamplerSettings &settings) {
+  auto key{settings};
+  key.maxAnisotropy =
+      std::clamp(key.maxAnisotropy, 1.0f, getMaxSupportedAnisotropy());
+
+  if (auto iter{samplers.find(key)}; iter != samplers.end()) {
+    return iter->second;
+  }
+
+  GLuint sampler{};
+  abcg::glGenSamplers(1, &sampler);
+  abcg::glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER,
+                            static_cast<GLint>(key.minFilter));
+  abcg::glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER,
+                            static_cast<GLint>(key.magFilter));
+  abcg::glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S,
+                            static_cast<GLint>(key.wrapS));
+  abcg::glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T,
+                            static_cast<GLint>(key.wrapT));
+  abcg::glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R,
+                            static_cast<GLint>(key.wrapR));
+  if (key.maxAnisotropy > 1.0f) {
+    abcg::glSamplerParameterf(sampler, textureMaxAnisotropy,
+                              key.maxAnisotropy);
+  }
+
+  samplers.emplace(key, sampler);
+  return sampler;
+}
+
+/**
+ * @brief Returns the maximum degree of anisotropy supported by the current
+ * context, or 1 if anisotropic filtering is not supported.
+ */
+float abcg::opengl::getMaxSupportedAnisotropy() {
+  if (!maxSupportedAnisotropy) {
+    maxSupportedAnisotropy = 1.0f;
+    if (isExtensionSupported("GL_EXT_texture_filter_anisotropic") ||
+        isExtensionSupported("GL_ARB_texture_filter_anisotropic")) {
+      GLfloat maxAnisotropy{};
+      abcg::glGetFloatv(maxTextureMaxAnisotropy, &maxAnisotropy);
+      maxSupportedAnisotropy = std::max(maxAnisotropy, 1.0f);
+    }
+  }
+  return *maxSupportedAnisotropy;
+}
+
+/**
+ * @brief Deletes the sampler objects created by abcg::opengl::getSampler.
+ *
+ * Called by abcg::OpenGLWindow before the OpenGL context is destroyed.
+ */
+void abcg::opengl::releaseSamplers() {
+  for (const auto &[settings, sampler] : samplers) {
+    abcg::glDeleteSamplers(1, &sampler);
+  }
+  samplers.clear();
+  maxSupportedAnisotropy.reset();
+}
@@ -0,0 +1,39 @@
+/**
+ * @file abcg_sampler.hpp
+ * @brief Declaration of sampler object helper functions.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_SAMPLER_HPP_
+#define ABCG_SAMPLER_HPP_
+
+#include <abcg_external.hpp>
+
+namespace abcg::opengl {
+struct SamplerSettings;
+
+[[nodiscard]] GLuint getSampler(const SamplerSettings& settings);
+[[nodiscard]] float getMaxSupportedAnisotropy();
+void releaseSamplers();
+}  // namespace abcg::opengl
+
+/**
+ * @brief Texture sampling state of a sampler object.
+ *
+ * A maxAnisotropy greater than 1 enables anisotropic filtering. It is clamped
+ * to the maximum supported by the implementation, and ignored if anisotropic
+ * filtering is not supported.
+ */
+struct abcg::opengl::SamplerSettings {
+  GLenum minFilter{GL_LINEAR_MIPMAP_LINEAR};
+  GLenum magFilter{GL_LINEAR};
+  GLenum wrapS{GL_REPEAT};
+  GLenum wrapT{GL_REPEAT};
+  GLenum wrapR{GL_REPEAT};
+  float maxAnisotropy{1.0f};
+
+  bool operator==(const SamplerSettings& other) const noexcept = default;
+};
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file abcg_scene.cpp
+ * @brief Definition of abcg::Scene class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_scene.hpp"
+
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <iterator>
+
+#include "abcg_workerpool.hpp"
+
+namespace {
+// Levels smaller than this are updated on the calling thread
+constexpr std::size_t minParallelCount{16384};
+// Smallest number of nodes updated by each thread
+constexpr std::size_t minThreadCount{4096};
+
+template <typename T>
+void insertAt(std::vector<T> &vector, std::size_t index, const T &value) {
+  vector.insert(std::next(vector.begin(), static_cast<std::ptrdiff_t>(index)),
+                value);
+}
+}  // namespace
+
+/**
+ * @brief Creates a node with an identity transform.
+ *
+ * @param parent Handle of the parent node, or abcg::Scene::noParent to create
+ * a root node.
+ *
+ * @return Handle of the new node.
+ */
+abcg::Scene::Node abcg::Scene::createNode(Node parent) {
+  std::size_t depth{};
+  auto parentIndex{noParent};
+  if (parent != noParent) {
+    parentIndex = m_indices.at(parent);
+    // Depth of the parent is the level whose range contains its index
+    const auto level{std::upper_bound(m_levelOffsets.begin(),
+                                      m_levelOffsets.end(), parentIndex)};
+    depth = static_cast<std::size_t>(
+        std::distance(m_levelOffsets.begin(), level));
+  }
+
+  // Insert at the end of its level, shifting the deeper levels
+  if (depth + 1 == m_levelOffsets.size()) {
+    m_levelOffsets.push_back(m_levelOffsets.back());
+  }
+  const auto index{m_levelOffsets.at(depth + 1)};
+  for (auto offset{std::next(m_levelOffsets.begin(),
+                             static_cast<std::ptrdiff_t>(depth + 1))};
+       offset != m_levelOffsets.end(); ++offset) {
+    ++*offset;
+  }
+
+  for (auto &otherParent : m_parents) {
+    if (otherParent != noParent && otherParent >= index) ++otherParent;
+  }
+  for (auto otherIndex{index}; otherIndex < m_nodes.size(); ++otherIndex) {
+    ++m_indices.at(m_nodes.at(otherIndex));
+  }
+
+  const auto node{static_cast<Node>(m_indices.size())};
+  m_indices.push_back(static_cast<std::uint32_t>(index));
+  insertAt(m_nodes, index, node);
+  insertAt(m_parents, index, parentIndex);
+  insertAt(m_translations, index, glm::vec3{0.0f});
+  insertAt(m_rotations, index, glm::quat{1.0f, 0.0f, 0.0f, 0.0f});
+  insertAt(m_scales, index, glm::vec3{1.0f});
+  insertAt(m_localBounds, index, glm::vec4{0.0f});
+  insertAt(m_worldMatrices, index, glm::mat4{1.0f});
+  insertAt(m_dirty, index, std::uint8_t{1});
+  m_worldBounds.add(glm::vec3{0.0f}, 0.0f);
+  m_hasDirty = true;
+
+  return node;
+}
+
+void abcg::Scene::clear() noexcept {
+  m_indices.clear();
+  m_nodes.clear();
+  m_parents.clear();
+  m_translations.clear();
+  m_rotations.clear();
+  m_scales.clear();
+  m_localBounds.clear();
+  m_worldMatrices.clear();
+  m_dirty.clear();
+  m_levelOffsets = {0};
+  m_worldBounds.clear();
+  m_hasDirty = false;
+}
+
+void abcg::Scene::setTranslation(Node node, const glm::vec3 &translation) {
+  m_translations.at(m_indices.at(node)) = translation;
+  markDirty(node);
+}
+
+void abcg::Scene::setRotation(Node node, const glm::quat &rotation) {
+  m_rotations.at(m_indices.at(node)) = rotation;
+  markDirty(node);
+}
+
+void abcg::Scene::setScale(Node node, const glm::vec3 &scale) {
+  m_scales.at(m_indices.at(node)) = scale;
+  markDirty(node);
+}
+
+/**
+ * @brief Sets the bounding sphere of the node, in the space of the node.
+ */
+void abcg::Scene::setLocalBounds(Node node, const glm::vec3 &center,
+                                 float radius) {
+  m_localBounds.at(m_indices.at(node)) = glm::vec4{center, radius};
+  markDirty(node);
+}
+
+abcg::Scene::Node abcg::Scene::getParent(Node node) const {
+  const auto parentIndex{m_parents.at(m_indices.at(node))};
+  return parentIndex == noParent ? noParent : m_nodes.at(parentIndex);
+}
+
+const glm::vec3 &abcg::Scene::getTranslation(Node node) const {
+  return m_translations.at(m_indices.at(node));
+}
+
+const glm::quat &abcg::Scene::getRotation(Node node) const {
+  return m_rotations.at(m_indices.at(node));
+}
+
+const glm::vec3 &abcg::Scene::getScale(Node node) const {
+  return m_scales.at(m_indices.at(node));
+}
+
+/**
+ * @brief Recomputes the world matrices and bounds of the dirty nodes and of
+ * their descendants.
+ */
+void abcg::Scene::update() {
+  if (!m_hasDirty) return;
+
+  // Each level only reads the flags and matrices of the previous levels
+  for (std::size_t level{}; level + 1 < m_levelOffsets.size(); ++level) {
+    const auto first{m_levelOffsets.at(level)};
+    const auto last{m_levelOffsets.at(level + 1)};
+    const auto count{last - first};
+
+    auto &workerPool{WorkerPool::shared()};
+    auto numThreads{std::size_t{1}};
+    if (count >= minParallelCount) {
+      numThreads = std::clamp<std::size_t>(count / minThreadCount, 1,
+                                           workerPool.getThreadCount());
+    }
+    if (numThreads == 1) {
+      updateRange(first, last);
+      continue;
+    }
+
+    const auto rangeSize{(count + numThreads - 1) / numThreads};
+    workerPool.parallelFor(numThreads, [&](std::size_t index) {
+      const auto rangeFirst{std::min(first + index * rangeSize, last)};
+      updateRange(rangeFirst, std::min(rangeFirst + rangeSize, last));
+    });
+  }
+
+  std::fill(m_dirty.begin(), m_dirty.end(), std::uint8_t{0});
+  m_hasDirty = false;
+}
+
+void abcg::Scene::markDirty(Node node) {
+  m_dirty.at(m_indices.at(node)) = 1;
+  m_hasDirty = true;
+}
+
+void abcg::Scene::updateRange(std::size_t first, std::size_t last) {
+  for (auto index{first}; index < last; ++index) {
+    const auto parent{m_parents[index]};
+    if (parent != noParent && m_dirty[parent] != 0) {
+      m_dirty[index] = 1;
+    }
+    if (m_dirty[index] == 0) continue;
+
+    // Translation * rotation * scale
+    const auto rotation{glm::mat3_cast(m_rotations[index])};
+    const auto &scale{m_scales[index]};
+    const glm::mat4 localMatrix{glm::vec4{rotation[0] * scale.x, 0.0f},
+                                glm::vec4{rotation[1] * scale.y, 0.0f},
+                                glm::vec4{rotation[2] * scale.z, 0.0f},
+                                glm::vec4{m_translations[index], 1.0f}};
+
+    auto &worldMatrix{m_worldMatrices[index]};
+    worldMatrix = parent == noParent ? localMatrix
+                                     : m_worldMatrices[parent] * localMatrix;
+
+    // The radius grows with the largest scale of the world matrix
+    const auto &bounds{m_localBounds[index]};
+    const auto maxScale{std::max({glm::length(glm::vec3{worldMatrix[0]}),
+                                  glm::length(glm::vec3{worldMatrix[1]}),
+                                  glm::length(glm::vec3{worldMatrix[2]})})};
+    m_worldBounds.set(m_nodes[index],
+                      glm::vec3{worldMatrix * glm::vec4{glm::vec3{bounds}, 1}},
+                      bounds.w * maxScale);
+  }
+}
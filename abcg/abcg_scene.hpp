@@ -0,0 +1,111 @@
+/**
+ * @file abcg_scene.hpp
+ * @brief abcg::Scene header file.
+ *
+ * Declaration of abcg::Scene class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_SCENE_HPP_
+#define ABCG_SCENE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <vector>
+
+#include "abcg_frustum.hpp"
+
+namespace abcg {
+class Scene;
+}  // namespace abcg
+
+/**
+ * @brief abcg::Scene class.
+ *
+ * Hierarchy of nodes with a local transform (translation, rotation and
+ * scale) relative to their parent. The transforms, world matrices and
+ * bounds are stored as arrays sorted by depth in the hierarchy, so that
+ * parents always come before their children.
+ *
+ * Setters only mark the node as dirty. abcg::Scene::update then recomputes
+ * the world matrices of the dirty nodes and their descendants in a single
+ * pass over the arrays. Nodes of the same depth do not depend on each
+ * other, so large levels are split across the threads of
+ * abcg::WorkerPool::shared.
+ *
+ * Nodes are identified by the handle returned by abcg::Scene::createNode,
+ * which stays valid while nodes are inserted. Creating a node takes linear
+ * time, as it is meant to be done when the scene is built.
+ */
+class abcg::Scene {
+ public:
+  using Node = std::uint32_t;
+  static constexpr Node noParent{std::numeric_limits<Node>::max()};
+
+  Node createNode(Node parent = noParent);
+  void clear() noexcept;
+  [[nodiscard]] std::size_t size() const noexcept { return m_nodes.size(); }
+
+  void setTranslation(Node node, const glm::vec3& translation);
+  void setRotation(Node node, const glm::quat& rotation);
+  void setScale(Node node, const glm::vec3& scale);
+  void setLocalBounds(Node node, const glm::vec3& center, float radius);
+
+  [[nodiscard]] Node getParent(Node node) const;
+  [[nodiscard]] const glm::vec3& getTranslation(Node node) const;
+  [[nodiscard]] const glm::quat& getRotation(Node node) const;
+  [[nodiscard]] const glm::vec3& getScale(Node node) const;
+
+  void update();
+
+  /**
+   * @brief Returns the matrix that transforms from the space of the node to
+   * world space, as of the last call to abcg::Scene::update.
+   */
+  [[nodiscard]] const glm::mat4& getWorldMatrix(Node node) const {
+    return m_worldMatrices.at(m_indices.at(node));
+  }
+
+  /**
+   * @brief Returns the bounding spheres of the nodes in world space, as of
+   * the last call to abcg::Scene::update.
+   *
+   * The spheres are indexed by node handle, so the indices computed by
+   * abcg::Frustum::cull are node handles. Nodes without local bounds have a
+   * sphere of zero radius at their origin.
+   */
+  [[nodiscard]] const BoundingSpheres& getWorldBounds() const noexcept {
+    return m_worldBounds;
+  }
+
+ private:
+  void markDirty(Node node);
+  void updateRange(std::size_t first, std::size_t last);
+
+  // Index of each node handle in the arrays below, and handle of each index
+  std::vector<std::uint32_t> m_indices;
+  std::vector<Node> m_nodes;
+
+  // Sorted by depth. Parents are stored as indices
+  std::vector<std::uint32_t> m_parents;
+  std::vector<glm::vec3> m_translations;
+  std::vector<glm::quat> m_rotations;
+  std::vector<glm::vec3> m_scales;
+  std::vector<glm::vec4> m_localBounds;
+  std::vector<glm::mat4> m_worldMatrices;
+  std::vector<std::uint8_t> m_dirty;
+
+  // Index of the first node of each depth, followed by the number of nodes
+  std::vector<std::size_t> m_levelOffsets{0};
+
+  BoundingSpheres m_worldBounds;
+  bool m_hasDirty{};
+};
+
+#endif
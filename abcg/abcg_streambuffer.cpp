@@ -0,0 +1,185 @@
+/**
+ * @file abcg_streambuffer.cpp
+ * @brief Definition of abcg::StreamBuffer class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_streambuffer.hpp"
+
+#include <fmt/core.h>
+
+#include "abcg_exception.hpp"
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+// Size of a region is a multiple of the largest alignment required for
+// uniform buffer offsets
+constexpr std::size_t regionAlignment{256};
+[[maybe_unused]] constexpr GLuint64 fenceTimeout{1'000'000'000};
+
+constexpr std::size_t alignUp(std::size_t value,
+                              std::size_t alignment) noexcept {
+  return (value + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+abcg::StreamBuffer::~StreamBuffer() { terminate(); }
+
+/**
+ * @brief Creates the buffer.
+ *
+ * Must be called with the OpenGL context current.
+ *
+ * @param target Target to which the buffer is bound in
+ * abcg::StreamBuffer::flush, e.g. GL_ARRAY_BUFFER.
+ * @param frameCapacity Maximum number of bytes allocated in a frame,
+ * including padding for alignment.
+ */
+void abcg::StreamBuffer::initialize(GLenum target, std::size_t frameCapacity) {
+  terminate();
+
+  m_target = target;
+  m_frameCapacity = alignUp(frameCapacity, regionAlignment);
+
+  abcg::glGenBuffers(1, &m_buffer);
+  abcg::glBindBuffer(m_target, m_buffer);
+
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (abcg::isBufferStorageSupported()) {
+    const auto size{static_cast<GLsizeiptr>(frameCount * m_frameCapacity)};
+    const GLbitfield flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                           GL_MAP_COHERENT_BIT};
+    abcg::glBufferStorage(m_target, size, nullptr, flags);
+    m_mappedData = static_cast<std::byte *>(
+        abcg::glMapBufferRange(m_target, 0, size, flags));
+  }
+#endif
+
+  if (m_mappedData == nullptr) {
+    // Each frame orphans the storage, so a single region is enough
+    abcg::glBufferData(m_target, static_cast<GLsizeiptr>(m_frameCapacity),
+                       nullptr, GL_STREAM_DRAW);
+    m_stagingData.resize(m_frameCapacity);
+  }
+
+  abcg::glBindBuffer(m_target, 0);
+}
+
+/**
+ * @brief Waits for the GPU to finish reading the buffer and releases it.
+ */
+void abcg::StreamBuffer::terminate() {
+  if (m_buffer == 0) return;
+
+#if !defined(__EMSCRIPTEN__)
+  for (auto &fence : m_fences) {
+    if (fence == nullptr) continue;
+    abcg::glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout);
+    abcg::glDeleteSync(fence);
+    fence = nullptr;
+  }
+#endif
+
+  if (m_mappedData != nullptr) {
+    abcg::glBindBuffer(m_target, m_buffer);
+    abcg::glUnmapBuffer(m_target);
+    abcg::glBindBuffer(m_target, 0);
+    m_mappedData = nullptr;
+  }
+  abcg::glDeleteBuffers(1, &m_buffer);
+  m_buffer = 0;
+
+  m_stagingData.clear();
+  m_stagingData.shrink_to_fit();
+  m_frame = 0;
+  m_used = 0;
+  m_flushed = 0;
+}
+
+/**
+ * @brief Sub-allocates memory from the region of the current frame.
+ *
+ * @param size Number of bytes.
+ * @param alignment Alignment of the offset in the buffer, in bytes. To draw
+ * from the allocation with a first vertex index instead of an offset in the
+ * vertex attribute pointer, use the size of a vertex.
+ *
+ * @throw abcg::Exception if the region has no room left for the
+ * allocation.
+ */
+abcg::StreamBuffer::Allocation
+abcg::StreamBuffer::allocate(std::size_t size, std::size_t alignment) {
+  const auto base{isPersistent() ? m_frame * m_frameCapacity : 0};
+  const auto offset{alignUp(base + m_used, alignment)};
+  if (offset + size > base + m_frameCapacity) {
+    throw abcg::Exception{abcg::Exception::Runtime(fmt::format(
+        "Stream buffer overflow: {} bytes requested, {} of {} bytes used", size,
+        m_used, m_frameCapacity))};
+  }
+  m_used = offset + size - base;
+
+  auto *const data{isPersistent() ? m_mappedData + offset
+                                  : m_stagingData.data() + (offset - base)};
+  return {.data = data, .offset = static_cast<GLintptr>(offset)};
+}
+
+/**
+ * @brief Makes the data written since the last flush visible to the GPU.
+ *
+ * Must be called after writing to the allocations and before drawing from
+ * them. With the persistent mapping, the memory is coherent and nothing is
+ * done. Otherwise, the first flush of a frame orphans the storage of the
+ * buffer, so that the driver allocates a new one instead of waiting for the
+ * draws of the previous frame, and the written bytes are uploaded with
+ * glBufferSubData.
+ *
+ * Binds the buffer to its target. For GL_ELEMENT_ARRAY_BUFFER, this changes
+ * the element buffer of the bound vertex array object.
+ */
+void abcg::StreamBuffer::flush() {
+  if (isPersistent() || m_used == m_flushed) return;
+
+  abcg::glBindBuffer(m_target, m_buffer);
+  if (m_flushed == 0) {
+    abcg::glBufferData(m_target, static_cast<GLsizeiptr>(m_frameCapacity),
+                       nullptr, GL_STREAM_DRAW);
+  }
+  abcg::glBufferSubData(m_target, static_cast<GLintptr>(m_flushed),
+                        static_cast<GLsizeiptr>(m_used - m_flushed),
+                        m_stagingData.data() + m_flushed);
+  m_flushed = m_used;
+}
+
+/**
+ * @brief Ends the frame and moves to the region of the next frame.
+ *
+ * Must be called after the draws that read the allocations of the frame.
+ * The allocations of the frame become invalid. With the persistent mapping,
+ * a fence is placed after the draws, and the fence of the next region, placed
+ * abcg::StreamBuffer::frameCount - 1 frames ago, is waited for.
+ */
+void abcg::StreamBuffer::endFrame() {
+#if !defined(__EMSCRIPTEN__)
+  if (isPersistent()) {
+    if (m_used > 0) {
+      m_fences.at(m_frame) =
+          abcg::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    m_frame = (m_frame + 1) % frameCount;
+
+    if (auto &fence{m_fences.at(m_frame)}; fence != nullptr) {
+      auto status{abcg::glClientWaitSync(fence, 0, 0)};
+      while (status == GL_TIMEOUT_EXPIRED) {
+        status = abcg::glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                        fenceTimeout);
+      }
+      abcg::glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+#endif
+
+  m_used = 0;
+  m_flushed = 0;
+}
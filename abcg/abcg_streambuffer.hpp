@@ -0,0 +1,116 @@
+/**
+ * @file abcg_streambuffer.hpp
+ * @brief abcg::StreamBuffer header file.
+ *
+ * Declaration of abcg::StreamBuffer class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_STREAMBUFFER_HPP_
+#define ABCG_STREAMBUFFER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class StreamBuffer;
+}  // namespace abcg
+
+/**
+ * @brief abcg::StreamBuffer class.
+ *
+ * Buffer object for data written by the CPU every frame, such as dynamic
+ * vertices, without creating buffers or waiting for the driver.
+ *
+ * The buffer is divided into abcg::StreamBuffer::frameCount regions of
+ * abcg::StreamBuffer::getFrameCapacity bytes, used as a ring: each frame
+ * sub-allocates from its own region with abcg::StreamBuffer::allocate, and
+ * abcg::StreamBuffer::endFrame places a fence after the draws of the frame
+ * and moves on to the next region. The fence of a region is only waited for
+ * when the ring comes back to it, by which time the GPU has usually
+ * finished the frame that read it.
+ *
+ * When immutable buffer storage is supported (see
+ * abcg::isBufferStorageSupported), the whole buffer stays mapped with
+ * GL_MAP_PERSISTENT_BIT and GL_MAP_COHERENT_BIT, and allocations point
+ * straight into it. Otherwise (OpenGL 4.1 on macOS, OpenGL ES and WebGL),
+ * allocations point into a copy in client memory, and
+ * abcg::StreamBuffer::flush orphans the buffer once per frame and uploads
+ * what was written with glBufferSubData.
+ *
+ * Allocations are valid until the next call to abcg::StreamBuffer::endFrame
+ * and must be flushed before they are drawn.
+ */
+class abcg::StreamBuffer {
+ public:
+  static constexpr std::size_t frameCount{3};
+
+  struct Allocation {
+    // Memory to write to
+    void* data{};
+    // Offset of the allocation in the buffer, in bytes
+    GLintptr offset{};
+  };
+
+  StreamBuffer() = default;
+  ~StreamBuffer();
+
+  StreamBuffer(const StreamBuffer&) = delete;
+  StreamBuffer(StreamBuffer&&) = delete;
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+  StreamBuffer& operator=(StreamBuffer&&) = delete;
+
+  void initialize(GLenum target, std::size_t frameCapacity);
+  void terminate();
+
+  [[nodiscard]] Allocation allocate(std::size_t size,
+                                    std::size_t alignment = 16);
+  void flush();
+  void endFrame();
+
+  /**
+   * @brief Copies data to a new allocation.
+   *
+   * @return Offset of the data in the buffer, in bytes. It is a multiple of
+   * sizeof(T), so it can be converted to an index of the first vertex.
+   */
+  template <typename T>
+  GLintptr write(std::span<const T> data) {
+    const auto allocation{allocate(data.size_bytes(), sizeof(T))};
+    std::memcpy(allocation.data, data.data(), data.size_bytes());
+    return allocation.offset;
+  }
+
+  [[nodiscard]] GLuint getBuffer() const noexcept { return m_buffer; }
+  [[nodiscard]] std::size_t getFrameCapacity() const noexcept {
+    return m_frameCapacity;
+  }
+  [[nodiscard]] bool isPersistent() const noexcept {
+    return m_mappedData != nullptr;
+  }
+
+ private:
+  GLenum m_target{};
+  GLuint m_buffer{};
+  std::size_t m_frameCapacity{};
+
+  // Persistent mapping of the whole buffer, and fence of each region
+  std::byte* m_mappedData{};
+  std::array<GLsync, frameCount> m_fences{};
+  std::size_t m_frame{};
+
+  // Client copy of the current frame, without persistent mapping
+  std::vector<std::byte> m_stagingData;
+
+  // Bytes allocated in the current frame, and bytes already uploaded
+  std::size_t m_used{};
+  std::size_t m_flushed{};
+};
+
+#endif
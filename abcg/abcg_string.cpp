@@ -10,6 +10,9 @@
 
 #include "abcg_string.hpp"
 
+#include <fmt/core.h>
+
+#include <algorithm>
 #include <cctype>
 
 // Trim from start (in place)
@@ -46,4 +49,27 @@ std::string abcg::rightTrimCopy(std::string s) {
 std::string abcg::trimCopy(std::string s) {
   trim(s);
   return s;
-}
\ No newline at end of file
+}
+
+// Escape quotes, backslashes and control characters for a JSON string
+std::string abcg::escapeJSON(std::string_view text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (const auto character : text) {
+    switch (character) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(character) < 0x20) {
+          escaped += fmt::format("\\u{:04x}", static_cast<int>(character));
+        } else {
+          escaped += character;
+        }
+    }
+  }
+  return escaped;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file abcg_triplebuffer.hpp
+ * @brief abcg::TripleBuffer header file.
+ *
+ * Declaration and definition of abcg::TripleBuffer class template.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_TRIPLEBUFFER_HPP_
+#define ABCG_TRIPLEBUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace abcg {
+template <typename T>
+class TripleBuffer;
+}  // namespace abcg
+
+/**
+ * @brief abcg::TripleBuffer class template.
+ *
+ * Passes values from one writer thread to one reader thread without locks.
+ * The writer fills the write buffer and publishes it; the reader acquires the
+ * most recently published buffer. Each side owns its buffer until the next
+ * call to abcg::TripleBuffer::publish or abcg::TripleBuffer::acquire, and the
+ * third buffer holds the value that is in transit.
+ *
+ * If the writer publishes faster than the reader acquires, older values are
+ * overwritten. abcg::TripleBuffer::waitConsumed can be used to keep the
+ * writer at most one value ahead of the reader instead.
+ *
+ * @tparam T Type of the values. Buffers are reused, so that allocations made
+ * by the writer in one value can be recycled in later values.
+ */
+template <typename T>
+class abcg::TripleBuffer {
+ public:
+  /**
+   * @brief Returns the buffer owned by the writer.
+   */
+  [[nodiscard]] T& getWriteBuffer() noexcept {
+    return m_buffers.at(m_writeIndex);
+  }
+
+  /**
+   * @brief Returns the buffer owned by the reader.
+   */
+  [[nodiscard]] T& getReadBuffer() noexcept {
+    return m_buffers.at(m_readIndex);
+  }
+
+  /**
+   * @brief Makes the write buffer available to the reader, and takes the
+   * buffer in transit as the new write buffer.
+   *
+   * Must only be called by the writer.
+   */
+  void publish() noexcept {
+    m_writeIndex = m_state.exchange(m_writeIndex | publishedBit,
+                                    std::memory_order_acq_rel) &
+                   indexMask;
+    m_state.notify_all();
+  }
+
+  /**
+   * @brief Takes the most recently published buffer as the new read buffer.
+   *
+   * Must only be called by the reader.
+   *
+   * @return True if a buffer was published since the previous call, false if
+   * the read buffer is unchanged.
+   */
+  bool acquire() noexcept {
+    if ((m_state.load(std::memory_order_relaxed) & publishedBit) == 0) {
+      return false;
+    }
+    m_readIndex = m_state.exchange(m_readIndex, std::memory_order_acq_rel) &
+                  indexMask;
+    m_state.notify_all();
+    return true;
+  }
+
+  /**
+   * @brief Blocks the reader until a buffer is published.
+   */
+  void waitPublished() const noexcept {
+    auto state{m_state.load(std::memory_order_acquire)};
+    while ((state & publishedBit) == 0) {
+      m_state.wait(state, std::memory_order_acquire);
+      state = m_state.load(std::memory_order_acquire);
+    }
+  }
+
+  /**
+   * @brief Blocks the writer until the reader has acquired the last
+   * published buffer.
+   */
+  void waitConsumed() const noexcept {
+    auto state{m_state.load(std::memory_order_acquire)};
+    while ((state & publishedBit) != 0) {
+      m_state.wait(state, std::memory_order_acquire);
+      state = m_state.load(std::memory_order_acquire);
+    }
+  }
+
+  /**
+   * @brief Returns the buffers to their initial roles and drops the buffer
+   * in transit, if any.
+   *
+   * Must only be called while neither thread uses the triple buffer, e.g.
+   * after the reader thread is joined.
+   */
+  void reset() noexcept {
+    m_writeIndex = 0;
+    m_state.store(1, std::memory_order_relaxed);
+    m_readIndex = 2;
+  }
+
+ private:
+  // The state holds the index of the buffer in transit and whether it was
+  // published and not acquired yet
+  static constexpr std::uint8_t indexMask{0x3};
+  static constexpr std::uint8_t publishedBit{0x4};
+
+  std::array<T, 3> m_buffers{};
+  std::uint8_t m_writeIndex{0};
+  std::atomic<std::uint8_t> m_state{1};
+  std::uint8_t m_readIndex{2};
+};
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file abcg_uploadthread.cpp
+ * @brief Definition of abcg::UploadThread class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_uploadthread.hpp"
+
+#include "abcg_openglfunctions.hpp"
+
+abcg::UploadThread::~UploadThread() { stop(); }
+
+/**
+ * @brief Starts the upload thread.
+ *
+ * @param window Window whose context is shared with the upload context.
+ * @param context Context created with SDL_GL_SHARE_WITH_CURRENT_CONTEXT,
+ * which is made current on the upload thread. The upload thread takes
+ * ownership of it.
+ */
+void abcg::UploadThread::start(SDL_Window *window, SDL_GLContext context) {
+  if (isRunning()) return;
+
+  m_window = window;
+  m_context = context;
+  m_stop = false;
+  m_thread = std::thread{&UploadThread::work, this};
+}
+
+/**
+ * @brief Stops the upload thread and deletes its context.
+ *
+ * Uploads that did not start yet are discarded, and the ready functions of
+ * the finished uploads are not called. Must be called with a context of the
+ * share group current.
+ */
+void abcg::UploadThread::stop() {
+  if (!isRunning()) return;
+
+  {
+    const std::scoped_lock lock{m_mutex};
+    m_stop = true;
+  }
+  m_condition.notify_all();
+  m_thread.join();
+
+  for (const auto &task : m_completedTasks) {
+    if (task.fence != nullptr) abcg::glDeleteSync(task.fence);
+  }
+  m_tasks.clear();
+  m_completedTasks.clear();
+
+  SDL_GL_DeleteContext(m_context);
+  m_context = nullptr;
+}
+
+/**
+ * @brief Queues an upload.
+ *
+ * Can be called from any thread.
+ *
+ * @param upload Function that creates and fills the OpenGL objects, called
+ * on the upload thread. It must not use the objects of the other threads.
+ * @param ready Function called by abcg::UploadThread::poll when the objects
+ * created by the upload function can be used for rendering.
+ */
+void abcg::UploadThread::enqueue(UploadFunction upload, ReadyFunction ready) {
+  {
+    const std::scoped_lock lock{m_mutex};
+    m_tasks.push_back({.upload = std::move(upload), .ready = std::move(ready)});
+  }
+  m_condition.notify_all();
+}
+
+/**
+ * @brief Calls the ready functions of the finished uploads.
+ *
+ * Does not wait for the uploads that are still in progress. Must be called
+ * from the thread that owns the window context.
+ *
+ * @throw Rethrows the exception thrown by an upload function, if any.
+ */
+void abcg::UploadThread::poll() {
+  if (!isRunning()) {
+    std::deque<Task> tasks;
+    {
+      const std::scoped_lock lock{m_mutex};
+      tasks.swap(m_tasks);
+    }
+    for (auto &task : tasks) {
+      task.upload();
+      if (task.ready) task.ready();
+    }
+    return;
+  }
+
+  while (true) {
+    CompletedTask task;
+    {
+      const std::scoped_lock lock{m_mutex};
+      if (m_completedTasks.empty()) break;
+
+      auto &front{m_completedTasks.front()};
+      if (front.fence != nullptr) {
+        if (abcg::glClientWaitSync(front.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+          break;
+        }
+        abcg::glDeleteSync(front.fence);
+      }
+      task = std::move(front);
+      m_completedTasks.pop_front();
+    }
+
+    if (task.exception) std::rethrow_exception(task.exception);
+    if (task.ready) task.ready();
+  }
+}
+
+/**
+ * @brief Returns the number of uploads whose ready function was not called
+ * yet.
+ */
+std::size_t abcg::UploadThread::getPendingCount() {
+  const std::scoped_lock lock{m_mutex};
+  return m_tasks.size() + m_completedTasks.size() + (m_busy ? 1 : 0);
+}
+
+void abcg::UploadThread::work() {
+  SDL_GL_MakeCurrent(m_window, m_context);
+
+  std::unique_lock lock{m_mutex};
+  while (true) {
+    m_condition.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+    if (m_stop) break;
+
+    auto task{std::move(m_tasks.front())};
+    m_tasks.pop_front();
+    m_busy = true;
+    lock.unlock();
+
+    CompletedTask completedTask;
+    completedTask.ready = std::move(task.ready);
+    try {
+#if defined(ABCG_GL_STATE_CACHE)
+      // Objects bound in this context may have been deleted by another
+      // context, and their names reused
+      OpenGLStateCache::current().invalidate();
+#endif
+      task.upload();
+      completedTask.fence =
+          abcg::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      // Submit the commands, so that the fence is eventually signaled
+      abcg::glFlush();
+    } catch (...) {
+      completedTask.exception = std::current_exception();
+    }
+
+    lock.lock();
+    m_completedTasks.push_back(std::move(completedTask));
+    m_busy = false;
+  }
+  lock.unlock();
+
+  SDL_GL_MakeCurrent(m_window, nullptr);
+}
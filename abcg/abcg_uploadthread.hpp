@@ -0,0 +1,95 @@
+/**
+ * @file abcg_uploadthread.hpp
+ * @brief abcg::UploadThread header file.
+ *
+ * Declaration of abcg::UploadThread class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_UPLOADTHREAD_HPP_
+#define ABCG_UPLOADTHREAD_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class UploadThread;
+}  // namespace abcg
+
+/**
+ * @brief abcg::UploadThread class.
+ *
+ * Runs buffer and texture uploads on a background thread that owns an
+ * OpenGL context shared with the window context, so that large uploads do
+ * not stall the frames.
+ *
+ * Each upload is followed by a fence. abcg::UploadThread::poll, called once
+ * per frame by the thread that renders, calls the ready function of each
+ * upload whose fence is signaled, in submission order. Only then can the
+ * uploaded objects be used for rendering.
+ *
+ * Buffers, textures, samplers, shaders and programs are shared between the
+ * contexts, but vertex array objects and framebuffer objects are not: they
+ * must be created in the ready function.
+ *
+ * When the thread is not started (e.g. with Emscripten, where contexts
+ * cannot be shared), uploads run in abcg::UploadThread::poll, on the thread
+ * that renders.
+ */
+class abcg::UploadThread {
+ public:
+  using UploadFunction = std::function<void()>;
+  using ReadyFunction = std::function<void()>;
+
+  UploadThread() = default;
+  ~UploadThread();
+
+  UploadThread(const UploadThread&) = delete;
+  UploadThread(UploadThread&&) = delete;
+  UploadThread& operator=(const UploadThread&) = delete;
+  UploadThread& operator=(UploadThread&&) = delete;
+
+  void start(SDL_Window* window, SDL_GLContext context);
+  void stop();
+
+  void enqueue(UploadFunction upload, ReadyFunction ready = {});
+  void poll();
+
+  [[nodiscard]] bool isRunning() const noexcept { return m_thread.joinable(); }
+  [[nodiscard]] std::size_t getPendingCount();
+
+ private:
+  struct Task {
+    UploadFunction upload;
+    ReadyFunction ready;
+  };
+
+  struct CompletedTask {
+    GLsync fence{};
+    ReadyFunction ready;
+    std::exception_ptr exception;
+  };
+
+  void work();
+
+  SDL_Window* m_window{};
+  SDL_GLContext m_context{};
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::deque<Task> m_tasks;
+  std::deque<CompletedTask> m_completedTasks;
+  bool m_busy{};
+  bool m_stop{};
+};
+
+#endif
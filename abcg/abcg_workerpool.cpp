@@ -0,0 +1,89 @@
+/**
+ * @file abcg_workerpool.cpp
+ * @brief Definition of abcg::WorkerPool class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_workerpool.hpp"
+
+#include <algorithm>
+
+/**
+ * @brief Starts one worker per hardware thread, minus the calling thread, up
+ * to abcg::WorkerPool::maxThreads threads in total.
+ */
+abcg::WorkerPool::WorkerPool() {
+#if !defined(__EMSCRIPTEN__)
+  const auto numThreads{std::clamp<std::size_t>(
+      std::thread::hardware_concurrency(), 1, maxThreads)};
+  m_threads.reserve(numThreads - 1);
+  for (std::size_t index{1}; index < numThreads; ++index) {
+    m_threads.emplace_back(&WorkerPool::work, this);
+  }
+#endif
+}
+
+abcg::WorkerPool::~WorkerPool() {
+  {
+    const std::scoped_lock lock{m_mutex};
+    m_stop = true;
+  }
+  m_condition.notify_all();
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Returns the pool shared by the library, started on the first call.
+ */
+abcg::WorkerPool &abcg::WorkerPool::shared() {
+  static WorkerPool pool;
+  return pool;
+}
+
+void abcg::WorkerPool::run(std::size_t count, Task task,
+                           const void *context) {
+  if (count == 0) return;
+  if (count == 1 || m_threads.empty()) {
+    for (std::size_t index{}; index < count; ++index) {
+      task(context, index);
+    }
+    return;
+  }
+
+  Job job{.task = task, .context = context, .count = count};
+  std::unique_lock lock{m_mutex};
+  m_jobs.push_back(&job);
+  m_condition.notify_all();
+
+  // Run iterations until none is left to start, then wait for the workers
+  while (job.next < job.count) {
+    const auto index{job.next++};
+    if (job.next == job.count) std::erase(m_jobs, &job);
+    lock.unlock();
+    task(context, index);
+    lock.lock();
+    ++job.done;
+  }
+  m_doneCondition.wait(lock, [&job] { return job.done == job.count; });
+}
+
+void abcg::WorkerPool::work() {
+  std::unique_lock lock{m_mutex};
+  while (true) {
+    m_condition.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+    if (m_jobs.empty()) return;
+
+    auto &job{*m_jobs.front()};
+    const auto index{job.next++};
+    if (job.next == job.count) m_jobs.pop_front();
+    lock.unlock();
+
+    job.task(job.context, index);
+
+    lock.lock();
+    if (++job.done == job.count) m_doneCondition.notify_all();
+  }
+}
@@ -0,0 +1,104 @@
+/**
+ * @file abcg_workerpool.hpp
+ * @brief abcg::WorkerPool header file.
+ *
+ * Declaration of abcg::WorkerPool class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_WORKERPOOL_HPP_
+#define ABCG_WORKERPOOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace abcg {
+class WorkerPool;
+}  // namespace abcg
+
+/**
+ * @brief abcg::WorkerPool class.
+ *
+ * Persistent worker threads that run the iterations of parallel loops, so
+ * that per-frame work such as frustum culling, scene updates and light
+ * binning does not create and join threads on every call.
+ *
+ * abcg::WorkerPool::shared returns the pool used by the library. The calling
+ * thread runs iterations too, so loops can be started from several threads
+ * at once, and from inside an iteration of another loop.
+ *
+ * With Emscripten, the pool has no workers and loops run on the calling
+ * thread.
+ */
+class abcg::WorkerPool {
+ public:
+  static constexpr std::size_t maxThreads{8};
+
+  WorkerPool();
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool(WorkerPool&&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+  WorkerPool& operator=(WorkerPool&&) = delete;
+
+  [[nodiscard]] static WorkerPool& shared();
+
+  /**
+   * @brief Calls function(index) for each index in [0, count), in parallel,
+   * and returns when all calls have returned.
+   *
+   * @param count Number of iterations, usually the number of ranges the work
+   * is split into.
+   * @param function Function called with the index of each iteration. Must
+   * not throw.
+   */
+  template <typename Function>
+  void parallelFor(std::size_t count, const Function& function) {
+    run(count,
+        [](const void* context, std::size_t index) {
+          (*static_cast<const Function*>(context))(index);
+        },
+        std::addressof(function));
+  }
+
+  /**
+   * @brief Returns the number of threads that run iterations, including the
+   * calling thread.
+   */
+  [[nodiscard]] std::size_t getThreadCount() const noexcept {
+    return m_threads.size() + 1;
+  }
+
+ private:
+  using Task = void (*)(const void*, std::size_t);
+
+  struct Job {
+    Task task{};
+    const void* context{};
+    std::size_t count{};
+    // Next iteration to start, and number of finished iterations
+    std::size_t next{};
+    std::size_t done{};
+  };
+
+  void run(std::size_t count, Task task, const void* context);
+  void work();
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::condition_variable m_doneCondition;
+  // Jobs with iterations left to start, oldest first
+  std::deque<Job*> m_jobs;
+  bool m_stop{};
+};
+
+#endif
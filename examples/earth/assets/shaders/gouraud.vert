@@ -42,6 +42,8 @@ vec4 Phong(vec3 N, vec3 L, vec3 V) {
   return ambientColor + diffuseColor + specularColor;
 }
 
+invariant gl_Position;
+
 void main() {
   vec3 P = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
   vec3 N = normalMatrix * inNormal;
@@ -3,7 +3,10 @@
 #include <fmt/core.h>
 #include <tiny_obj_loader.h>
 
+#include <array>
 #include <cppitertools/itertools.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <glm/gtx/hash.hpp>
 #include <unordered_map>
@@ -119,6 +122,23 @@ void Model::createBuffers() {
   abcg::glDeleteBuffers(1, &m_EBO);
   abcg::glDeleteBuffers(1, &m_VBO);
 
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (abcg::isDirectStateAccessSupported()) {
+    // Immutable storage, filled without binding the buffers
+    abcg::glCreateBuffers(1, &m_VBO);
+    abcg::glNamedBufferStorage(
+        m_VBO,
+        static_cast<GLsizeiptr>(sizeof(m_vertices[0]) * m_vertices.size()),
+        m_vertices.data(), 0);
+
+    abcg::glCreateBuffers(1, &m_EBO);
+    abcg::glNamedBufferStorage(
+        m_EBO, static_cast<GLsizeiptr>(sizeof(m_indices[0]) * m_indices.size()),
+        m_indices.data(), 0);
+    return;
+  }
+#endif
+
   // VBO
   abcg::glGenBuffers(1, &m_VBO);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
@@ -135,6 +155,37 @@ void Model::createBuffers() {
   abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+void Model::createPositionBuffers() {
+  // Delete previous VAO and buffer
+  abcg::glDeleteVertexArrays(1, &m_positionVAO);
+  abcg::glDeleteBuffers(1, &m_positionVBO);
+
+  std::vector<glm::vec3> positions;
+  positions.reserve(m_vertices.size());
+  for (const auto& vertex : m_vertices) {
+    positions.push_back(vertex.position);
+  }
+
+  // VBO
+  abcg::glGenBuffers(1, &m_positionVBO);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_positionVBO);
+  abcg::glBufferData(GL_ARRAY_BUFFER, sizeof(positions[0]) * positions.size(),
+                     positions.data(), GL_STATIC_DRAW);
+
+  // VAO sharing the EBO. The pre-pass shader reads inPosition from
+  // location 0
+  abcg::glGenVertexArrays(1, &m_positionVAO);
+  abcg::glBindVertexArray(m_positionVAO);
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+  abcg::glEnableVertexAttribArray(0);
+  abcg::glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3),
+                              nullptr);
+
+  // End of binding
+  abcg::glBindVertexArray(0);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void Model::loadDiffuseTexture(std::string_view path) {
   if (!std::filesystem::exists(path)) return;
 
@@ -272,6 +323,7 @@ void Model::loadObj(std::string_view path, bool standardize) {
   }
 
   createBuffers();
+  createPositionBuffers();
 }
 
 void Model::render(int numTriangles) const {
@@ -283,13 +335,24 @@ void Model::render(int numTriangles) const {
   abcg::glActiveTexture(GL_TEXTURE1);
   abcg::glBindTexture(GL_TEXTURE_2D, m_normalTexture);
 
-  // Set minification and magnification parameters
-  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  // Filtering and wrapping parameters are taken from the sampler object
+  abcg::glBindSampler(0, m_sampler);
+  abcg::glBindSampler(1, m_sampler);
 
-  // Set texture wrapping parameters
-  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  const auto numIndices{(numTriangles < 0) ? m_indices.size()
+                                           : numTriangles * 3};
+
+  abcg::glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(numIndices),
+                       GL_UNSIGNED_INT, nullptr);
+
+  abcg::glBindSampler(0, 0);
+  abcg::glBindSampler(1, 0);
+
+  abcg::glBindVertexArray(0);
+}
+
+void Model::renderPositions(int numTriangles) const {
+  abcg::glBindVertexArray(m_positionVAO);
 
   const auto numIndices{(numTriangles < 0) ? m_indices.size()
                                            : numTriangles * 3};
@@ -304,6 +367,40 @@ void Model::setupVAO(GLuint program) {
   // Release previous VAO
   abcg::glDeleteVertexArrays(1, &m_VAO);
 
+  struct Attribute {
+    const char* name{};
+    GLint size{};
+    GLuint offset{};
+  };
+  const std::array attributes{
+      Attribute{"inPosition", 3, offsetof(Vertex, position)},
+      Attribute{"inNormal", 3, offsetof(Vertex, normal)},
+      Attribute{"inTexCoord", 2, offsetof(Vertex, texCoord)},
+      Attribute{"inTangent", 4, offsetof(Vertex, tangent)}};
+
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (abcg::isDirectStateAccessSupported()) {
+    // Create VAO and attach EBO and VBO without binding them
+    abcg::glCreateVertexArrays(1, &m_VAO);
+    abcg::glVertexArrayElementBuffer(m_VAO, m_EBO);
+    abcg::glVertexArrayVertexBuffer(m_VAO, 0, m_VBO, 0, sizeof(Vertex));
+
+    // Set vertex attribute formats, all sourced from binding point 0
+    for (const auto& attribute : attributes) {
+      const GLint location{abcg::glGetAttribLocation(program, attribute.name)};
+      if (location < 0) continue;
+      const auto index{static_cast<GLuint>(location)};
+      abcg::glEnableVertexArrayAttrib(m_VAO, index);
+      abcg::glVertexArrayAttribFormat(m_VAO, index, attribute.size, GL_FLOAT,
+                                      GL_FALSE, attribute.offset);
+      abcg::glVertexArrayAttribBinding(m_VAO, index, 0);
+    }
+
+    m_sampler = abcg::opengl::getSampler(m_samplerSettings);
+    return;
+  }
+#endif
+
   // Create VAO
   abcg::glGenVertexArrays(1, &m_VAO);
   abcg::glBindVertexArray(m_VAO);
@@ -313,46 +410,20 @@ void Model::setupVAO(GLuint program) {
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
 
   // Bind vertex attributes
-  const GLint positionAttribute{
-      abcg::glGetAttribLocation(program, "inPosition")};
-  if (positionAttribute >= 0) {
-    abcg::glEnableVertexAttribArray(positionAttribute);
-    abcg::glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex), nullptr);
-  }
-
-  const GLint normalAttribute{abcg::glGetAttribLocation(program, "inNormal")};
-  if (normalAttribute >= 0) {
-    abcg::glEnableVertexAttribArray(normalAttribute);
-    GLsizei offset{sizeof(glm::vec3)};
-    abcg::glVertexAttribPointer(normalAttribute, 3, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex),
-                                reinterpret_cast<void*>(offset));
-  }
-
-  const GLint texCoordAttribute{
-      abcg::glGetAttribLocation(program, "inTexCoord")};
-  if (texCoordAttribute >= 0) {
-    abcg::glEnableVertexAttribArray(texCoordAttribute);
-    GLsizei offset{sizeof(glm::vec3) + sizeof(glm::vec3)};
-    abcg::glVertexAttribPointer(texCoordAttribute, 2, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex),
-                                reinterpret_cast<void*>(offset));
-  }
-
-  const GLint tangentCoordAttribute{
-      abcg::glGetAttribLocation(program, "inTangent")};
-  if (tangentCoordAttribute >= 0) {
-    abcg::glEnableVertexAttribArray(tangentCoordAttribute);
-    GLsizei offset{sizeof(glm::vec3) + sizeof(glm::vec3) + sizeof(glm::vec2)};
-    abcg::glVertexAttribPointer(tangentCoordAttribute, 4, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex),
-                                reinterpret_cast<void*>(offset));
+  for (const auto& attribute : attributes) {
+    const GLint location{abcg::glGetAttribLocation(program, attribute.name)};
+    if (location < 0) continue;
+    abcg::glEnableVertexAttribArray(location);
+    abcg::glVertexAttribPointer(
+        location, attribute.size, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+        reinterpret_cast<void*>(static_cast<std::uintptr_t>(attribute.offset)));
   }
 
   // End of binding
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
   abcg::glBindVertexArray(0);
+
+  m_sampler = abcg::opengl::getSampler(m_samplerSettings);
 }
 
 void Model::standardize() {
@@ -384,4 +455,6 @@ void Model::terminateGL() {
   abcg::glDeleteBuffers(1, &m_EBO);
   abcg::glDeleteBuffers(1, &m_VBO);
   abcg::glDeleteVertexArrays(1, &m_VAO);
+  abcg::glDeleteBuffers(1, &m_positionVBO);
+  abcg::glDeleteVertexArrays(1, &m_positionVAO);
 }
\ No newline at end of file
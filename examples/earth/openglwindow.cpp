@@ -48,6 +48,10 @@ void OpenGLWindow::initializeGL() {
     m_programs.push_back(program);
   }
 
+  const auto prepassPath{getAssetsPath() + "shaders/prepass"};
+  m_prepassProgram =
+      createProgramFromFile(prepassPath + ".vert", prepassPath + ".frag");
+
   // Load default model
   loadModel(getAssetsPath() + "ball.obj");
   m_mappingMode = 3;  // "From mesh" option
@@ -77,7 +81,11 @@ void OpenGLWindow::paintGL() {
   update();
 
   abcg::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  abcg::glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+  abcg::glViewport(0, 0, getRenderWidth(), getRenderHeight());
+
+  if (m_depthPrepass) {
+    renderDepthPrepass();
+  }
 
   // Use currently selected program
   const auto program{m_programs.at(m_currentProgramIndex)};
@@ -131,6 +139,40 @@ void OpenGLWindow::paintGL() {
 
   m_model.render(m_trianglesToDraw);
 
+  if (m_depthPrepass) {
+    // Restore the default depth state
+    abcg::glDepthFunc(GL_LESS);
+    abcg::glDepthMask(GL_TRUE);
+  }
+
+  abcg::glUseProgram(0);
+}
+
+void OpenGLWindow::renderDepthPrepass() {
+  abcg::glUseProgram(m_prepassProgram);
+
+  // Get location of uniform variables
+  const GLint viewMatrixLoc{
+      abcg::glGetUniformLocation(m_prepassProgram, "viewMatrix")};
+  const GLint projMatrixLoc{
+      abcg::glGetUniformLocation(m_prepassProgram, "projMatrix")};
+  const GLint modelMatrixLoc{
+      abcg::glGetUniformLocation(m_prepassProgram, "modelMatrix")};
+
+  // Set uniform variables
+  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
+  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
+  abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &m_modelMatrix[0][0]);
+
+  // Write depth only
+  abcg::glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  m_model.renderPositions(m_trianglesToDraw);
+  abcg::glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+  // The main pass only shades the fragments that passed the pre-pass
+  abcg::glDepthFunc(GL_EQUAL);
+  abcg::glDepthMask(GL_FALSE);
+
   abcg::glUseProgram(0);
 }
 
@@ -167,7 +209,7 @@ void OpenGLWindow::paintUI() {
 
   // Create main window widget
   {
-    auto widgetSize{ImVec2(222, 190)};
+    auto widgetSize{ImVec2(222, 214)};
 
     if (!m_model.isUVMapped()) {
       // Add extra space for static text
@@ -213,6 +255,8 @@ void OpenGLWindow::paintUI() {
       abcg::glDisable(GL_CULL_FACE);
     }
 
+    ImGui::Checkbox("Depth pre-pass", &m_depthPrepass);
+
     // CW/CCW combo box
     {
       static std::size_t currentIndex{};
@@ -395,6 +439,7 @@ void OpenGLWindow::terminateGL() {
   for (const auto& program : m_programs) {
     abcg::glDeleteProgram(program);
   }
+  abcg::glDeleteProgram(m_prepassProgram);
 }
 
 void OpenGLWindow::update() {
@@ -8,7 +8,7 @@ int main(int argc, char **argv) {
     abcg::Application app(argc, argv);
 
     auto window{std::make_unique<OpenGLWindow>()};
-    window->setOpenGLSettings({.samples = 4});
+    window->setOpenGLSettings({.fxaa = true});
     window->setWindowSettings(
         {.width = 800, .height = 600, .title = "Flight Simulator"});
 
@@ -11,6 +11,52 @@ uniform vec4 Ia, Id, Is;
 uniform vec4 Ka, Kd, Ks;
 uniform float shininess;
 
+// Point lights binned into clusters by abcg::LightClusters
+uniform highp sampler2D lightsTex;
+uniform highp usampler2D clustersTex;
+uniform highp usampler2D lightIndicesTex;
+uniform ivec3 clusterGrid;
+uniform vec2 clusterTileScale;
+uniform vec2 clusterDepthScaleBias;
+
+// Texel of an element of a texture used as an array
+ivec2 ArrayTexel(int index, int width) {
+  return ivec2(index % width, index / width);
+}
+
+// Offset and number of the light indices of the cluster of the fragment
+uvec2 ClusterLights(vec3 PEye) {
+  ivec2 tile = clamp(ivec2(gl_FragCoord.xy * clusterTileScale), ivec2(0),
+                     clusterGrid.xy - 1);
+  int slice = int(log(-PEye.z) * clusterDepthScaleBias.x -
+                  clusterDepthScaleBias.y);
+  slice = clamp(slice, 0, clusterGrid.z - 1);
+  return texelFetch(clustersTex, ivec2(tile.x + tile.y * clusterGrid.x, slice),
+                    0).xy;
+}
+
+// Eye-space direction to the index-th light of the cluster, and its color
+// attenuated with the distance. The color is zero beyond the radius
+vec3 ClusterLight(uvec2 lights, uint index, vec3 PEye, out vec3 L) {
+  int indexWidth = textureSize(lightIndicesTex, 0).x;
+  int lightsWidth = textureSize(lightsTex, 0).x;
+  int light = int(texelFetch(lightIndicesTex,
+                             ArrayTexel(int(lights.x + index), indexWidth), 0)
+                      .r);
+  vec4 positionRadius =
+      texelFetch(lightsTex, ArrayTexel(2 * light, lightsWidth), 0);
+  vec3 color = texelFetch(lightsTex, ArrayTexel(2 * light + 1, lightsWidth), 0)
+                   .rgb;
+
+  L = positionRadius.xyz - PEye;
+  float distance = length(L);
+  L /= max(distance, 1e-6);
+
+  // Smooth falloff to zero at the radius
+  float falloff = clamp(1.0 - pow(distance / positionRadius.w, 2.0), 0.0, 1.0);
+  return color * falloff * falloff;
+}
+
 out vec4 outColor;
 
 vec4 BlinnPhong(vec3 N, vec3 L, vec3 V) {
@@ -36,8 +82,32 @@ vec4 BlinnPhong(vec3 N, vec3 L, vec3 V) {
   return ambientColor + diffuseColor + specularColor;
 }
 
+// Diffuse and specular terms of the point lights of the cluster
+vec4 PointLights(vec3 N, vec3 V) {
+  N = normalize(N);
+  V = normalize(V);
+
+  vec3 PEye = -fragV;
+  uvec2 lights = ClusterLights(PEye);
+  vec4 color = vec4(0.0);
+  for (uint index = 0u; index < lights.y; ++index) {
+    vec3 L;
+    vec3 lightColor = ClusterLight(lights, index, PEye, L);
+
+    float lambertian = max(dot(N, L), 0.0);
+    float specular = 0.0;
+    if (lambertian > 0.0) {
+      vec3 H = normalize(L + V);
+      specular = pow(max(dot(H, N), 0.0), shininess);
+    }
+
+    color += (Kd * lambertian + Ks * specular) * vec4(lightColor, 0.0);
+  }
+  return color;
+}
+
 void main() {
-  vec4 color = BlinnPhong(fragN, fragL, fragV);
+  vec4 color = BlinnPhong(fragN, fragL, fragV) + PointLights(fragN, fragV);
 
   if (gl_FrontFacing) {
     outColor = color;
@@ -8,11 +8,13 @@ uniform mat4 projMatrix;
 
 out vec4 fragColor;
 
+invariant gl_Position;
+
 void main() {
-  vec4 posEyeSpace = viewMatrix * modelMatrix * vec4(inPosition, 1);
+  vec3 P = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
 
-  float i = 1.0 - (-posEyeSpace.z / 3.0);
+  float i = 1.0 - (-P.z / 3.0);
   fragColor = vec4(i, i, i, 1);
 
-  gl_Position = projMatrix * posEyeSpace;
+  gl_Position = projMatrix * vec4(P, 1.0);
 }
\ No newline at end of file
@@ -18,6 +18,52 @@ uniform vec4 Ia, Id, Is;
 uniform vec4 Ka, Kd, Ks;
 uniform float shininess;
 
+// Point lights binned into clusters by abcg::LightClusters
+uniform highp sampler2D lightsTex;
+uniform highp usampler2D clustersTex;
+uniform highp usampler2D lightIndicesTex;
+uniform ivec3 clusterGrid;
+uniform vec2 clusterTileScale;
+uniform vec2 clusterDepthScaleBias;
+
+// Texel of an element of a texture used as an array
+ivec2 ArrayTexel(int index, int width) {
+  return ivec2(index % width, index / width);
+}
+
+// Offset and number of the light indices of the cluster of the fragment
+uvec2 ClusterLights(vec3 PEye) {
+  ivec2 tile = clamp(ivec2(gl_FragCoord.xy * clusterTileScale), ivec2(0),
+                     clusterGrid.xy - 1);
+  int slice = int(log(-PEye.z) * clusterDepthScaleBias.x -
+                  clusterDepthScaleBias.y);
+  slice = clamp(slice, 0, clusterGrid.z - 1);
+  return texelFetch(clustersTex, ivec2(tile.x + tile.y * clusterGrid.x, slice),
+                    0).xy;
+}
+
+// Eye-space direction to the index-th light of the cluster, and its color
+// attenuated with the distance. The color is zero beyond the radius
+vec3 ClusterLight(uvec2 lights, uint index, vec3 PEye, out vec3 L) {
+  int indexWidth = textureSize(lightIndicesTex, 0).x;
+  int lightsWidth = textureSize(lightsTex, 0).x;
+  int light = int(texelFetch(lightIndicesTex,
+                             ArrayTexel(int(lights.x + index), indexWidth), 0)
+                      .r);
+  vec4 positionRadius =
+      texelFetch(lightsTex, ArrayTexel(2 * light, lightsWidth), 0);
+  vec3 color = texelFetch(lightsTex, ArrayTexel(2 * light + 1, lightsWidth), 0)
+                   .rgb;
+
+  L = positionRadius.xyz - PEye;
+  float distance = length(L);
+  L /= max(distance, 1e-6);
+
+  // Smooth falloff to zero at the radius
+  float falloff = clamp(1.0 - pow(distance / positionRadius.w, 2.0), 0.0, 1.0);
+  return color * falloff * falloff;
+}
+
 // Diffuse map sampler
 uniform sampler2D diffuseTex;
 
@@ -66,6 +112,33 @@ vec4 BlinnPhong(vec3 N, vec3 L, vec3 V, vec2 texCoord) {
   return ambientColor + diffuseColor + specularColor;
 }
 
+// Diffuse and specular terms of the point lights of the cluster, in tangent
+// space
+vec4 PointLights(vec3 N, vec3 V, mat3 TBN, vec2 texCoord) {
+  N = normalize(N);
+  V = normalize(V);
+  vec4 map_Kd = texture(diffuseTex, texCoord);
+
+  vec3 PEye = -fragVEye;
+  uvec2 lights = ClusterLights(PEye);
+  vec4 color = vec4(0.0);
+  for (uint index = 0u; index < lights.y; ++index) {
+    vec3 LEye;
+    vec3 lightColor = ClusterLight(lights, index, PEye, LEye);
+    vec3 L = normalize(TBN * LEye);
+
+    float lambertian = max(dot(N, L), 0.0);
+    float specular = 0.0;
+    if (lambertian > 0.0) {
+      vec3 H = normalize(L + V);
+      specular = pow(max(dot(H, N), 0.0), shininess);
+    }
+
+    color += (map_Kd * Kd * lambertian + Ks * specular) * vec4(lightColor, 0.0);
+  }
+  return color;
+}
+
 // Planar mapping
 vec2 PlanarMappingXUV(vec3 P) { return vec2(1.0 - P.z, P.y); }
 mat3 PlanarMappingXTBN(vec3 P) {
@@ -145,7 +218,8 @@ void main() {
     vec3 VTan = TBN * normalize(fragVEye);
     vec3 NTan = texture(normalTex, texCoord1).xyz;
     NTan = normalize(NTan * 2.0 - 1.0);  // From [0, 1] to [-1, 1]
-    vec4 color1 = BlinnPhong(NTan, LTan, VTan, texCoord1);
+    vec4 color1 = BlinnPhong(NTan, LTan, VTan, texCoord1) +
+                  PointLights(NTan, VTan, TBN, texCoord1);
 
     // Sample with y planar mapping
     vec2 texCoord2 = PlanarMappingYUV(fragPObj + offset);
@@ -154,7 +228,8 @@ void main() {
     VTan = TBN * normalize(fragVEye);
     NTan = texture(normalTex, texCoord2).xyz;
     NTan = normalize(NTan * 2.0 - 1.0);  // From [0, 1] to [-1, 1]
-    vec4 color2 = BlinnPhong(NTan, LTan, VTan, texCoord2);
+    vec4 color2 = BlinnPhong(NTan, LTan, VTan, texCoord2) +
+                  PointLights(NTan, VTan, TBN, texCoord2);
 
     // Sample with z planar mapping
     vec2 texCoord3 = PlanarMappingZUV(fragPObj + offset);
@@ -163,7 +238,8 @@ void main() {
     VTan = TBN * normalize(fragVEye);
     NTan = texture(normalTex, texCoord3).xyz;
     NTan = normalize(NTan * 2.0 - 1.0);  // From [0, 1] to [-1, 1]
-    vec4 color3 = BlinnPhong(NTan, LTan, VTan, texCoord3);
+    vec4 color3 = BlinnPhong(NTan, LTan, VTan, texCoord3) +
+                  PointLights(NTan, VTan, TBN, texCoord3);
 
     // Compute average based on normal
     vec3 weight = abs(normalize(fragNObj));
@@ -191,7 +267,8 @@ void main() {
     vec3 NTan = texture(normalTex, texCoord).xyz;
     NTan = normalize(NTan * 2.0 - 1.0);  // From [0, 1] to [-1, 1]
 
-    color = BlinnPhong(NTan, LTan, VTan, texCoord);
+    color = BlinnPhong(NTan, LTan, VTan, texCoord) +
+            PointLights(NTan, VTan, TBN, texCoord);
   }
 
   if (gl_FrontFacing) {
@@ -19,6 +19,8 @@ out vec3 fragNObj;
 out vec3 fragLEye;
 out vec3 fragVEye;
 
+invariant gl_Position;
+
 void main() {
   vec3 PEye = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
   vec3 LEye = -(viewMatrix * lightDirWorldSpace).xyz;
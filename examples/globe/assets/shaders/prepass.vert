@@ -0,0 +1,17 @@
+#version 410
+
+layout(location = 0) in vec3 inPosition;
+
+uniform mat4 modelMatrix;
+uniform mat4 viewMatrix;
+uniform mat4 projMatrix;
+
+// Computed exactly as in the shaders of the main pass, which is drawn with
+// GL_EQUAL depth testing
+invariant gl_Position;
+
+void main() {
+  vec3 P = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
+
+  gl_Position = projMatrix * vec4(P, 1.0);
+}
\ No newline at end of file
@@ -8,7 +8,8 @@ int main(int argc, char **argv) {
     abcg::Application app(argc, argv);
 
     auto window{std::make_unique<OpenGLWindow>()};
-    window->setOpenGLSettings({.samples = 0});
+    window->setOpenGLSettings(
+        {.samples = 0, .uploadThread = true, .supportsRenderScale = true});
     window->setWindowSettings(
         {.width = 600, .height = 600, .title = "Model Viewer (version 5)"});
 
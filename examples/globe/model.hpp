@@ -22,9 +22,18 @@ struct Vertex {
 class Model {
  public:
   void loadDiffuseTexture(std::string_view path);
+  void loadDiffuseTexture(std::string_view path,
+                          abcg::UploadThread& uploadThread);
   void loadNormalTexture(std::string_view path);
+  void loadNormalTexture(std::string_view path,
+                         abcg::UploadThread& uploadThread);
   void loadObj(std::string_view path, bool standardize = true);
   void render(int numTriangles = -1) const;
+  void renderPositions(int numTriangles = -1) const;
+  void record(abcg::CommandList& commandList, GLuint program, float depth,
+              int numTriangles = -1) const;
+  void recordPositions(abcg::CommandList& commandList, GLuint program,
+                       float depth, int numTriangles = -1) const;
   void setupVAO(GLuint program);
   void terminateGL();
 
@@ -39,11 +48,19 @@ class Model {
 
   [[nodiscard]] bool isUVMapped() const { return m_hasTexCoords; }
 
+  // Axis-aligned bounding box, in model space
+  [[nodiscard]] glm::vec3 getBoundsMin() const { return m_boundsMin; }
+  [[nodiscard]] glm::vec3 getBoundsMax() const { return m_boundsMax; }
+
  private:
   GLuint m_VAO{};
   GLuint m_VBO{};
   GLuint m_EBO{};
 
+  // Tightly packed positions, drawn by the depth pre-pass
+  GLuint m_positionVAO{};
+  GLuint m_positionVBO{};
+
   glm::vec4 m_Ka;
   glm::vec4 m_Kd;
   glm::vec4 m_Ks;
@@ -51,15 +68,26 @@ class Model {
   GLuint m_diffuseTexture{};
   GLuint m_normalTexture{};
 
+  // Trilinear filtering with anisotropy, shared by the diffuse and normal maps
+  abcg::opengl::SamplerSettings m_samplerSettings{.maxAnisotropy = 16.0f};
+  GLuint m_sampler{};
+
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
 
   bool m_hasNormals{false};
   bool m_hasTexCoords{false};
 
+  glm::vec3 m_boundsMin{};
+  glm::vec3 m_boundsMax{};
+
+  void computeBounds();
   void computeNormals();
   void computeTangents();
   void createBuffers();
+  void createPositionBuffers();
+  static void loadTexture(std::string_view path,
+                          abcg::UploadThread& uploadThread, GLuint& texture);
   void standardize();
 };
 
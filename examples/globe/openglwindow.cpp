@@ -2,8 +2,15 @@
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <any>
+#include <cmath>
 #include <cppitertools/itertools.hpp>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
+#include <random>
+#include <span>
+#include <utility>
 
 #include "imfilebrowser.h"
 
@@ -48,8 +55,21 @@ void OpenGLWindow::initializeGL() {
     m_programs.push_back(program);
   }
 
+  const auto prepassPath{getAssetsPath() + "shaders/prepass"};
+  m_prepassProgram =
+      createProgramFromFile(prepassPath + ".vert", prepassPath + ".frag");
+
+  m_earthNode = m_scene.createNode();
+  m_moonNode = m_scene.createNode(m_earthNode);
+  m_scene.setTranslation(m_moonNode, glm::vec3(1.0f, 0.0f, 0.0f));
+  m_scene.setRotation(m_moonNode, glm::angleAxis(glm::radians(-90.0f),
+                                                 glm::vec3(0, 1, 0)));
+  m_scene.setScale(m_moonNode, glm::vec3(0.2f));
+
+  initializePointLights();
+
   // Load default model
-  loadModel(getAssetsPath() + "Globe.obj");
+  setModelInfo(loadModel(getAssetsPath() + "Globe.obj"));
   m_mappingMode = 3;  // "From mesh" option
 
   loadMoon(getAssetsPath() + "10467_Cratered_Moon_v2_Iterations-2.obj");
@@ -59,40 +79,130 @@ void OpenGLWindow::initializeGL() {
   m_trackBallModel.setVelocity(0.0001f);
 }
 
+void OpenGLWindow::initializePointLights() {
+  m_lightClusters.initialize();
+
+  // Lights of random colors in a shell around the globe
+  std::default_random_engine randomEngine{0};
+  std::uniform_real_distribution<float> angleDistribution{0.0f,
+                                                          glm::two_pi<float>()};
+  std::uniform_real_distribution<float> heightDistribution{-1.0f, 1.0f};
+  std::uniform_real_distribution<float> distanceDistribution{1.1f, 1.6f};
+  std::uniform_real_distribution<float> unitDistribution{0.0f, 1.0f};
+
+  m_pointLights.resize(maxPointLights);
+  for (auto& light : m_pointLights) {
+    const auto angle{angleDistribution(randomEngine)};
+    const auto height{heightDistribution(randomEngine)};
+    const auto ring{std::sqrt(1.0f - height * height)};
+    light.position = glm::vec3(ring * std::cos(angle), height,
+                               ring * std::sin(angle)) *
+                     distanceDistribution(randomEngine);
+    light.radius = 0.3f + 0.3f * unitDistribution(randomEngine);
+    light.color = glm::vec3(unitDistribution(randomEngine),
+                            unitDistribution(randomEngine),
+                            unitDistribution(randomEngine));
+  }
+}
+
 void OpenGLWindow::loadMoon(std::string_view path) {
   m_moon_model.terminateGL();
 
   m_moon_model.loadDiffuseTexture(getAssetsPath() + "maps/pattern.png");
   m_moon_model.loadNormalTexture(getAssetsPath() + "maps/pattern_normal.png");
   m_moon_model.loadObj(path);
-  m_moon_model.setupVAO(m_programs.at(m_currentProgramIndex));
+  m_moon_model.setupVAO(m_programs.at(m_modelProgramIndex));
   m_moon_trianglesToDraw = m_moon_model.getNumTriangles();
+  setLocalBounds(m_moonNode, m_moon_model.getBoundsMin(),
+                 m_moon_model.getBoundsMax());
 }
 
-void OpenGLWindow::loadModel(std::string_view path) {
+// Runs on the thread that renders. The properties used by the main thread are
+// returned rather than applied
+OpenGLWindow::ModelInfo OpenGLWindow::loadModel(std::string_view path) {
   m_model.terminateGL();
 
   m_model.loadDiffuseTexture(getAssetsPath() + "maps/pattern.png");
   m_model.loadNormalTexture(getAssetsPath() + "maps/pattern_normal.png");
   m_model.loadObj(path);
-  m_model.setupVAO(m_programs.at(m_currentProgramIndex));
-  m_trianglesToDraw = m_model.getNumTriangles();
+  m_model.setupVAO(m_programs.at(m_modelProgramIndex));
+
+  return {.numTriangles = m_model.getNumTriangles(),
+          .uvMapped = m_model.isUVMapped(),
+          .boundsMin = m_model.getBoundsMin(),
+          .boundsMax = m_model.getBoundsMax(),
+          .Ka = m_model.getKa(),
+          .Kd = m_model.getKd(),
+          .Ks = m_model.getKs(),
+          .shininess = m_model.getShininess()};
+}
+
+void OpenGLWindow::setModelInfo(const ModelInfo& info) {
+  m_modelInfo = info;
+  m_trianglesToDraw = info.numTriangles;
+  setLocalBounds(m_earthNode, info.boundsMin, info.boundsMax);
 
   // Use material properties from the loaded model
-  m_Ka = m_model.getKa();
-  m_Kd = m_model.getKd();
-  m_Ks = m_model.getKs();
-  m_shininess = m_model.getShininess();
+  m_Ka = info.Ka;
+  m_Kd = info.Kd;
+  m_Ks = info.Ks;
+  m_shininess = info.shininess;
 }
 
+void OpenGLWindow::setLocalBounds(abcg::Scene::Node node,
+                                  const glm::vec3& boxMin,
+                                  const glm::vec3& boxMax) {
+  m_scene.setLocalBounds(node, (boxMin + boxMax) / 2.0f,
+                         glm::length(boxMax - boxMin) / 2.0f);
+}
+
+// Runs on the render thread, so only the frame packet and the objects owned by
+// the render thread are read
 void OpenGLWindow::paintGL() {
-  update();
+  const auto& packet{getFramePacket()};
+  const auto& state{std::any_cast<const FrameState&>(packet.userData)};
+  const auto& viewMatrix{packet.viewMatrix};
+  const auto& projMatrix{packet.projMatrix};
+
+  if (!state.modelPath.empty()) {
+    const auto info{loadModel(state.modelPath)};
+    const std::scoped_lock lock{m_loadedModelMutex};
+    m_loadedModel = info;
+  }
+
+  // Set up VAO if shader program has changed
+  if (state.programIndex != m_modelProgramIndex) {
+    m_modelProgramIndex = state.programIndex;
+    m_model.setupVAO(m_programs.at(m_modelProgramIndex));
+  }
+
+  if (state.faceCulling) {
+    abcg::glEnable(GL_CULL_FACE);
+  } else {
+    abcg::glDisable(GL_CULL_FACE);
+  }
+  abcg::glFrontFace(state.frontFace);
 
   abcg::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  abcg::glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+  abcg::glViewport(0, 0, getRenderWidth(), getRenderHeight());
+
+  // Set uniform variables of the depth pre-pass
+  const GLint prepassModelMatrixLoc{
+      abcg::glGetUniformLocation(m_prepassProgram, "modelMatrix")};
+  if (state.depthPrepass) {
+    abcg::glUseProgram(m_prepassProgram);
+    const GLint prepassViewMatrixLoc{
+        abcg::glGetUniformLocation(m_prepassProgram, "viewMatrix")};
+    const GLint prepassProjMatrixLoc{
+        abcg::glGetUniformLocation(m_prepassProgram, "projMatrix")};
+    abcg::glUniformMatrix4fv(prepassViewMatrixLoc, 1, GL_FALSE,
+                             &viewMatrix[0][0]);
+    abcg::glUniformMatrix4fv(prepassProjMatrixLoc, 1, GL_FALSE,
+                             &projMatrix[0][0]);
+  }
 
   // Use currently selected program
-  const auto program{m_programs.at(m_currentProgramIndex)};
+  const auto program{m_programs.at(m_modelProgramIndex)};
   abcg::glUseProgram(program);
 
   // Get location of uniform variables
@@ -117,40 +227,93 @@ void OpenGLWindow::paintGL() {
       abcg::glGetUniformLocation(program, "mappingMode")};
 
   // Set uniform variables used by every scene object
-  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
-  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
+  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &viewMatrix[0][0]);
+  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &projMatrix[0][0]);
   abcg::glUniform1i(diffuseTexLoc, 0);
   abcg::glUniform1i(normalTexLoc, 1);
-  abcg::glUniform1i(mappingModeLoc, m_mappingMode);
-
-  const auto lightDirRotated{m_trackBallLight.getRotation() * m_lightDir};
-  abcg::glUniform4fv(lightDirLoc, 1, &lightDirRotated.x);
-  abcg::glUniform4fv(IaLoc, 1, &m_Ia.x);
-  abcg::glUniform4fv(IdLoc, 1, &m_Id.x);
-  abcg::glUniform4fv(IsLoc, 1, &m_Is.x);
+  abcg::glUniform1i(mappingModeLoc, state.mappingMode);
+
+  abcg::glUniform4fv(lightDirLoc, 1, &state.lightDir.x);
+  abcg::glUniform4fv(IaLoc, 1, &state.Ia.x);
+  abcg::glUniform4fv(IdLoc, 1, &state.Id.x);
+  abcg::glUniform4fv(IsLoc, 1, &state.Is.x);
+
+  abcg::glUniform1f(shininessLoc, state.shininess);
+  abcg::glUniform4fv(KaLoc, 1, &state.Ka.x);
+  abcg::glUniform4fv(KdLoc, 1, &state.Kd.x);
+  abcg::glUniform4fv(KsLoc, 1, &state.Ks.x);
+
+  // Same near and far planes as the projections set in paintUI
+  m_lightClusters.update(state.pointLights, viewMatrix, projMatrix, 0.1f,
+                         5.0f);
+  m_lightClusters.bind(program, {getRenderWidth(), getRenderHeight()});
+
+  // Record the draws with the uniform variables of each object
+  abcg::CommandList prepassCommandList;
+  abcg::CommandList commandList;
+
+  // Counted every frame, so that the depths of the frames rendered before
+  // occlusion culling was disabled are not used when it is enabled again
+  m_hiZBuffer.beginFrame(packet.frame);
+
+  const auto recordObject{[&](Object object, const Model& model) {
+    if (!state.visible.at(object)) return;
+
+    const auto& modelMatrix{packet.transforms.at(object)};
+    if (state.occlusionCulling &&
+        m_hiZBuffer.isOccluded(model.getBoundsMin(), model.getBoundsMax(),
+                               modelMatrix)) {
+      return;
+    }
 
-  // Set uniform variables of the current object
-  abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &m_modelMatrix[0][0]);
+    // The UI may still hold the count of the previous model when a new one
+    // has just been loaded
+    const auto trianglesToDraw{
+        std::min(state.trianglesToDraw.at(object), model.getNumTriangles())};
+    const auto viewDepth{state.depths.at(object)};
 
-  const auto modelViewMatrix{glm::mat3(m_viewMatrix * m_modelMatrix)};
-  glm::mat3 normalMatrix{glm::inverseTranspose(modelViewMatrix)};
-  abcg::glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, &normalMatrix[0][0]);
+    if (state.depthPrepass) {
+      prepassCommandList.setUniform(prepassModelMatrixLoc, modelMatrix);
+      model.recordPositions(prepassCommandList, m_prepassProgram, viewDepth,
+                            trianglesToDraw);
+    }
 
-  abcg::glUniform1f(shininessLoc, m_shininess);
-  abcg::glUniform4fv(KaLoc, 1, &m_Ka.x);
-  abcg::glUniform4fv(KdLoc, 1, &m_Kd.x);
-  abcg::glUniform4fv(KsLoc, 1, &m_Ks.x);
+    const auto modelViewMatrix{glm::mat3(viewMatrix * modelMatrix)};
+    const glm::mat3 normalMatrix{glm::inverseTranspose(modelViewMatrix)};
+    commandList.setUniform(modelMatrixLoc, modelMatrix);
+    commandList.setUniform(normalMatrixLoc, normalMatrix);
+    model.record(commandList, program, viewDepth, trianglesToDraw);
+  }};
+
+  recordObject(Earth, m_model);
+  recordObject(Moon, m_moon_model);
+
+  if (state.depthPrepass) {
+    // Write depth only
+    abcg::glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    m_renderQueue.submit(std::move(prepassCommandList));
+    m_renderQueue.execute();
+    abcg::glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // The main pass only shades the fragments that passed the pre-pass
+    abcg::glDepthFunc(GL_EQUAL);
+    abcg::glDepthMask(GL_FALSE);
+  }
 
-  m_model.render(m_trianglesToDraw);
+  m_renderQueue.submit(std::move(commandList));
+  m_renderQueue.execute();
 
-  glm::mat4 model{1.0f};
-  model = glm::mat4(1.0);
-  model = glm::translate(model, glm::vec3(1.0f, 0.0f, 0.0f));
-  model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0, 1, 0));
-  model = glm::scale(model, glm::vec3(0.2f));
+  if (state.depthPrepass) {
+    // Restore the default depth state
+    abcg::glDepthFunc(GL_LESS);
+    abcg::glDepthMask(GL_TRUE);
+  }
 
-  abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &model[0][0]);
-  m_moon_model.render(m_moon_trianglesToDraw);
+  // Build the depth pyramid tested by the next frames
+  if (state.occlusionCulling) {
+    m_hiZBuffer.update(getRenderWidth(), getRenderHeight(),
+                       projMatrix * viewMatrix);
+  }
 
   abcg::glUseProgram(0);
 }
@@ -158,6 +321,27 @@ void OpenGLWindow::paintGL() {
 void OpenGLWindow::paintUI() {
   abcg::OpenGLWindow::paintUI();
 
+  // Tracked here rather than in resizeGL, which runs on the render thread
+  const auto displaySize{ImGui::GetIO().DisplaySize};
+  resizeViewport(static_cast<int>(displaySize.x),
+                 static_cast<int>(displaySize.y));
+
+  // Apply the properties of the model loaded by paintGL
+  {
+    const std::scoped_lock lock{m_loadedModelMutex};
+    if (m_loadedModel) {
+      setModelInfo(*m_loadedModel);
+      if (m_loadedModel->uvMapped) {
+        // Use mesh texture coordinates if available...
+        m_mappingMode = 3;
+      } else {
+        // ...or triplanar mapping otherwise
+        m_mappingMode = 0;
+      }
+      m_loadedModel.reset();
+    }
+  }
+
   // File browser for models
   static ImGui::FileBrowser fileDialogModel;
   fileDialogModel.SetTitle("Load 3D Model");
@@ -188,9 +372,9 @@ void OpenGLWindow::paintUI() {
 
   // Create main window widget
   {
-    auto widgetSize{ImVec2(222, 190)};
+    auto widgetSize{ImVec2(222, 238)};
 
-    if (!m_model.isUVMapped()) {
+    if (!m_modelInfo.uvMapped) {
       // Add extra space for static text
       widgetSize.y += 26;
     }
@@ -221,18 +405,15 @@ void OpenGLWindow::paintUI() {
 
     // Slider will be stretched horizontally
     ImGui::PushItemWidth(widgetSize.x - 16);
-    ImGui::SliderInt("", &m_trianglesToDraw, 0, m_model.getNumTriangles(),
+    ImGui::SliderInt("", &m_trianglesToDraw, 0, m_modelInfo.numTriangles,
                      "%d triangles");
     ImGui::PopItemWidth();
 
-    static bool faceCulling{};
-    ImGui::Checkbox("Back-face culling", &faceCulling);
+    ImGui::Checkbox("Back-face culling", &m_faceCulling);
 
-    if (faceCulling) {
-      abcg::glEnable(GL_CULL_FACE);
-    } else {
-      abcg::glDisable(GL_CULL_FACE);
-    }
+    ImGui::Checkbox("Depth pre-pass", &m_depthPrepass);
+
+    ImGui::Checkbox("Occlusion culling", &m_occlusionCulling);
 
     // CW/CCW combo box
     {
@@ -253,9 +434,9 @@ void OpenGLWindow::paintUI() {
       ImGui::PopItemWidth();
 
       if (currentIndex == 0) {
-        abcg::glFrontFace(GL_CCW);
+        m_frontFace = GL_CCW;
       } else {
-        abcg::glFrontFace(GL_CW);
+        m_frontFace = GL_CW;
       }
     }
 
@@ -305,14 +486,11 @@ void OpenGLWindow::paintUI() {
       }
       ImGui::PopItemWidth();
 
-      // Set up VAO if shader program has changed
-      if (static_cast<int>(currentIndex) != m_currentProgramIndex) {
-        m_currentProgramIndex = currentIndex;
-        m_model.setupVAO(m_programs.at(m_currentProgramIndex));
-      }
+      // The VAO is set up again by paintGL
+      m_currentProgramIndex = static_cast<int>(currentIndex);
     }
 
-    if (!m_model.isUVMapped()) {
+    if (!m_modelInfo.uvMapped) {
       ImGui::TextColored(ImVec4(1, 1, 0, 1), "Mesh has no UV coords.");
     }
 
@@ -321,7 +499,7 @@ void OpenGLWindow::paintUI() {
       std::vector<std::string> comboItems{"Triplanar", "Cylindrical",
                                           "Spherical"};
 
-      if (m_model.isUVMapped()) comboItems.emplace_back("From mesh");
+      if (m_modelInfo.uvMapped) comboItems.emplace_back("From mesh");
 
       ImGui::PushItemWidth(120);
       if (ImGui::BeginCombo("UV mapping",
@@ -342,7 +520,7 @@ void OpenGLWindow::paintUI() {
 
   // Create window for light sources
   if (m_currentProgramIndex < 4) {
-    const auto widgetSize{ImVec2(222, 244)};
+    const auto widgetSize{ImVec2(222, 268)};
     ImGui::SetNextWindowPos(ImVec2(m_viewportWidth - widgetSize.x - 5,
                                    m_viewportHeight - widgetSize.y - 5));
     ImGui::SetNextWindowSize(widgetSize);
@@ -371,6 +549,8 @@ void OpenGLWindow::paintUI() {
     // Slider to control the specular shininess
     ImGui::PushItemWidth(widgetSize.x - 16);
     ImGui::SliderFloat("", &m_shininess, 0.0f, 500.0f, "shininess: %.1f");
+    ImGui::SliderInt("##pointLights", &m_numPointLights, 0, maxPointLights,
+                     "%d point lights");
     ImGui::PopItemWidth();
 
     ImGui::End();
@@ -378,32 +558,78 @@ void OpenGLWindow::paintUI() {
 
   fileDialogModel.Display();
   if (fileDialogModel.HasSelected()) {
-    loadModel(fileDialogModel.GetSelected().string());
+    // Loaded by paintGL, which owns the models
+    m_modelPath = fileDialogModel.GetSelected().string();
     fileDialogModel.ClearSelected();
-
-    if (m_model.isUVMapped()) {
-      // Use mesh texture coordinates if available...
-      m_mappingMode = 3;
-    } else {
-      // ...or triplanar mapping otherwise
-      m_mappingMode = 0;
-    }
   }
 
   fileDialogDiffuseMap.Display();
   if (fileDialogDiffuseMap.HasSelected()) {
-    m_model.loadDiffuseTexture(fileDialogDiffuseMap.GetSelected().string());
+    m_model.loadDiffuseTexture(fileDialogDiffuseMap.GetSelected().string(),
+                               getUploadThread());
     fileDialogDiffuseMap.ClearSelected();
   }
 
   fileDialogNormalMap.Display();
   if (fileDialogNormalMap.HasSelected()) {
-    m_model.loadNormalTexture(fileDialogNormalMap.GetSelected().string());
+    m_model.loadNormalTexture(fileDialogNormalMap.GetSelected().string(),
+                              getUploadThread());
     fileDialogNormalMap.ClearSelected();
   }
 }
 
-void OpenGLWindow::resizeGL(int width, int height) {
+void OpenGLWindow::recordFrame(abcg::FramePacket& packet) {
+  update();
+
+  if (!packet.userData.has_value()) packet.userData.emplace<FrameState>();
+  auto& state{std::any_cast<FrameState&>(packet.userData)};
+
+  packet.viewMatrix = m_viewMatrix;
+  packet.projMatrix = m_projMatrix;
+
+  const abcg::Frustum frustum{m_projMatrix * m_viewMatrix};
+  const auto& worldBounds{m_scene.getWorldBounds()};
+  const std::array<abcg::Scene::Node, NumObjects> nodes{m_earthNode,
+                                                        m_moonNode};
+  for (const auto object : iter::range(nodes.size())) {
+    const auto node{nodes.at(object)};
+    const auto center{worldBounds.getCenter(node)};
+    packet.transforms.push_back(m_scene.getWorldMatrix(node));
+    state.visible.at(object) =
+        frustum.isVisible(center, worldBounds.getRadius(node));
+
+    const auto farPlane{5.0f};
+    state.depths.at(object) =
+        -(m_viewMatrix * glm::vec4(center, 1)).z / farPlane;
+  }
+
+  state.trianglesToDraw = {m_trianglesToDraw, m_moon_trianglesToDraw};
+  state.programIndex = m_currentProgramIndex;
+  state.mappingMode = m_mappingMode;
+  state.depthPrepass = m_depthPrepass;
+  state.occlusionCulling = m_occlusionCulling;
+  state.faceCulling = m_faceCulling;
+  state.frontFace = m_frontFace;
+  state.lightDir = m_trackBallLight.getRotation() * m_lightDir;
+  state.Ia = m_Ia;
+  state.Id = m_Id;
+  state.Is = m_Is;
+  state.Ka = m_Ka;
+  state.Kd = m_Kd;
+  state.Ks = m_Ks;
+  state.shininess = m_shininess;
+
+  const std::span pointLights{m_pointLights};
+  const auto activeLights{
+      pointLights.first(static_cast<std::size_t>(m_numPointLights))};
+  state.pointLights.assign(activeLights.begin(), activeLights.end());
+
+  state.modelPath = std::exchange(m_modelPath, {});
+}
+
+void OpenGLWindow::resizeViewport(int width, int height) {
+  if (width == m_viewportWidth && height == m_viewportHeight) return;
+
   m_viewportWidth = width;
   m_viewportHeight = height;
 
@@ -412,14 +638,26 @@ void OpenGLWindow::resizeGL(int width, int height) {
 }
 
 void OpenGLWindow::terminateGL() {
+  m_hiZBuffer.terminate();
+  m_lightClusters.terminate();
   m_model.terminateGL();
   for (const auto& program : m_programs) {
     abcg::glDeleteProgram(program);
   }
+  abcg::glDeleteProgram(m_prepassProgram);
 }
 
 void OpenGLWindow::update() {
-  m_modelMatrix = m_trackBallModel.getRotation();
+  m_scene.setRotation(m_earthNode,
+                      glm::quat_cast(m_trackBallModel.getRotation()));
+  m_scene.update();
+
+  // Orbit the point lights around the y axis
+  const auto rotation{glm::angleAxis(static_cast<float>(getDeltaTime()) * 0.2f,
+                                     glm::vec3(0, 1, 0))};
+  for (auto& light : m_pointLights) {
+    light.position = rotation * light.position;
+  }
 
   m_viewMatrix =
       glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f + m_zoom),
@@ -1,6 +1,10 @@
 #ifndef OPENGLWINDOW_HPP_
 #define OPENGLWINDOW_HPP_
 
+#include <array>
+#include <mutex>
+#include <optional>
+
 #include "abcg.hpp"
 #include "model.hpp"
 #include "trackball.hpp"
@@ -11,27 +15,91 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   void initializeGL() override;
   void paintGL() override;
   void paintUI() override;
-  void resizeGL(int width, int height) override;
+  void recordFrame(abcg::FramePacket& packet) override;
   void terminateGL() override;
 
  private:
+  // Objects of the scene, in the order of their world matrices in the frame
+  // packet
+  enum Object { Earth, Moon, NumObjects };
+
+  // State of the main thread read by paintGL, passed in the frame packet so
+  // that paintGL can run on the render thread
+  struct FrameState {
+    std::array<bool, NumObjects> visible{};
+    // Normalized view-space depth of the center of the bounds, used to sort
+    // the draws front to back
+    std::array<float, NumObjects> depths{};
+    std::array<int, NumObjects> trianglesToDraw{};
+    int programIndex{};
+    int mappingMode{};
+    bool depthPrepass{};
+    bool occlusionCulling{};
+    bool faceCulling{};
+    GLenum frontFace{GL_CCW};
+    glm::vec4 lightDir{};
+    glm::vec4 Ia{};
+    glm::vec4 Id{};
+    glm::vec4 Is{};
+    glm::vec4 Ka{};
+    glm::vec4 Kd{};
+    glm::vec4 Ks{};
+    float shininess{};
+    std::vector<abcg::LightClusters::PointLight> pointLights;
+    // Model to be loaded before drawing, if not empty
+    std::string modelPath;
+  };
+
+  // Properties of a model read by the UI and the scene. Passed back to the
+  // main thread when the render thread loads a model
+  struct ModelInfo {
+    int numTriangles{};
+    bool uvMapped{};
+    glm::vec3 boundsMin{};
+    glm::vec3 boundsMax{};
+    glm::vec4 Ka{};
+    glm::vec4 Kd{};
+    glm::vec4 Ks{};
+    float shininess{};
+  };
+
   int m_viewportWidth{};
   int m_viewportHeight{};
 
+  // Owned by the render thread after initialization
   Model m_model;
-  int m_trianglesToDraw{};
-
   Model m_moon_model;
+  // Program for which the VAO of m_model was set up
+  int m_modelProgramIndex{};
+
+  ModelInfo m_modelInfo;
+  int m_trianglesToDraw{};
   int m_moon_trianglesToDraw{};
+  std::string m_modelPath;
+  std::mutex m_loadedModelMutex;
+  std::optional<ModelInfo> m_loadedModel;
 
   TrackBall m_trackBallModel;
   TrackBall m_trackBallLight;
   float m_zoom{};
 
-  glm::mat4 m_modelMatrix{1.0f};
+  // The moon is a child of the earth, so it follows the earth's rotation
+  abcg::Scene m_scene;
+  abcg::Scene::Node m_earthNode{};
+  abcg::Scene::Node m_moonNode{};
+
   glm::mat4 m_viewMatrix{1.0f};
   glm::mat4 m_projMatrix{1.0f};
 
+  abcg::RenderQueue m_renderQueue;
+
+  // Models hidden behind the depth of a recent frame are skipped
+  abcg::HiZBuffer m_hiZBuffer;
+  bool m_occlusionCulling{true};
+
+  bool m_faceCulling{};
+  GLenum m_frontFace{GL_CCW};
+
   // Shaders
   std::vector<const char*> m_shaderNames{
       "normalmapping", "texture", "blinnphong", "phong",
@@ -39,6 +107,11 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   std::vector<GLuint> m_programs;
   int m_currentProgramIndex{};
 
+  // Depth pre-pass drawn with a position-only program, so that the main pass
+  // shades each pixel once
+  GLuint m_prepassProgram{};
+  bool m_depthPrepass{};
+
   // Mapping mode
   // 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
   int m_mappingMode{};
@@ -48,6 +121,13 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   glm::vec4 m_Ia{1.0f};
   glm::vec4 m_Id{1.0f};
   glm::vec4 m_Is{1.0f};
+  // Point lights orbiting the globe, binned into clusters of the view
+  // frustum so that each fragment only shades the lights that reach it
+  static constexpr int maxPointLights{512};
+  abcg::LightClusters m_lightClusters;
+  std::vector<abcg::LightClusters::PointLight> m_pointLights;
+  int m_numPointLights{128};
+
   glm::vec4 m_Ka{};
   glm::vec4 m_Kd{};
   glm::vec4 m_Ks{};
@@ -59,12 +139,17 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   GLuint m_skyVBO{};
   GLuint m_skyProgram{};
 
-  void loadModel(std::string_view path);
+  ModelInfo loadModel(std::string_view path);
   void loadMoon(std::string_view path);
+  void setModelInfo(const ModelInfo& info);
+  void setLocalBounds(abcg::Scene::Node node, const glm::vec3& boxMin,
+                      const glm::vec3& boxMax);
+  void initializePointLights();
   void initializeSkybox();
   void renderSkybox();
   void terminateSkybox();
   void update();
+  void resizeViewport(int width, int height);
 };
 
 #endif
\ No newline at end of file
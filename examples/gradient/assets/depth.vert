@@ -1,9 +1,9 @@
 #version 410
 
 layout(location = 0) in vec3 inPosition;
+layout(location = 1) in mat4 inInstanceMatrix;
 
 uniform vec4 color;
-uniform mat4 modelMatrix;
 uniform mat4 viewMatrix;
 uniform mat4 projMatrix;
 
@@ -11,7 +11,7 @@ out vec4 fragColor;
 out vec4 position;
 
 void main() {
-  vec4 posEyeSpace = viewMatrix * modelMatrix * vec4(inPosition, 1);
+  vec4 posEyeSpace = viewMatrix * inInstanceMatrix * vec4(inPosition, 1);
 
   float i = 1.0 - (-posEyeSpace.z / 100.0) * 0.1;
   fragColor = vec4(1, 1, 1, 1) * color; 
@@ -111,7 +111,66 @@ void Model::render(int numTriangles) const {
   abcg::glBindVertexArray(0);
 }
 
-void Model::setupVAO(GLuint program) {
+// Draws the instances counted in a DrawElementsIndirectCommand written on
+// the GPU, e.g. by abcg::GPUCuller, with a single call. Requires OpenGL 4.3
+void Model::renderIndirect([[maybe_unused]] GLuint indirectBuffer) const {
+#if !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  abcg::glBindVertexArray(m_VAO);
+  abcg::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+
+  abcg::glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 1,
+                                    0);
+
+  abcg::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  abcg::glBindVertexArray(0);
+#endif
+}
+
+// Draws numInstances copies of the model in a single call. Instance i is
+// transformed by the i-th matrix of the instance buffer, from the offset
+// given to setInstanceOffset
+void Model::renderInstanced(int numInstances, int numTriangles) const {
+  if (numInstances <= 0) return;
+
+  abcg::glBindVertexArray(m_VAO);
+
+  const auto numIndices{(numTriangles < 0) ? m_indices.size()
+                                           : numTriangles * 3};
+
+  abcg::glDrawElementsInstanced(GL_TRIANGLES,
+                                static_cast<GLsizei>(numIndices),
+                                GL_UNSIGNED_INT, nullptr, numInstances);
+
+  abcg::glBindVertexArray(0);
+}
+
+// Reads the per-instance model matrices from an offset of the instance
+// buffer, e.g. the offset of the transforms written to an abcg::StreamBuffer
+// in the current frame
+void Model::setInstanceOffset(GLintptr offset) {
+  if (m_instanceMatrixAttribute < 0) return;
+
+  abcg::glBindVertexArray(m_VAO);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+  setInstanceAttributes(offset);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  abcg::glBindVertexArray(0);
+}
+
+// A mat4 attribute uses four consecutive locations, one for each column
+void Model::setInstanceAttributes(GLintptr offset) const {
+  for (const auto column : iter::range(4)) {
+    const auto location{
+        static_cast<GLuint>(m_instanceMatrixAttribute + column)};
+    abcg::glVertexAttribPointer(
+        location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+        reinterpret_cast<void*>(offset + sizeof(glm::vec4) * column));
+  }
+}
+
+// Per-instance model matrices are read from instanceBuffer, at the offset
+// given to setInstanceOffset
+void Model::setupVAO(GLuint program, GLuint instanceBuffer) {
   // Release previous VAO
   abcg::glDeleteVertexArrays(1, &m_VAO);
 
@@ -132,6 +191,21 @@ void Model::setupVAO(GLuint program) {
                                 sizeof(Vertex), nullptr);
   }
 
+  // Instance matrices are advanced once per instance
+  m_instanceBuffer = instanceBuffer;
+  m_instanceMatrixAttribute =
+      abcg::glGetAttribLocation(program, "inInstanceMatrix");
+  if (m_instanceMatrixAttribute >= 0) {
+    abcg::glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+    for (const auto column : iter::range(4)) {
+      const auto location{
+          static_cast<GLuint>(m_instanceMatrixAttribute + column)};
+      abcg::glEnableVertexAttribArray(location);
+      abcg::glVertexAttribDivisor(location, 1);
+    }
+    setInstanceAttributes(0);
+  }
+
   // End of binding
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
   abcg::glBindVertexArray(0);
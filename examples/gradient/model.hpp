@@ -17,7 +17,10 @@ class Model {
  public:
   void loadObj(std::string_view path, bool standardize = true);
   void render(int numTriangles = -1) const;
-  void setupVAO(GLuint program);
+  void renderIndirect(GLuint indirectBuffer) const;
+  void renderInstanced(int numInstances, int numTriangles = -1) const;
+  void setInstanceOffset(GLintptr offset);
+  void setupVAO(GLuint program, GLuint instanceBuffer = 0);
   void terminateGL();
 
   [[nodiscard]] int getNumTriangles() const {
@@ -28,11 +31,16 @@ class Model {
   GLuint m_VAO{};
   GLuint m_VBO{};
   GLuint m_EBO{};
+  // Buffer of the per-instance model matrices, and location of their first
+  // column
+  GLuint m_instanceBuffer{};
+  GLint m_instanceMatrixAttribute{-1};
 
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
 
   void createBuffers();
+  void setInstanceAttributes(GLintptr offset) const;
   void standardize();
 };
 
@@ -4,6 +4,7 @@
 
 #include <cppitertools/itertools.hpp>
 #include <glm/gtx/fast_trigonometry.hpp>
+#include <span>
 
 void OpenGLWindow::initializeGL() {
   abcg::glClearColor(0, 0, 0, 1);
@@ -18,7 +19,8 @@ void OpenGLWindow::initializeGL() {
   // Load model
   m_model.loadObj(getAssetsPath() + "ball.obj");
 
-  m_model.setupVAO(m_program);
+  m_instanceBuffer.initialize(GL_ARRAY_BUFFER, m_numBalls * sizeof(glm::mat4));
+  m_model.setupVAO(m_program, m_instanceBuffer.getBuffer());
 
   // Camera at (0,0,0) and looking towards the negative z
   m_viewMatrix =
@@ -32,6 +34,7 @@ void OpenGLWindow::initializeGL() {
 
     randomizeBalls(position, speed);
   }
+  m_previousBallPositions = m_ballPositions;
 }
 
 void OpenGLWindow::randomizeBalls(glm::vec3 &position, float &speed) {
@@ -49,8 +52,6 @@ void OpenGLWindow::randomizeBalls(glm::vec3 &position, float &speed) {
 }
 
 void OpenGLWindow::paintGL() {
-  update();
-
   // Clear color buffer and depth buffer
   abcg::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -63,30 +64,45 @@ void OpenGLWindow::paintGL() {
       abcg::glGetUniformLocation(m_program, "viewMatrix")};
   const GLint projMatrixLoc{
       abcg::glGetUniformLocation(m_program, "projMatrix")};
-  const GLint modelMatrixLoc{
-      abcg::glGetUniformLocation(m_program, "modelMatrix")};
 
   // Set uniform variables used by every scene object
   abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
   abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
   //abcg::glUniform4f(colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);  // White
 
-  // Render each star
+  // Interpolate between the last two simulated positions. The model is
+  // scaled to a unit sphere, then by 0.2
+  const auto alpha{static_cast<float>(getInterpolationAlpha())};
+  m_ballBounds.resize(m_numBalls);
   for (const auto index : iter::range(m_numBalls)) {
-    const auto &position{m_ballPositions.at(index)};
+    const auto position{glm::mix(m_previousBallPositions.at(index),
+                                 m_ballPositions.at(index), alpha)};
+    m_ballBounds.set(index, position, 0.2f);
+  }
+
+  // Skip the balls outside the view frustum, e.g. behind the camera
+  const abcg::Frustum frustum{m_projMatrix * m_viewMatrix};
+  frustum.cull(m_ballBounds, m_visibleBalls);
 
-    // Compute model matrix of the current star
+  // Compute the model matrix of each visible ball
+  for (const auto index : iter::range(m_visibleBalls.size())) {
     glm::mat4 modelMatrix{1.0f};
 
-    modelMatrix = glm::translate(modelMatrix, position);
+    modelMatrix = glm::translate(
+        modelMatrix, m_ballBounds.getCenter(m_visibleBalls.at(index)));
     modelMatrix = glm::scale(modelMatrix, glm::vec3(0.2f));
 
-    // Set uniform variable
-    abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
-
-    m_model.render();
+    m_ballTransforms.at(index) = modelMatrix;
   }
 
+  // Render all visible balls in a single draw call
+  const auto offset{m_instanceBuffer.write<glm::mat4>(
+      std::span{m_ballTransforms}.first(m_visibleBalls.size()))};
+  m_instanceBuffer.flush();
+  m_model.setInstanceOffset(offset);
+  m_model.renderInstanced(static_cast<int>(m_visibleBalls.size()));
+  m_instanceBuffer.endFrame();
+
   abcg::glUseProgram(0);
 }
 
@@ -141,13 +157,13 @@ void OpenGLWindow::resizeGL(int width, int height) {
 }
 
 void OpenGLWindow::terminateGL() {
+  m_instanceBuffer.terminate();
   m_model.terminateGL();
   abcg::glDeleteProgram(m_program);
 }
 
-void OpenGLWindow::update() {
-  // Animate angle by 90 degrees per second
-  const float deltaTime{static_cast<float>(getDeltaTime())};
+void OpenGLWindow::updateFixed(double deltaTime) {
+  m_previousBallPositions = m_ballPositions;
 
   // Update stars
   for (const auto index : iter::range(m_numBalls)) {
@@ -155,13 +171,16 @@ void OpenGLWindow::update() {
     auto &speed{m_ballSpeeds.at(index)};
 
     // Z coordinate increases by 10 units per second
-    position.z += deltaTime * speed;
+    position.z += static_cast<float>(deltaTime) * speed;
 
     // If this star is behind the camera, select a new random position and
     // orientation, and move it back to -100
     if (position.z > 0.1f) {
       randomizeBalls(position, speed);
       position.z = -100.0f;  // Back to -100
+
+      // Do not interpolate across the jump
+      m_previousBallPositions.at(index) = position;
     }
   }
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #ifndef OPENGLWINDOW_HPP_
 #define OPENGLWINDOW_HPP_
 
+#include <cstdint>
 #include <random>
+#include <vector>
 
 #include "abcg.hpp"
 #include "model.hpp"
@@ -13,6 +15,7 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   void paintUI() override;
   void resizeGL(int width, int height) override;
   void terminateGL() override;
+  void updateFixed(double deltaTime) override;
 
  private:
   static const int m_numBalls{10};
@@ -27,7 +30,16 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   Model m_model;
 
   std::array<glm::vec3, m_numBalls> m_ballPositions;
+  // Positions before the last fixed update, for interpolation
+  std::array<glm::vec3, m_numBalls> m_previousBallPositions;
   std::array<float, m_numBalls> m_ballSpeeds;
+  // Bounding spheres of the balls, tested against the view frustum
+  abcg::BoundingSpheres m_ballBounds;
+  std::vector<std::uint32_t> m_visibleBalls;
+  // Model matrices of the visible balls, drawn as instances, and the buffer
+  // they are written to every frame
+  std::array<glm::mat4, m_numBalls> m_ballTransforms;
+  abcg::StreamBuffer m_instanceBuffer;
 
   glm::mat4 m_viewMatrix{1.0f};
   glm::mat4 m_projMatrix{1.0f};
@@ -35,8 +47,6 @@ class OpenGLWindow : public abcg::OpenGLWindow {
 
   void randomizeBalls(glm::vec3 &position, float &speed);
   void moveBalls(glm::vec3 &position);
-
-  void update();
 };
 
 #endif
\ No newline at end of file
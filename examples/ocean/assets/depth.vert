@@ -1,6 +1,7 @@
 #version 410
 
 layout(location = 0) in vec3 inPosition;
+layout(location = 1) in mat4 inInstanceMatrix;
 
 uniform vec4 color;
 uniform mat4 modelMatrix;
@@ -10,10 +11,11 @@ uniform mat4 projMatrix;
 out vec4 fragColor;
 
 void main() {
-  vec4 posEyeSpace = viewMatrix * modelMatrix * vec4(inPosition, 1);
+  vec4 posEyeSpace =
+      viewMatrix * modelMatrix * inInstanceMatrix * vec4(inPosition, 1);
 
   float i = 1.0 - (-posEyeSpace.z / 100.0);
   fragColor = vec4(6.0f/255, 113.0f/255, 183.0f/255, 1);
 
-  gl_Position = vec4(inPosition, 0, 1);
+  gl_Position = projMatrix * posEyeSpace;
 }
\ No newline at end of file
@@ -27,10 +27,10 @@ void OpenGLWindow::handleEvent(SDL_Event& event) {
 
 void OpenGLWindow::randomizeStar(glm::vec3 &position) {
   // Get random position
-  // x and y coordinates in the range [-20, 20]
-  // z coordinates in the range [-100, 0]
-  std::uniform_real_distribution<float> distPosXY(-20.0f, 20.0f);
-  std::uniform_real_distribution<float> distPosZ(-2.0f, 0.0f);
+  // x and y coordinates in the range [-1, 1]
+  // z coordinates in the range [-0.1, 0]
+  std::uniform_real_distribution<float> distPosXY(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> distPosZ(-0.1f, 0.0f);
 
   position = glm::vec3(distPosXY(m_randomEngine), distPosXY(m_randomEngine),
                        distPosZ(m_randomEngine));
@@ -52,7 +52,18 @@ void OpenGLWindow::initializeGL() {
   // Load model
   m_model.loadObj(getAssetsPath() + "ship.obj");
 
-  m_model.setupVAO(m_program);
+  // Draw the ships culled on the GPU from the buffer written by the culler
+  m_gpuCulling = abcg::GPUCuller::isSupported();
+  if (m_gpuCulling) {
+    m_gpuCuller.initialize();
+    m_model.setupVAO(m_program, m_gpuCuller.getVisibleTransformsBuffer());
+  } else {
+    m_instanceBuffer.initialize(GL_ARRAY_BUFFER,
+                                m_numOcean * sizeof(glm::mat4));
+    m_model.setupVAO(m_program, m_instanceBuffer.getBuffer());
+  }
+
+  m_trianglesToDraw = m_model.getNumTriangles();
 
   for (const auto index : iter::range(m_numOcean)) {
       auto &position{m_oceanPositions.at(index)};
@@ -69,6 +80,30 @@ void OpenGLWindow::paintGL() {
 
   abcg::glViewport(0, 0, m_viewportWidth, m_viewportHeight);
 
+  // Cull the ships in the space of the ocean
+  const auto oceanViewProjMatrix{m_projMatrix * m_viewMatrix * m_modelMatrix};
+  if (m_gpuCulling) {
+    m_gpuCuller.setInstances(m_oceanBounds, m_oceanTransforms);
+    m_gpuCuller.cull(oceanViewProjMatrix,
+                     static_cast<GLuint>(m_trianglesToDraw * 3));
+  } else {
+    m_oceanSpheres.resize(m_oceanBounds.size());
+    for (const auto index : iter::range(m_oceanBounds.size())) {
+      const auto &bounds{m_oceanBounds.at(index)};
+      m_oceanSpheres.set(index, glm::vec3{bounds}, bounds.w);
+    }
+    abcg::Frustum{oceanViewProjMatrix}.cull(m_oceanSpheres, m_visibleShips);
+
+    m_visibleTransforms.clear();
+    for (const auto index : m_visibleShips) {
+      m_visibleTransforms.push_back(m_oceanTransforms.at(index));
+    }
+    const auto offset{
+        m_instanceBuffer.write<glm::mat4>(m_visibleTransforms)};
+    m_instanceBuffer.flush();
+    m_model.setInstanceOffset(offset);
+  }
+
   abcg::glUseProgram(m_program);
 
   // Get location of uniform variables (could be precomputed)
@@ -84,11 +119,18 @@ void OpenGLWindow::paintGL() {
   abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
   abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
 
-  // Set uniform variables of the current object
+  // Set uniform variables of the whole ocean
   abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &m_modelMatrix[0][0]);
   abcg::glUniform4f(colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);  // White
 
-  m_model.render(m_trianglesToDraw);
+  // Render all visible ships in a single draw call
+  if (m_gpuCulling) {
+    m_model.renderIndirect(m_gpuCuller.getIndirectBuffer());
+  } else {
+    m_model.renderInstanced(static_cast<int>(m_visibleTransforms.size()),
+                            m_trianglesToDraw);
+    m_instanceBuffer.endFrame();
+  }
 
   abcg::glUseProgram(0);
 }
@@ -197,17 +239,31 @@ void OpenGLWindow::resizeGL(int width, int height) {
 }
 
 void OpenGLWindow::terminateGL() {
+  m_gpuCuller.terminate();
+  m_instanceBuffer.terminate();
   m_model.terminateGL();
   abcg::glDeleteProgram(m_program);
 }
 
 void OpenGLWindow::update() {
-  // Animate angle by 90 degrees per second
-  const float deltaTime{static_cast<float>(getDeltaTime())};
+  m_modelMatrix = m_trackBall.getRotation();
+
+  m_viewMatrix =
+      glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f + m_zoom),
+                  glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 
   // Update Ocean Vertices
-  for (const auto index : iter::range(1000)) {
+  m_oceanTransforms.resize(m_numOcean);
+  m_oceanBounds.resize(m_numOcean);
+  for (const auto index : iter::range(m_numOcean)) {
     auto &position{m_oceanPositions.at(index)};
     randomizeStar(position);
+
+    glm::mat4 modelMatrix{1.0f};
+    modelMatrix = glm::translate(modelMatrix, position);
+    modelMatrix = glm::scale(modelMatrix, glm::vec3(0.02f));
+    m_oceanTransforms.at(index) = modelMatrix;
+    // The model is scaled to a unit sphere, then by 0.02
+    m_oceanBounds.at(index) = glm::vec4{position, 0.02f};
   }
 }
\ No newline at end of file
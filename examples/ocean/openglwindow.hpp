@@ -1,6 +1,10 @@
 #ifndef OPENGLWINDOW_HPP_
 #define OPENGLWINDOW_HPP_
 
+#include <cstdint>
+#include <random>
+#include <vector>
+
 #include "abcg.hpp"
 #include "model.hpp"
 #include "trackball.hpp"
@@ -22,6 +26,8 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   int m_viewportWidth{};
   int m_viewportHeight{};
 
+  std::default_random_engine m_randomEngine;
+
   Model m_model;
   int m_trianglesToDraw{};
 
@@ -33,7 +39,21 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   glm::mat4 m_projMatrix{1.0f};
 
   std::array<glm::vec3, m_numOcean> m_oceanPositions;
-
+  // Model matrices of the ships, drawn as instances
+  std::vector<glm::mat4> m_oceanTransforms;
+
+  // Frustum culling runs on the GPU with OpenGL 4.3, and on the CPU
+  // otherwise
+  bool m_gpuCulling{};
+  abcg::GPUCuller m_gpuCuller;
+  std::vector<glm::vec4> m_oceanBounds;
+  abcg::BoundingSpheres m_oceanSpheres;
+  std::vector<std::uint32_t> m_visibleShips;
+  std::vector<glm::mat4> m_visibleTransforms;
+  // Model matrices of the ships culled on the CPU, written every frame
+  abcg::StreamBuffer m_instanceBuffer;
+
+  void randomizeStar(glm::vec3& position);
   void update();
 };
 
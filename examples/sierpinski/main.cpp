@@ -15,7 +15,8 @@ int main(int argc, char **argv) {
     window->setWindowSettings({.width = 600,
                                .height = 600,
                                .showFullscreenButton = false,
-                               .title = "Sierpinski Triangle"});
+                               .title = "Sierpinski Triangle",
+                               .fixedUpdateRate = 1000.0});
 
     // Run application
     app.run(std::move(window));
@@ -3,7 +3,10 @@
 #include <fmt/core.h>
 #include <imgui.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <span>
 
 // void OpenGLWindow::initializeGL() {
 //   // Start pseudo-random number generator
@@ -29,40 +32,6 @@
 //   // fmt::print("({:+.2f}, {:+.2f})\n", m_P.x, m_P.y);
 // }
 
-void OpenGLWindow::setupModel() {
-  // Release previous VBO and VAO
-  abcg::glDeleteBuffers(1, &m_vboVertices);
-  abcg::glDeleteVertexArrays(1, &m_vao);
-
-  // Generate a new VBO and get the associated ID
-  abcg::glGenBuffers(1, &m_vboVertices);
-  // Bind VBO in order to use it
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_vboVertices);
-  // Upload data to VBO
-  abcg::glBufferData(GL_ARRAY_BUFFER, sizeof(m_P), &m_P, GL_STATIC_DRAW);
-  // Unbinding the VBO is allowed (data can be released now)
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // Get location of attributes in the program
-  const GLint positionAttribute{
-      abcg::glGetAttribLocation(m_program, "inPosition")};
-
-  // Create VAO
-  abcg::glGenVertexArrays(1, &m_vao);
-
-  // Bind vertex attributes to current VAO
-  abcg::glBindVertexArray(m_vao);
-
-  abcg::glEnableVertexAttribArray(positionAttribute);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_vboVertices);
-  abcg::glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
-                              nullptr);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // End of binding to current VAO
-  abcg::glBindVertexArray(0);
-}
-
 void OpenGLWindow::initializeGL() {
   const auto *vertexShader{R"gl(
     #version 410
@@ -82,6 +51,18 @@ void OpenGLWindow::initializeGL() {
   // Create shader program
   m_program = createProgramFromString(vertexShader, fragmentShader);
 
+  // Create a stream buffer for the points computed since the last frame
+  m_streamBuffer.initialize(GL_ARRAY_BUFFER, maxNewPoints * sizeof(glm::vec2));
+
+  // Create VAO. Each frame draws from its own offset in the stream buffer
+  abcg::glGenVertexArrays(1, &m_vao);
+  abcg::glBindVertexArray(m_vao);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_streamBuffer.getBuffer());
+  abcg::glEnableVertexAttribArray(0);
+  abcg::glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  abcg::glBindVertexArray(0);
+
   // Clear window
   abcg::glClearColor(0, 0, 0, 1);
   abcg::glClear(GL_COLOR_BUFFER_BIT);
@@ -106,8 +87,14 @@ void OpenGLWindow::initializeGL() {
 }
 
 void OpenGLWindow::paintGL() {
-  // Create OpenGL buffers for the single point at m_P
-  setupModel();
+  if (m_newPoints.empty()) return;
+
+  // Write the points computed since the last frame to the stream buffer
+  const auto count{std::min(m_newPoints.size(), maxNewPoints)};
+  const auto first{m_newPoints.end() - static_cast<std::ptrdiff_t>(count)};
+  const std::span newPoints{first, m_newPoints.end()};
+  const auto offset{m_streamBuffer.write<glm::vec2>(newPoints)};
+  m_streamBuffer.flush();
 
   // Set the viewport
   abcg::glViewport(0, 0, m_viewportWidth, m_viewportHeight);
@@ -117,14 +104,21 @@ void OpenGLWindow::paintGL() {
   // Start using VAO
   abcg::glBindVertexArray(m_vao);
 
-  // Draw a single point
-  abcg::glDrawArrays(GL_POINTS, 0, 1);
+  // Draw the new points
+  abcg::glDrawArrays(GL_POINTS,
+                     static_cast<GLint>(offset / sizeof(glm::vec2)),
+                     static_cast<GLsizei>(count));
 
   // End using VAO
   abcg::glBindVertexArray(0);
   // End using the shader program
   abcg::glUseProgram(0);
 
+  m_streamBuffer.endFrame();
+  m_newPoints.clear();
+}
+
+void OpenGLWindow::updateFixed([[maybe_unused]] double deltaTime) {
   // Randomly choose a triangle vertex index
   std::uniform_int_distribution<int> intDistribution(0, m_points.size() - 1);
   const int index{intDistribution(m_randomEngine)};
@@ -132,6 +126,7 @@ void OpenGLWindow::paintGL() {
   // The new position is the midpoint between the current position and the
   // chosen vertex
   m_P = (m_P + m_points.at(index)) / 2.0f;
+  m_newPoints.push_back(m_P);
 
   // Print coordinates to the console
   // fmt::print("({:+.2f}, {:+.2f})\n", m_P.x, m_P.y);
@@ -160,8 +155,8 @@ void OpenGLWindow::paintUI() {
 }
 
 void OpenGLWindow::terminateGL() {
-  // Release shader program, VBO and VAO
+  // Release shader program, stream buffer and VAO
   abcg::glDeleteProgram(m_program);
-  abcg::glDeleteBuffers(1, &m_vboVertices);
+  m_streamBuffer.terminate();
   abcg::glDeleteVertexArrays(1, &m_vao);
 }
\ No newline at end of file
@@ -2,8 +2,10 @@
 #define OPENGLWINDOW_HPP_
 
 #include <array>
+#include <cstddef>
 #include <glm/vec2.hpp>
 #include <random>
+#include <vector>
 
 #include "abcg.hpp"
 
@@ -14,10 +16,14 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   void paintUI() override;
   void resizeGL(int width, int height) override;
   void terminateGL() override;
+  void updateFixed(double deltaTime) override;
 
  private:
+  // Points drawn per frame at most. Older points are dropped
+  static constexpr std::size_t maxNewPoints{4096};
+
   GLuint m_vao{};
-  GLuint m_vboVertices{};
+  abcg::StreamBuffer m_streamBuffer;
   GLuint m_program{};
 
   int m_viewportWidth{};
@@ -29,7 +35,7 @@ class OpenGLWindow : public abcg::OpenGLWindow {
                                           glm::vec2(-1, -1),
                                           glm::vec2( 1, -1)};
   glm::vec2 m_P{};
-
-  void setupModel();
+  // Points computed since the last frame
+  std::vector<glm::vec2> m_newPoints;
 };
 #endif
\ No newline at end of file
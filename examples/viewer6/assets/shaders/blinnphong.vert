@@ -14,6 +14,8 @@ out vec3 fragV;
 out vec3 fragL;
 out vec3 fragN;
 
+invariant gl_Position;
+
 void main() {
   vec3 P = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
   vec3 N = normalMatrix * inNormal;
@@ -11,6 +11,8 @@ uniform mat3 normalMatrix;
 out vec3 fragP;
 out vec3 fragN;
 
+invariant gl_Position;
+
 void main() {
   fragP = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
   fragN = normalMatrix * inNormal;
@@ -10,10 +10,12 @@ uniform mat3 normalMatrix;
 
 out vec4 fragColor;
 
+invariant gl_Position;
+
 void main() {
-  mat4 MVP = projMatrix * viewMatrix * modelMatrix;
+  vec3 P = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
 
-  gl_Position = MVP * vec4(inPosition, 1.0);
+  gl_Position = projMatrix * vec4(P, 1.0);
 
   vec3 N = inNormal;  // Object space
   // vec3 N = normalMatrix * inNormal; // Eye space
@@ -18,6 +18,8 @@ out vec2 fragTexCoord;
 out vec3 fragPObj;
 out vec3 fragNObj;
 
+invariant gl_Position;
+
 void main() {
   vec3 P = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
   vec3 N = normalMatrix * inNormal;
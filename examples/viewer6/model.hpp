@@ -26,6 +26,7 @@ class Model {
   void loadNormalTexture(std::string_view path);
   void loadObj(std::string_view path, bool standardize = true);
   void render(int numTriangles = -1) const;
+  void renderPositions(int numTriangles = -1) const;
   void setupVAO(GLuint program);
   void terminateGL();
 
@@ -47,12 +48,20 @@ class Model {
   GLuint m_VBO{};
   GLuint m_EBO{};
 
+  // Tightly packed positions, drawn by the depth pre-pass
+  GLuint m_positionVAO{};
+  GLuint m_positionVBO{};
+
   glm::vec4 m_Ka{};
   glm::vec4 m_Kd{};
   glm::vec4 m_Ks{};
   float m_shininess{};
   GLuint m_diffuseTexture{};
   GLuint m_normalTexture{};
+
+  // Trilinear filtering with anisotropy, shared by the diffuse and normal maps
+  abcg::opengl::SamplerSettings m_samplerSettings{.maxAnisotropy = 16.0f};
+  GLuint m_sampler{};
   GLuint m_cubeTexture{};
 
   std::vector<Vertex> m_vertices;
@@ -64,6 +73,7 @@ class Model {
   void computeNormals();
   void computeTangents();
   void createBuffers();
+  void createPositionBuffers();
   void standardize();
 };
 
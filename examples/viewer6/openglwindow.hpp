@@ -39,6 +39,11 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   std::vector<GLuint> m_programs;
   int m_currentProgramIndex{};
 
+  // Depth pre-pass drawn with a position-only program, so that the main pass
+  // shades each pixel once
+  GLuint m_prepassProgram{};
+  bool m_depthPrepass{};
+
   // Mapping mode
   // 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
   int m_mappingMode{};
@@ -83,6 +88,7 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   // clang-format on
 
   void initializeSkybox();
+  void renderDepthPrepass();
   void renderSkybox();
   void terminateSkybox();
   void loadModel(std::string_view path);